@@ -0,0 +1,107 @@
+// arena.c
+#include <stdint.h>
+#include "arena.h"
+#include "mem_track.h"
+
+struct ArenaChunk {
+    ArenaChunk* next;
+    size_t size;                 // Octets de data
+    size_t used;
+    _Alignas(ARENA_ALIGN) char data[];
+};
+
+struct ArenaFreeBlock {
+    ArenaFreeBlock* next;
+};
+
+// Au-delà, un bloc reçoit sa propre région pour ne pas gaspiller la fin de la région courante
+#define ARENA_LARGE_BLOCK (ARENA_CHUNK_SIZE / 4)
+
+static size_t round_size(size_t size) {
+    if (size < sizeof(ArenaFreeBlock)) size = sizeof(ArenaFreeBlock);
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+// Les régions sont comptées dans MEM_LOADER (mem_track.h) ; celles de plus de 128 Ko
+// viennent directement de mmap avec glibc et y retournent par munmap
+static ArenaChunk* new_chunk(Arena* arena, size_t size) {
+    ArenaChunk* chunk = mem_alloc(MEM_LOADER, sizeof(ArenaChunk) + size);
+    if (!chunk) return NULL;
+    chunk->size = size;
+    chunk->used = 0;
+    arena->reserved_bytes += size;
+    arena->nb_chunks++;
+    return chunk;
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    size = round_size(size);
+    size_t class_index = size / ARENA_ALIGN - 1;
+    if (class_index < ARENA_SIZE_CLASSES && arena->free_lists[class_index]) {
+        ArenaFreeBlock* block = arena->free_lists[class_index];
+        arena->free_lists[class_index] = block->next;
+        arena->free_bytes -= size;
+        arena->used_bytes += size;
+        return block;
+    }
+
+    if (size > ARENA_LARGE_BLOCK) {
+        ArenaChunk* chunk = new_chunk(arena, size);
+        if (!chunk) return NULL;
+        chunk->used = size;
+        // Placée derrière la région courante, qui continue à servir les petits blocs
+        if (arena->chunks) {
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+        } else {
+            chunk->next = NULL;
+            arena->chunks = chunk;
+        }
+        arena->used_bytes += size;
+        return chunk->data;
+    }
+
+    ArenaChunk* chunk = arena->chunks;
+    if (!chunk || chunk->size - chunk->used < size) {
+        chunk = new_chunk(arena, ARENA_CHUNK_SIZE);
+        if (!chunk) return NULL;
+        chunk->next = arena->chunks;
+        arena->chunks = chunk;
+    }
+    void* p = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->used_bytes += size;
+    return p;
+}
+
+void arena_free(Arena* arena, void* p, size_t size) {
+    if (!p) return;
+    size = round_size(size);
+    arena->used_bytes -= size;
+    arena->free_bytes += size;
+    size_t class_index = size / ARENA_ALIGN - 1;
+    if (class_index >= ARENA_SIZE_CLASSES) return; // Récupéré au compactage
+
+    ArenaFreeBlock* block = p;
+    block->next = arena->free_lists[class_index];
+    arena->free_lists[class_index] = block;
+}
+
+int arena_owns(const Arena* arena, const void* p) {
+    uintptr_t address = (uintptr_t)p;
+    for (const ArenaChunk* chunk = arena->chunks; chunk; chunk = chunk->next) {
+        uintptr_t start = (uintptr_t)chunk->data;
+        if (address >= start && address < start + chunk->used) return 1;
+    }
+    return 0;
+}
+
+void arena_release(Arena* arena) {
+    ArenaChunk* chunk = arena->chunks;
+    while (chunk) {
+        ArenaChunk* next = chunk->next;
+        mem_free(MEM_LOADER, chunk);
+        chunk = next;
+    }
+    *arena = (Arena){0};
+}
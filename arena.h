@@ -0,0 +1,39 @@
+// arena.h - Allocation par régions pour les questions d'une base
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+#define ARENA_CHUNK_SIZE (256 * 1024)  // Taille des régions demandées au système
+#define ARENA_ALIGN 8                  // Tailles arrondies au multiple supérieur
+#define ARENA_SIZE_CLASSES 256         // Blocs libérés réutilisés jusqu'à 256 * ARENA_ALIGN octets
+
+typedef struct ArenaChunk ArenaChunk;
+typedef struct ArenaFreeBlock ArenaFreeBlock;
+
+// Les blocs sont pris à la suite dans la région courante ; un bloc libéré rejoint la liste
+// de sa taille et sert à la prochaine allocation de même taille. Les blocs plus grands que
+// la dernière classe ne sont pas réutilisés : leur place revient au compactage de la base
+// (database_compact). Une arène remplie de zéros est vide et utilisable.
+typedef struct {
+    ArenaChunk* chunks;          // La première région reçoit les nouveaux blocs
+    ArenaFreeBlock* free_lists[ARENA_SIZE_CLASSES];
+    size_t reserved_bytes;       // Total des régions obtenues du système
+    size_t used_bytes;           // Blocs alloués (tailles arrondies)
+    size_t free_bytes;           // Blocs libérés, en liste ou en attente de compactage
+    int nb_chunks;
+} Arena;
+
+// Retourne un bloc de size octets aligné sur ARENA_ALIGN, ou NULL si la mémoire manque
+void* arena_alloc(Arena* arena, size_t size);
+
+// Rend un bloc obtenu de arena_alloc avec la même taille
+void arena_free(Arena* arena, void* p, size_t size);
+
+// Retourne 1 si p désigne un bloc de l'arène (parcours des régions)
+int arena_owns(const Arena* arena, const void* p);
+
+// Rend toutes les régions au système en une seule passe ; l'arène redevient vide
+void arena_release(Arena* arena);
+
+#endif
@@ -0,0 +1,411 @@
+// bank_shards.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #define mkdir(path, mode) _mkdir(path)
+#else
+    #include <sys/types.h>
+#endif
+#include "bank_shards.h"
+#include "database.h"
+#include "search_index.h"
+#include "string_map.h"
+#include "mem_track.h"
+#include "trace.h"
+
+// Longueur maximale du nom tiré de la matière, avant le numéro éventuel et ".txt"
+#define SHARD_NAME_MAX 64
+
+static char* path_join(const char* directory, const char* name) {
+    size_t length = strlen(directory) + strlen(name) + 2;
+    char* path = mem_alloc(MEM_LOADER, length);
+    if (path) snprintf(path, length, "%s/%s", directory, name);
+    return path;
+}
+
+int bank_shards_is_directory(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+// Lit une ligne entière dans *buffer (agrandi au besoin), sans sa fin de ligne.
+// Retourne 1, 0 en fin de fichier, ou GEN_ERROR_NO_MEMORY.
+static int read_line(FILE* f, char** buffer, size_t* capacity) {
+    size_t length = 0;
+    for (;;) {
+        if (*capacity - length < 2) {
+            size_t new_capacity = *capacity ? *capacity * 2 : 256;
+            char* grown = mem_realloc(MEM_LOADER, *buffer, new_capacity);
+            if (!grown) return GEN_ERROR_NO_MEMORY;
+            *buffer = grown;
+            *capacity = new_capacity;
+        }
+        if (!fgets(*buffer + length, (int)(*capacity - length), f)) break;
+        length += strlen(*buffer + length);
+        if ((*buffer)[length - 1] == '\n') break;
+    }
+    if (length == 0) return 0;
+    (*buffer)[strcspn(*buffer, "\r\n")] = 0;
+    return 1;
+}
+
+static void free_shard(BankShard* shard) {
+    mem_free(MEM_LOADER, shard->matiere);
+    mem_free(MEM_LOADER, shard->file);
+    free_string_array(shard->chapters, shard->nb_chapters);
+}
+
+// Ajoute une matière (chaînes copiées, non chargée, sans chapitres) ; NULL si la mémoire manque
+static BankShard* add_shard(BankShards* shards, const char* matiere, const char* file) {
+    BankShard* grown = mem_realloc(MEM_LOADER, shards->shards, sizeof(BankShard) * (shards->count + 1));
+    if (!grown) return NULL;
+    shards->shards = grown;
+    BankShard* shard = &grown[shards->count];
+    memset(shard, 0, sizeof(*shard));
+    shard->matiere = mem_strdup(MEM_LOADER, matiere);
+    shard->file = mem_strdup(MEM_LOADER, file);
+    if (!shard->matiere || !shard->file) {
+        free_shard(shard);
+        return NULL;
+    }
+    shards->count++;
+    return shard;
+}
+
+static int add_chapter(BankShard* shard, const char* chapter) {
+    char** grown = mem_realloc(MEM_LOADER, shard->chapters, sizeof(char*) * (shard->nb_chapters + 1));
+    if (!grown) return GEN_ERROR_NO_MEMORY;
+    shard->chapters = grown;
+    char* copy = mem_strdup(MEM_LOADER, chapter);
+    if (!copy) return GEN_ERROR_NO_MEMORY;
+    grown[shard->nb_chapters++] = copy;
+    return GEN_OK;
+}
+
+static BankShard* find_shard(BankShards* shards, const char* matiere) {
+    for (int i = 0; i < shards->count; i++) {
+        if (strcmp(shards->shards[i].matiere, matiere) == 0) return &shards->shards[i];
+    }
+    return NULL;
+}
+
+// Analyse une ligne du manifeste (modifiée sur place) ; une ligne invalide est ignorée
+// comme dans le fichier de questions, dont le manifeste suit le format (DatabaseFormat)
+static int parse_manifest_line(BankShards* shards, char* line, DatabaseFormat format) {
+    char* fields[4];
+    char* cursor = line;
+    for (int i = 0; i < 4; i++) {
+        fields[i] = database_next_field(&cursor, ';', format);
+        if (!fields[i]) return GEN_OK;
+        if (i < 3 && format == DATABASE_FORMAT_ESCAPED) database_unescape_field(fields[i]);
+    }
+    // Le fichier doit rester dans le répertoire de la base
+    if (!fields[0][0] || !fields[1][0] || fields[1][0] == '.' || strpbrk(fields[1], "/\\")) return GEN_OK;
+    if (find_shard(shards, fields[0])) return GEN_OK;
+
+    BankShard* shard = add_shard(shards, fields[0], fields[1]);
+    if (!shard) return GEN_ERROR_NO_MEMORY;
+    shard->count = atoi(fields[2]);
+    if (strcmp(fields[3], "-") == 0) return GEN_OK;
+    cursor = fields[3];
+    for (char* chapter = database_next_field(&cursor, '|', format); chapter;
+         chapter = database_next_field(&cursor, '|', format)) {
+        if (format == DATABASE_FORMAT_ESCAPED) database_unescape_field(chapter);
+        if (chapter[0] && add_chapter(shard, chapter) != GEN_OK) return GEN_ERROR_NO_MEMORY;
+    }
+    return GEN_OK;
+}
+
+int bank_shards_open(Database* db, const char* directory) {
+    if (db->shards) return GEN_ERROR_INVALID_ARGUMENT;
+    char* path = path_join(directory, BANK_SHARDS_MANIFEST);
+    if (!path) return GEN_ERROR_NO_MEMORY;
+    FILE* f = fopen(path, "r");
+    mem_free(MEM_LOADER, path);
+    if (!f) return GEN_ERROR_IO;
+
+    uint64_t span = trace_begin();
+    BankShards* shards = mem_calloc(MEM_LOADER, 1, sizeof(BankShards));
+    int status = shards ? GEN_OK : GEN_ERROR_NO_MEMORY;
+    if (status == GEN_OK && !(shards->directory = mem_strdup(MEM_LOADER, directory))) status = GEN_ERROR_NO_MEMORY;
+    char* line = NULL;
+    size_t line_capacity = 0;
+    DatabaseFormat format = DATABASE_FORMAT_PLAIN;
+    for (int n = 0; status == GEN_OK; n++) {
+        int read = read_line(f, &line, &line_capacity);
+        if (read <= 0) {
+            status = read;
+            break;
+        }
+        if (n == 0) format = database_file_format(line);
+        status = parse_manifest_line(shards, line, format);
+    }
+    if (status == GEN_OK && ferror(f)) status = GEN_ERROR_IO;
+    fclose(f);
+    mem_free(MEM_LOADER, line);
+
+    if (status != GEN_OK) {
+        bank_shards_free(shards);
+    } else {
+        db->shards = shards;
+    }
+    trace_end(span, "bank_shards_open");
+    return status;
+}
+
+int bank_shards_load(Database* db, const char* matiere) {
+    if (!db->shards) return GEN_OK;
+    BankShard* shard = find_shard(db->shards, matiere);
+    if (!shard || shard->loaded) return GEN_OK;
+
+    char* path = path_join(db->shards->directory, shard->file);
+    if (!path) return GEN_ERROR_NO_MEMORY;
+    struct stat st;
+    int missing = stat(path, &st) != 0 && errno == ENOENT;
+    int first = db->count;
+    int status = missing ? GEN_OK : load_database(db, path);
+    mem_free(MEM_LOADER, path);
+
+    if (status != GEN_OK) {
+        // Une matière à moitié chargée perdrait le reste de son fichier au prochain enregistrement
+        while (db->count > first) delete_question_from_db(db, db->count - 1);
+        return status;
+    }
+    shard->loaded = 1;
+    return GEN_OK;
+}
+
+int bank_shards_pending(const Database* db) {
+    if (!db->shards) return 0;
+    for (int i = 0; i < db->shards->count; i++) {
+        if (!db->shards->shards[i].loaded) return 1;
+    }
+    return 0;
+}
+
+const BankShard* bank_shards_find(const Database* db, const char* matiere) {
+    return db->shards ? find_shard(db->shards, matiere) : NULL;
+}
+
+// --- Enregistrement ---
+
+// Nom de fichier tiré de la matière ("Réseaux Informatiques" -> "reseaux_informatiques.txt"),
+// numéroté s'il est déjà pris
+static void make_file_name(const char* matiere, const StringMap* files, char* name, size_t size) {
+    char folded[SHARD_NAME_MAX + 1];
+    char base[SHARD_NAME_MAX + 1];
+    size_t length = 0;
+    search_fold(matiere, folded, sizeof(folded));
+    for (const char* p = folded; *p; p++) {
+        if (*p != ' ') base[length++] = *p;
+        else if (length > 0 && base[length - 1] != '_') base[length++] = '_';
+    }
+    while (length > 0 && base[length - 1] == '_') length--;
+    base[length] = 0;
+    if (length == 0) strcpy(base, "matiere");
+
+    int unused;
+    snprintf(name, size, "%s.txt", base);
+    for (int n = 2; string_map_get(files, name, &unused); n++) {
+        snprintf(name, size, "%s_%d.txt", base, n);
+    }
+}
+
+// Liste des matières en cours d'écriture, avec ses tables matière -> index et fichier -> index
+typedef struct {
+    BankShards next;
+    StringMap subjects;
+    StringMap files;
+} ShardWriter;
+
+static int writer_add(ShardWriter* writer, const char* matiere, const char* file, BankShard** added) {
+    BankShard* shard = add_shard(&writer->next, matiere, file);
+    if (!shard) return GEN_ERROR_NO_MEMORY;
+    int index = writer->next.count - 1;
+    if (string_map_put(&writer->subjects, shard->matiere, index) < 0 ||
+        string_map_put(&writer->files, shard->file, index) < 0) {
+        return GEN_ERROR_NO_MEMORY;
+    }
+    *added = shard;
+    return GEN_OK;
+}
+
+// Reprend une matière du manifeste : description gardée si elle n'est pas chargée,
+// recalculée à partir des questions sinon
+static int keep_shard(ShardWriter* writer, const BankShard* shard) {
+    BankShard* copy;
+    int status = writer_add(writer, shard->matiere, shard->file, &copy);
+    if (status != GEN_OK) return status;
+    copy->loaded = shard->loaded;
+    if (shard->loaded) return GEN_OK;
+    copy->count = shard->count;
+    for (int i = 0; i < shard->nb_chapters && status == GEN_OK; i++) {
+        status = add_chapter(copy, shard->chapters[i]);
+    }
+    return status;
+}
+
+// Range la question dans sa matière (créée si besoin) ; *owner reçoit l'index de la matière
+static int assign_question(ShardWriter* writer, const Database* db, const Question* q, int* owner) {
+    BankShard* shard;
+    const char* matiere = question_matiere(db, q);
+    const char* chapitre = question_chapitre(db, q);
+    if (string_map_get(&writer->subjects, matiere, owner)) {
+        shard = &writer->next.shards[*owner];
+    } else {
+        char name[SHARD_NAME_MAX + 16];
+        make_file_name(matiere, &writer->files, name, sizeof(name));
+        int status = writer_add(writer, matiere, name, &shard);
+        if (status != GEN_OK) return status;
+        shard->loaded = 1;
+        *owner = writer->next.count - 1;
+    }
+    shard->count++;
+    for (int i = 0; i < shard->nb_chapters; i++) {
+        if (strcmp(shard->chapters[i], chapitre) == 0) return GEN_OK;
+    }
+    return add_chapter(shard, chapitre);
+}
+
+// Ouvre directory/name.tmp : le fichier en place n'est remplacé que par commit_temp, une fois
+// l'écriture complète (un lecteur ou une interruption ne voient jamais un fichier tronqué)
+static int open_temp(const char* directory, const char* name, char** temp_path, FILE** f) {
+    size_t length = strlen(directory) + strlen(name) + 6;
+    *temp_path = mem_alloc(MEM_LOADER, length);
+    if (!*temp_path) return GEN_ERROR_NO_MEMORY;
+    snprintf(*temp_path, length, "%s/%s.tmp", directory, name);
+    *f = fopen(*temp_path, "w");
+    if (*f) return GEN_OK;
+    mem_free(MEM_LOADER, *temp_path);
+    return GEN_ERROR_IO;
+}
+
+// Ferme f puis remplace directory/name par le fichier temporaire, supprimé en cas d'erreur
+static int commit_temp(FILE* f, const char* directory, const char* name, char* temp_path) {
+    int error = ferror(f);
+    if (fclose(f) != 0) error = 1;
+    char* path = error ? NULL : path_join(directory, name);
+    int status = error ? GEN_ERROR_IO : (path ? GEN_OK : GEN_ERROR_NO_MEMORY);
+    if (status == GEN_OK) {
+#ifdef _WIN32
+        remove(path); // rename ne remplace pas un fichier existant
+#endif
+        if (rename(temp_path, path) != 0) status = GEN_ERROR_IO;
+    }
+    if (status != GEN_OK) remove(temp_path);
+    mem_free(MEM_LOADER, path);
+    mem_free(MEM_LOADER, temp_path);
+    return status;
+}
+
+static int write_shard(const Database* db, const char* directory, const BankShard* shard,
+                       const int* owners, int index) {
+    char* temp_path;
+    FILE* f;
+    int status = open_temp(directory, shard->file, &temp_path, &f);
+    if (status != GEN_OK) return status;
+    database_write_header(f);
+    for (int i = 0; i < db->count; i++) {
+        if (owners[i] == index) database_write_question(f, db->labels, &db->questions[i]);
+    }
+    return commit_temp(f, directory, shard->file, temp_path);
+}
+
+static int write_manifest(const char* directory, const BankShards* shards) {
+    char* temp_path;
+    FILE* f;
+    int status = open_temp(directory, BANK_SHARDS_MANIFEST, &temp_path, &f);
+    if (status != GEN_OK) return status;
+    database_write_header(f);
+    for (int i = 0; i < shards->count; i++) {
+        const BankShard* shard = &shards->shards[i];
+        database_write_field(f, shard->matiere);
+        fputc(';', f);
+        database_write_field(f, shard->file);
+        fprintf(f, ";%d;", shard->count);
+        if (shard->nb_chapters == 0) fputs("-", f);
+        if (shard->nb_chapters == 1 && strcmp(shard->chapters[0], "-") == 0) fputc('\\', f); // Pas "aucun chapitre"
+        for (int j = 0; j < shard->nb_chapters; j++) {
+            if (j > 0) fputc('|', f);
+            database_write_field(f, shard->chapters[j]);
+        }
+        fputs("\n", f);
+    }
+    return commit_temp(f, directory, BANK_SHARDS_MANIFEST, temp_path);
+}
+
+// Libère le contenu de la liste, pas la structure
+static void free_shard_list(BankShards* shards) {
+    for (int i = 0; i < shards->count; i++) free_shard(&shards->shards[i]);
+    mem_free(MEM_LOADER, shards->shards);
+    shards->shards = NULL;
+    shards->count = 0;
+}
+
+int bank_shards_save(const Database* db, const char* directory) {
+    BankShards* current = db->shards;
+    if (current && strcmp(current->directory, directory) != 0 && bank_shards_pending(db)) {
+        return GEN_ERROR_INVALID_ARGUMENT;
+    }
+    if (!bank_shards_is_directory(directory) && mkdir(directory, 0777) != 0) return GEN_ERROR_IO;
+
+    uint64_t span = trace_begin();
+    ShardWriter writer = {0};
+    string_map_init(&writer.subjects);
+    string_map_init(&writer.files);
+    int status = GEN_OK;
+    int* owners = NULL;
+    if (db->count > 0 && !(owners = mem_alloc(MEM_LOADER, sizeof(int) * db->count))) status = GEN_ERROR_NO_MEMORY;
+    // Le manifeste ne peut pas servir de fichier à une matière
+    if (status == GEN_OK && string_map_put(&writer.files, BANK_SHARDS_MANIFEST, -1) < 0) status = GEN_ERROR_NO_MEMORY;
+
+    // 1. Matières du manifeste, dans son ordre
+    for (int i = 0; current && i < current->count && status == GEN_OK; i++) {
+        status = keep_shard(&writer, &current->shards[i]);
+    }
+    // 2. Répartition des questions ; une matière nouvelle reçoit son propre fichier
+    for (int i = 0; i < db->count && status == GEN_OK; i++) {
+        status = assign_question(&writer, db, &db->questions[i], &owners[i]);
+    }
+    // 3. Un fichier par matière chargée, puis le manifeste en dernier : les autres fichiers ne
+    // sont pas réécrits, et le manifeste en place reste celui d'avant si une matière échoue
+    for (int i = 0; i < writer.next.count && status == GEN_OK; i++) {
+        if (writer.next.shards[i].loaded) status = write_shard(db, directory, &writer.next.shards[i], owners, i);
+    }
+    if (status == GEN_OK) status = write_manifest(directory, &writer.next);
+
+    string_map_free(&writer.subjects);
+    string_map_free(&writer.files);
+    mem_free(MEM_LOADER, owners);
+
+    // La liste de la base suit ce qui vient d'être écrit (nombres, chapitres, nouvelles matières)
+    char* moved = NULL;
+    if (status == GEN_OK && current && strcmp(current->directory, directory) != 0 &&
+        !(moved = mem_strdup(MEM_LOADER, directory))) {
+        status = GEN_ERROR_NO_MEMORY;
+    }
+    if (status == GEN_OK && current) {
+        free_shard_list(current);
+        current->shards = writer.next.shards;
+        current->count = writer.next.count;
+        if (moved) {
+            mem_free(MEM_LOADER, current->directory);
+            current->directory = moved;
+        }
+    } else {
+        free_shard_list(&writer.next);
+    }
+    trace_end(span, "bank_shards_save");
+    return status;
+}
+
+void bank_shards_free(BankShards* shards) {
+    if (!shards) return;
+    free_shard_list(shards);
+    mem_free(MEM_LOADER, shards->directory);
+    mem_free(MEM_LOADER, shards);
+}
@@ -0,0 +1,59 @@
+// bank_shards.h - Base découpée en un fichier par matière, chargé à la première utilisation
+#ifndef BANK_SHARDS_H
+#define BANK_SHARDS_H
+
+#include "structures.h"
+#include "gen_status.h"
+
+// Fichier du répertoire qui décrit les matières : une ligne par matière,
+// matiere;fichier;nombre de questions;chapitre1|chapitre2|... ("-" si aucun chapitre).
+// Comme les fichiers de questions, il commence par DATABASE_FORMAT_HEADER et ses champs
+// sont échappés (database.h) ; sans cet en-tête, il est lu tel quel.
+#define BANK_SHARDS_MANIFEST "manifest.txt"
+
+// Une matière du manifeste. Tant qu'elle n'est pas chargée, count et chapters répondent
+// à sa place (liste des matières, des chapitres) ; une fois chargée, la base fait foi.
+typedef struct {
+    char* matiere;
+    char* file;          // Nom du fichier de la matière dans le répertoire
+    int count;
+    char** chapters;     // Dans l'ordre d'apparition dans le fichier
+    int nb_chapters;
+    int loaded;
+} BankShard;
+
+struct BankShards {
+    char* directory;
+    BankShard* shards;
+    int count;
+};
+
+// Retourne 1 si path est un répertoire (base découpée), 0 sinon
+int bank_shards_is_directory(const char* path);
+
+// Lit le manifeste de directory et rattache la liste des matières à db (db->shards), sans
+// charger aucune question. Retourne GEN_OK, GEN_ERROR_IO (manifeste illisible) ou
+// GEN_ERROR_NO_MEMORY ; db->shards reste alors NULL.
+int bank_shards_open(Database* db, const char* directory);
+
+// Charge dans db les questions de la matière si elle figure au manifeste et ne l'est pas
+// encore. Un fichier absent compte comme vide. En cas d'échec (GEN_ERROR_IO,
+// GEN_ERROR_NO_MEMORY), les questions déjà ajoutées sont retirées et la matière reste à charger.
+int bank_shards_load(Database* db, const char* matiere);
+
+// Retourne 1 si une matière du manifeste n'est pas encore chargée
+int bank_shards_pending(const Database* db);
+
+// Retourne la matière du manifeste (NULL si elle n'y figure pas)
+const BankShard* bank_shards_find(const Database* db, const char* matiere);
+
+// Écrit la base dans directory (créé au besoin) : un fichier par matière chargée ou
+// nouvelle, puis le manifeste. Les fichiers des matières non chargées ne sont pas touchés,
+// ce qui n'a de sens que dans le répertoire d'origine (sinon GEN_ERROR_INVALID_ARGUMENT).
+// Retourne GEN_OK, GEN_ERROR_IO ou GEN_ERROR_NO_MEMORY.
+int bank_shards_save(const Database* db, const char* directory);
+
+// Libère la liste créée par bank_shards_open (free_database s'en charge) ; NULL accepté
+void bank_shards_free(BankShards* shards);
+
+#endif
@@ -0,0 +1,417 @@
+// bank_watch.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bank_watch.h"
+#include "database.h"
+#include "string_map.h"
+#include "mem_track.h"
+#include "trace.h"
+
+#ifdef __linux__
+    #include <unistd.h>
+    #include <sys/inotify.h>
+#endif
+
+// Contenu du fichier, découpé en morceaux comme les lit fgets dans load_database
+typedef struct {
+    char* text;
+    size_t* starts;    // starts[i] : début du morceau i ; starts[count] : taille du texte
+    BankLine* lines;
+    int count;
+    DatabaseFormat format;
+} BankFile;
+
+// Entrée de la table des lignes de la version précédente, triée par empreinte
+typedef struct {
+    uint64_t hash;
+    int index;
+} OldLine;
+
+// Fin du morceau qui commence à pos : après le '\n', ou DATABASE_LINE_MAX - 1 octets plus loin
+static size_t chunk_end(const char* text, size_t size, size_t pos) {
+    size_t limit = size - pos < DATABASE_LINE_MAX - 1 ? size : pos + DATABASE_LINE_MAX - 1;
+    const char* newline = memchr(text + pos, '\n', limit - pos);
+    return newline ? (size_t)(newline - text) + 1 : limit;
+}
+
+// Copie le morceau i terminé par '\0' (line : DATABASE_LINE_MAX octets)
+static void chunk_copy(const BankFile* file, int i, char* line) {
+    size_t length = file->starts[i + 1] - file->starts[i];
+    memcpy(line, file->text + file->starts[i], length);
+    line[length] = 0;
+}
+
+static void free_bank_file(BankFile* file) {
+    mem_free(MEM_LOADER, file->text);
+    mem_free(MEM_LOADER, file->starts);
+    mem_free(MEM_LOADER, file->lines);
+    memset(file, 0, sizeof(*file));
+}
+
+// Lit tout le fichier et calcule l'empreinte de chaque morceau ; les id valent -1.
+// Un fichier absent est lu comme vide.
+static int read_bank_file(const char* path, BankFile* file) {
+    memset(file, 0, sizeof(*file));
+    FILE* f = fopen(path, "rb");
+    size_t size = 0;
+    if (f) {
+        if (fseek(f, 0, SEEK_END) != 0 || ftell(f) < 0) {
+            fclose(f);
+            return GEN_ERROR_IO;
+        }
+        size = (size_t)ftell(f);
+        rewind(f);
+    }
+    file->text = mem_alloc(MEM_LOADER, size + 1);
+    if (!file->text) {
+        if (f) fclose(f);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    if (f) {
+        size_t read = fread(file->text, 1, size, f);
+        int error = ferror(f);
+        fclose(f);
+        if (error) {
+            free_bank_file(file);
+            return GEN_ERROR_IO;
+        }
+        size = read; // Fichier raccourci entre-temps
+    }
+    file->text[size] = 0;
+    file->format = database_file_format(file->text);
+    // Empreintes propres au format : une ligne identique mais lue autrement n'est plus la même
+    uint64_t salt = (file->format == DATABASE_FORMAT_ESCAPED) ? 0x9E3779B97F4A7C15ULL : 0;
+
+    int count = 0;
+    for (size_t pos = 0; pos < size; pos = chunk_end(file->text, size, pos)) count++;
+    file->starts = mem_alloc(MEM_LOADER, (count + 1) * sizeof(size_t));
+    file->lines = mem_alloc(MEM_LOADER, (count ? count : 1) * sizeof(BankLine));
+    if (!file->starts || !file->lines) {
+        free_bank_file(file);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    size_t pos = 0;
+    for (int i = 0; i < count; i++) {
+        size_t end = chunk_end(file->text, size, pos);
+        size_t length = end - pos;
+        const char* eol = memchr(file->text + pos, '\n', length);
+        if (eol) length = (size_t)(eol - (file->text + pos));
+        const char* cr = memchr(file->text + pos, '\r', length);
+        if (cr) length = (size_t)(cr - (file->text + pos)); // Comme strcspn(line, "\r\n")
+        file->starts[i] = pos;
+        file->lines[i].hash = hash_bytes(file->text + pos, length) ^ salt;
+        file->lines[i].id = -1;
+        pos = end;
+    }
+    file->starts[count] = size;
+    file->count = count;
+    return GEN_OK;
+}
+
+// Associe dans l'ordre les lignes retenues par l'analyse aux questions de db
+static void assign_ids(BankFile* file, const Database* db) {
+    char line[DATABASE_LINE_MAX];
+    int next = 0;
+    for (int i = 0; i < file->count && next < db->count; i++) {
+        chunk_copy(file, i, line);
+        if (is_question_line(line, file->format)) file->lines[i].id = db->questions[next++].id;
+    }
+}
+
+// Garde les empreintes du fichier lu ; le texte n'est plus nécessaire
+static void keep_lines(BankWatch* watch, BankFile* file) {
+    mem_free(MEM_LOADER, watch->lines);
+    watch->lines = file->lines;
+    watch->count = file->count;
+    file->lines = NULL;
+    free_bank_file(file);
+}
+
+static void start_watching(BankWatch* watch) {
+#ifdef __linux__
+    const char* slash = strrchr(watch->path, '/');
+    char* dir = mem_strdup(MEM_LOADER, slash ? watch->path : ".");
+    watch->name = mem_strdup(MEM_LOADER, slash ? slash + 1 : watch->path);
+    if (!dir || !watch->name) {
+        mem_free(MEM_LOADER, dir);
+        return;
+    }
+    if (slash) dir[slash == watch->path ? 1 : slash - watch->path] = 0; // "/fichier" : répertoire "/"
+
+    watch->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watch->fd >= 0) {
+        watch->wd = inotify_add_watch(watch->fd, dir, IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (watch->wd < 0) {
+            close(watch->fd);
+            watch->fd = -1;
+        }
+    }
+    mem_free(MEM_LOADER, dir);
+#endif
+}
+
+int bank_watch_init(BankWatch* watch, const Database* db, const char* path) {
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+    watch->wd = -1;
+    watch->path = mem_strdup(MEM_LOADER, path);
+    if (!watch->path) return GEN_ERROR_NO_MEMORY;
+
+    BankFile file;
+    int status = read_bank_file(path, &file);
+    if (status != GEN_OK) {
+        bank_watch_free(watch);
+        return status;
+    }
+    assign_ids(&file, db);
+    keep_lines(watch, &file);
+    start_watching(watch);
+    return GEN_OK;
+}
+
+int bank_watch_fd(const BankWatch* watch) {
+    return watch->fd;
+}
+
+int bank_watch_poll(BankWatch* watch) {
+    int changed = 0;
+#ifdef __linux__
+    if (watch->fd < 0) return 0;
+    char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t length;
+    while ((length = read(watch->fd, buffer, sizeof(buffer))) > 0) {
+        for (char* p = buffer; p < buffer + length;) {
+            const struct inotify_event* event = (const struct inotify_event*)p;
+            // Événements perdus : on relit par précaution
+            if ((event->mask & IN_Q_OVERFLOW) || (event->len > 0 && strcmp(event->name, watch->name) == 0)) {
+                changed = 1;
+            }
+            p += sizeof(struct inotify_event) + event->len;
+        }
+    }
+#endif
+    return changed;
+}
+
+int bank_watch_rebase(BankWatch* watch, const Database* db) {
+    BankFile file;
+    int status = read_bank_file(watch->path, &file);
+    if (status != GEN_OK) return status;
+    assign_ids(&file, db);
+    keep_lines(watch, &file);
+    return GEN_OK;
+}
+
+static int compare_old_lines(const void* a, const void* b) {
+    const OldLine* x = a;
+    const OldLine* y = b;
+    if (x->hash != y->hash) return x->hash < y->hash ? -1 : 1;
+    return x->index - y->index;
+}
+
+// Première entrée d'empreinte hash dans la table triée, ou count
+static int find_first(const OldLine* table, int count, uint64_t hash) {
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (table[mid].hash < hash) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+// Ligne à prendre en compte au prochain rechargement : son empreinte ne correspond plus à rien
+#define LINE_RETRY_HASH 0
+
+// Tableaux de travail d'un rechargement, dimensionnés sur le milieu du fichier qui a changé
+typedef struct {
+    int prefix;          // Lignes identiques au début des deux versions
+    int old_middle;      // Lignes suivantes, jusqu'à la fin commune
+    int new_middle;
+    OldLine* table;
+    char* old_used;
+    char* new_matched;
+    int* removed;        // Identifiants des lignes disparues
+    int nb_removed;
+    int* fresh;          // Lignes nouvelles analysées, et leur question dans parsed
+    Question* parsed;
+    int nb_fresh;
+} ReloadWork;
+
+static int alloc_work(ReloadWork* work) {
+    int old_size = work->old_middle ? work->old_middle : 1;
+    int new_size = work->new_middle ? work->new_middle : 1;
+    work->table = mem_alloc(MEM_LOADER, old_size * sizeof(OldLine));
+    work->old_used = mem_calloc(MEM_LOADER, old_size, 1);
+    work->new_matched = mem_calloc(MEM_LOADER, new_size, 1);
+    work->removed = mem_alloc(MEM_LOADER, old_size * sizeof(int));
+    work->fresh = mem_alloc(MEM_LOADER, new_size * sizeof(int));
+    work->parsed = mem_alloc(MEM_LOADER, new_size * sizeof(Question));
+    if (!work->table || !work->old_used || !work->new_matched || !work->removed || !work->fresh || !work->parsed) {
+        return GEN_ERROR_NO_MEMORY;
+    }
+    return GEN_OK;
+}
+
+static void free_work(ReloadWork* work) {
+    mem_free(MEM_LOADER, work->table);
+    mem_free(MEM_LOADER, work->old_used);
+    mem_free(MEM_LOADER, work->new_matched);
+    mem_free(MEM_LOADER, work->removed);
+    mem_free(MEM_LOADER, work->fresh);
+    mem_free(MEM_LOADER, work->parsed);
+}
+
+// Début et fin communs aux deux versions : les lignes gardent leur question
+static void match_ends(const BankWatch* watch, BankFile* file, ReloadWork* work, BankReloadStats* stats) {
+    const BankLine* old = watch->lines;
+    BankLine* lines = file->lines;
+    int prefix = 0;
+    while (prefix < file->count && prefix < watch->count && old[prefix].hash == lines[prefix].hash) {
+        lines[prefix].id = old[prefix].id;
+        stats->unchanged += (lines[prefix].id >= 0);
+        prefix++;
+    }
+    int suffix = 0;
+    while (suffix < file->count - prefix && suffix < watch->count - prefix &&
+           old[watch->count - 1 - suffix].hash == lines[file->count - 1 - suffix].hash) {
+        BankLine* line = &lines[file->count - 1 - suffix];
+        line->id = old[watch->count - 1 - suffix].id;
+        stats->unchanged += (line->id >= 0);
+        suffix++;
+    }
+    work->prefix = prefix;
+    work->old_middle = watch->count - prefix - suffix;
+    work->new_middle = file->count - prefix - suffix;
+}
+
+// Lignes déplacées au milieu, appariées par empreinte (des lignes identiques sont prises
+// dans l'ordre) ; les autres lignes nouvelles sont analysées, sans toucher à la base
+static int match_middle(const BankWatch* watch, BankFile* file, ReloadWork* work, BankReloadStats* stats) {
+    const BankLine* old = watch->lines + work->prefix;
+    BankLine* lines = file->lines + work->prefix;
+    for (int i = 0; i < work->old_middle; i++) {
+        work->table[i].hash = old[i].hash;
+        work->table[i].index = i;
+    }
+    qsort(work->table, work->old_middle, sizeof(OldLine), compare_old_lines);
+    for (int i = 0; i < work->new_middle; i++) {
+        int t = find_first(work->table, work->old_middle, lines[i].hash);
+        for (; t < work->old_middle && work->table[t].hash == lines[i].hash; t++) {
+            if (work->old_used[work->table[t].index]) continue;
+            work->old_used[work->table[t].index] = 1;
+            work->new_matched[i] = 1;
+            lines[i].id = old[work->table[t].index].id;
+            stats->unchanged += (lines[i].id >= 0);
+            break;
+        }
+    }
+
+    for (int i = 0; i < work->old_middle; i++) {
+        if (!work->old_used[i] && old[i].id >= 0) work->removed[work->nb_removed++] = old[i].id;
+    }
+    char text[DATABASE_LINE_MAX];
+    for (int i = 0; i < work->new_middle; i++) {
+        if (work->new_matched[i]) continue;
+        chunk_copy(file, work->prefix + i, text);
+        int result = parse_question_line(text, file->format, &work->parsed[work->nb_fresh]);
+        if (result > 0) {
+            work->fresh[work->nb_fresh++] = work->prefix + i;
+        } else if (result < 0) {
+            for (int k = 0; k < work->nb_fresh; k++) free_question_content(&work->parsed[k]);
+            work->nb_fresh = 0;
+            return result;
+        }
+    }
+    return GEN_OK;
+}
+
+// Remplacements dans l'ordre, puis suppressions, puis ajouts en un seul lot. Une question
+// remplacée dans le fichier mais supprimée entre-temps de la base est ajoutée à nouveau.
+static int apply_changes(Database* db, BankFile* file, ReloadWork* work, BankReloadStats* stats) {
+    BankLine* lines = file->lines;
+    int status = GEN_OK;
+    int pairs = work->nb_removed < work->nb_fresh ? work->nb_removed : work->nb_fresh;
+    int nb_added = 0;
+    for (int k = 0; k < pairs; k++) {
+        int index = database_find_by_id(db, work->removed[k]);
+        if (index < 0) {
+            work->parsed[nb_added] = work->parsed[k];
+            work->fresh[nb_added++] = work->fresh[k];
+            continue;
+        }
+        int result = update_question_in_db(db, index, work->parsed[k]);
+        lines[work->fresh[k]].id = work->removed[k];
+        if (result == GEN_OK) {
+            stats->updated++;
+        } else {
+            lines[work->fresh[k]].hash = LINE_RETRY_HASH;
+            status = result;
+        }
+    }
+    for (int k = pairs; k < work->nb_removed; k++) {
+        int index = database_find_by_id(db, work->removed[k]);
+        if (index >= 0 && delete_question_from_db(db, index) == GEN_OK) stats->removed++;
+    }
+    for (int k = pairs; k < work->nb_fresh; k++) {
+        work->parsed[nb_added] = work->parsed[k];
+        work->fresh[nb_added++] = work->fresh[k];
+    }
+    if (nb_added == 0) return status;
+
+    int first_id = db->next_id;
+    int result = add_questions_to_db(db, work->parsed, nb_added);
+    for (int k = 0; k < nb_added; k++) {
+        if (result == GEN_OK) {
+            lines[work->fresh[k]].id = first_id + k;
+        } else {
+            free_question_content(&work->parsed[k]);
+            lines[work->fresh[k]].hash = LINE_RETRY_HASH;
+        }
+    }
+    if (result != GEN_OK) return result;
+    stats->added = nb_added;
+    return status;
+}
+
+int bank_watch_reload(BankWatch* watch, Database* db, BankReloadStats* stats) {
+    BankReloadStats local;
+    if (!stats) stats = &local;
+    memset(stats, 0, sizeof(*stats));
+
+    uint64_t span = trace_begin();
+    BankFile file;
+    int status = read_bank_file(watch->path, &file);
+    if (status != GEN_OK) {
+        trace_end(span, "bank_watch_reload");
+        return status;
+    }
+    ReloadWork work;
+    memset(&work, 0, sizeof(work));
+    match_ends(watch, &file, &work, stats);
+    status = alloc_work(&work);
+    if (status == GEN_OK) status = match_middle(watch, &file, &work, stats);
+    if (status == GEN_OK) {
+        status = apply_changes(db, &file, &work, stats);
+        keep_lines(watch, &file);
+    } else {
+        stats->unchanged = 0; // Rien n'a été appliqué
+        free_bank_file(&file);
+    }
+    free_work(&work);
+    trace_end(span, "bank_watch_reload");
+    return status;
+}
+
+void bank_watch_free(BankWatch* watch) {
+#ifdef __linux__
+    if (watch->fd >= 0) close(watch->fd);
+#endif
+    mem_free(MEM_LOADER, watch->path);
+    mem_free(MEM_LOADER, watch->name);
+    mem_free(MEM_LOADER, watch->lines);
+    memset(watch, 0, sizeof(*watch));
+    watch->fd = -1;
+    watch->wd = -1;
+}
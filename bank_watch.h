@@ -0,0 +1,69 @@
+// bank_watch.h - Rechargement à chaud du fichier de questions modifié par un autre programme
+#ifndef BANK_WATCH_H
+#define BANK_WATCH_H
+
+#include <stdint.h>
+#include "structures.h"
+#include "gen_status.h"
+
+// Attente après le dernier événement avant de relire le fichier : un éditeur écrit
+// souvent en plusieurs fois (fichier temporaire, renommage)
+#define BANK_WATCH_DELAY_MS 200
+
+// Une ligne du fichier, découpée comme le fait load_database (morceaux de DATABASE_LINE_MAX)
+typedef struct {
+    uint64_t hash;     // Empreinte du contenu, sans la fin de ligne
+    int id;            // Question issue de la ligne, -1 si la ligne n'en donne pas
+} BankLine;
+
+typedef struct {
+    int added;
+    int updated;
+    int removed;
+    int unchanged;     // Questions dont la ligne est restée identique (éventuellement déplacée)
+} BankReloadStats;
+
+// Surveillance d'un fichier de questions. Le contenu lu ou écrit en dernier est gardé sous
+// forme d'empreintes de lignes ; à chaque changement, seules les lignes qui n'existaient pas
+// sont analysées et la base reçoit des ajouts, remplacements et suppressions ordinaires.
+// Les écouteurs (index de recherche, modèle de liste, instantanés) suivent donc sans
+// rechargement complet, et les questions inchangées gardent leur identifiant.
+typedef struct {
+    char* path;
+    BankLine* lines;
+    int count;
+    int fd;            // Descripteur inotify (Linux), -1 si la surveillance n'est pas disponible
+    int wd;
+    char* name;        // Nom du fichier dans son répertoire, qui est surveillé (renommages des éditeurs)
+} BankWatch;
+
+// Relit path et associe ses lignes, dans l'ordre, aux questions de db : la base doit venir
+// d'être chargée depuis ce fichier ou enregistrée dedans. Un fichier absent compte comme vide.
+// La surveillance est ensuite ouverte si le système la permet (sinon fd vaut -1 et
+// bank_watch_reload reste utilisable à la demande).
+// Retourne GEN_OK, GEN_ERROR_NO_MEMORY ou GEN_ERROR_IO (fichier illisible).
+int bank_watch_init(BankWatch* watch, const Database* db, const char* path);
+
+// Descripteur à surveiller en lecture (poll, GLib...), ou -1
+int bank_watch_fd(const BankWatch* watch);
+
+// Vide les événements en attente sans bloquer ; retourne 1 si le fichier a changé
+int bank_watch_poll(BankWatch* watch);
+
+// Relit le fichier et applique à db les différences avec la version précédente :
+// lignes identiques (même déplacées) ignorées, lignes disparues et nouvelles appariées dans
+// l'ordre en remplacements, le reste en suppressions et en ajouts (un seul lot). Le fichier
+// fait foi pour les lignes qui ont changé ; les questions ajoutées dans la base et pas encore
+// enregistrées ne sont pas touchées. stats peut être NULL.
+// Retourne GEN_OK, GEN_ERROR_IO (fichier illisible, base inchangée) ou GEN_ERROR_NO_MEMORY
+// (base inchangée si l'analyse échoue ; sinon, les lignes non appliquées seront vues comme
+// nouvelles au prochain rechargement).
+int bank_watch_reload(BankWatch* watch, Database* db, BankReloadStats* stats);
+
+// Reprend le fichier comme référence après save_database(db, path), pour que
+// l'événement de cette écriture ne soit pas pris pour une modification extérieure
+int bank_watch_rebase(BankWatch* watch, const Database* db);
+
+void bank_watch_free(BankWatch* watch);
+
+#endif
@@ -0,0 +1,487 @@
+// batch.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#ifdef _WIN32
+    #include <windows.h>
+#else
+    #include <unistd.h>
+#endif
+#include "batch.h"
+#include "database.h"
+#include "bank_shards.h"
+#include "generator.h"
+#include "renderer.h"
+#include "json.h"
+#include "string_map.h"
+#include "perf_counters.h"
+#include "trace.h"
+
+// Un travail du manifeste, validé, avec sa partition de questions
+typedef struct {
+    const char* subject;
+    const char** chapters;
+    int nb_chapters;
+    ExamType exam_type;
+    int count;                   // Variantes par chapitre
+    const char* format;
+    uint64_t seed;
+    const char* output;
+    int avoid_near_duplicates;
+    char error[160];             // Non vide : travail invalide, rien n'est généré
+    ChapterPartition partition;
+    int first_unit;              // Épreuves de ce travail : units[first_unit .. first_unit + nb_units[
+    int nb_units;
+} BatchJob;
+
+// Une épreuve à produire : un chapitre et une variante d'un travail
+typedef struct {
+    BatchJob* job;
+    int pool;
+    int variant;
+    uint64_t seed;
+    char* filename;              // "<sortie>[_<chapitre>][_vNNN]."
+    int result;
+    char error[256];             // Compte rendu du générateur en cas d'échec
+} BatchUnit;
+
+typedef struct {
+    const Database* db;
+    const char* stream_path;     // Non NULL : génération en flux depuis ce fichier, db reste vide
+    BatchUnit* units;
+    int nb_units;
+    int next;                    // Prochaine épreuve à prendre, protégé par lock
+    pthread_mutex_t lock;
+} BatchQueue;
+
+// --- Outils ---
+
+static int cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return (int)info.dwNumberOfProcessors;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return (n > 0) ? (int)n : 1;
+#endif
+}
+
+static double now_ms(void) {
+#ifdef _WIN32
+    return (double)GetTickCount64();
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+#endif
+}
+
+static char* read_file(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return NULL;
+    char* text = NULL;
+    if (fseek(f, 0, SEEK_END) == 0) {
+        long size = ftell(f);
+        if (size >= 0 && fseek(f, 0, SEEK_SET) == 0) {
+            text = malloc((size_t)size + 1);
+            if (text) {
+                size_t n = fread(text, 1, (size_t)size, f);
+                text[n] = 0;
+            }
+        }
+    }
+    fclose(f);
+    return text;
+}
+
+// --- Lecture du manifeste ---
+
+static int format_is_valid(const char* format) {
+    int nb_formats = 0;
+    const char* p = format;
+    while (*p) {
+        size_t len = strcspn(p, ",+");
+        if (!renderer_find_n(p, len)) return 0;
+        nb_formats++;
+        p += len;
+        if (*p) p++;
+    }
+    return nb_formats > 0 && nb_formats <= GENERATOR_MAX_OUTPUTS;
+}
+
+static void read_job(const JsonValue* value, int index, uint64_t default_seed, BatchJob* job) {
+    job->output = NULL;
+    if (value->type != JSON_OBJECT) {
+        snprintf(job->error, sizeof(job->error), "le travail %d n'est pas un objet", index + 1);
+        return;
+    }
+
+    job->subject = json_get_string(value, "subject", json_get_string(value, "matiere", NULL));
+    job->output = json_get_string(value, "output", job->subject);
+    job->format = json_get_string(value, "format", "PDF");
+    job->avoid_near_duplicates = json_get_bool(value, "avoid_near_duplicates", 0);
+
+    double count = json_get_number(value, "count", 1);
+    job->count = (count >= 1 && count <= BATCH_MAX_VARIANTS) ? (int)count : 0;
+
+    // Graine absente : dérivée de l'horloge et du rang, et reportée dans le résumé.
+    // Les nombres JSON sont des doubles : au-delà de 2^53 la graine ne serait pas exacte.
+    const JsonValue* seed = json_get(value, "seed");
+    int seed_is_valid = 1;
+    if (seed && seed->type != JSON_NULL) {
+        seed_is_valid = (seed->type == JSON_NUMBER && seed->number >= 0 && seed->number <= 9007199254740992.0);
+        job->seed = seed_is_valid ? (uint64_t)seed->number : 0;
+    } else {
+        job->seed = generator_mix_seed(default_seed + (uint64_t)index) >> 11;
+    }
+
+    const char* type = json_get_string(value, "type", "qcm");
+    if (strcmp(type, "qcm") == 0 || strcmp(type, "QCM") == 0) {
+        job->exam_type = EXAM_TYPE_QCM_ONLY;
+    } else if (strcmp(type, "mixte") == 0 || strcmp(type, "mixed") == 0) {
+        job->exam_type = EXAM_TYPE_MIXED;
+    } else {
+        snprintf(job->error, sizeof(job->error), "type inconnu '%s' (qcm ou mixte)", type);
+        return;
+    }
+
+    // "chapters" : un tableau de noms, ou un seul nom
+    const JsonValue* chapters = json_get(value, "chapters");
+    if (!chapters) chapters = json_get(value, "chapitres");
+    if (chapters && chapters->type == JSON_STRING) {
+        job->nb_chapters = 1;
+        job->chapters = malloc(sizeof(char*));
+        if (job->chapters) job->chapters[0] = chapters->string;
+    } else if (chapters && chapters->type == JSON_ARRAY && chapters->count > 0) {
+        job->chapters = malloc(sizeof(char*) * chapters->count);
+        for (int c = 0; c < chapters->count && job->chapters; c++) {
+            if (chapters->items[c]->type != JSON_STRING) {
+                snprintf(job->error, sizeof(job->error), "\"chapters\" ne doit contenir que des chaines");
+                return;
+            }
+            job->chapters[job->nb_chapters++] = chapters->items[c]->string;
+        }
+    } else if (chapters && chapters->type != JSON_NULL && chapters->type != JSON_ARRAY) {
+        snprintf(job->error, sizeof(job->error), "\"chapters\" doit etre une chaine ou un tableau");
+        return;
+    }
+    if (chapters && job->nb_chapters > 0 && !job->chapters) {
+        snprintf(job->error, sizeof(job->error), "memoire insuffisante");
+        return;
+    }
+
+    if (!job->subject || job->subject[0] == 0) {
+        snprintf(job->error, sizeof(job->error), "\"subject\" manquant");
+    } else if (!job->output || job->output[0] == 0) {
+        snprintf(job->error, sizeof(job->error), "\"output\" vide");
+    } else if (job->count == 0 || count != job->count) {
+        snprintf(job->error, sizeof(job->error), "\"count\" doit etre un entier entre 1 et %d", BATCH_MAX_VARIANTS);
+    } else if (!seed_is_valid) {
+        snprintf(job->error, sizeof(job->error), "\"seed\" doit etre un entier entre 0 et 2^53");
+    } else if (!format_is_valid(job->format)) {
+        snprintf(job->error, sizeof(job->error), "format inconnu '%s'", job->format);
+    }
+}
+
+// Nom de base d'une épreuve, sans extension ; le point final empêche qu'un nom de
+// chapitre contenant un point soit pris pour une extension
+static char* unit_filename(const BatchJob* job, int pool, int variant) {
+    const char* output = job->output;
+    const char* dot = strrchr(output, '.');
+    int base_len = dot ? (int)(dot - output) : (int)strlen(output);
+    const char* chapter = (job->nb_chapters > 0) ? job->partition.pools[pool].chapitre : "";
+
+    size_t size = base_len + strlen(chapter) + 16;
+    char* filename = malloc(size);
+    if (!filename) return NULL;
+    int len = snprintf(filename, size, "%.*s", base_len, output);
+    if (chapter[0]) len += snprintf(filename + len, size - len, "_%s", chapter);
+    if (job->count > 1) len += snprintf(filename + len, size - len, "_v%03d", variant + 1);
+    snprintf(filename + len, size - len, ".");
+
+    for (char* p = filename + base_len; *p; p++) {
+        if (*p == ' ' || *p == '/' || *p == '\\') *p = '_';
+    }
+    return filename;
+}
+
+// --- Exécution ---
+
+static void* batch_worker(void* data) {
+    BatchQueue* queue = data;
+    trace_set_thread_name("batch-worker");
+    for (;;) {
+        pthread_mutex_lock(&queue->lock);
+        int i = queue->next++;
+        pthread_mutex_unlock(&queue->lock);
+        if (i >= queue->nb_units) break;
+
+        BatchUnit* unit = &queue->units[i];
+        const BatchJob* job = unit->job;
+        if (!job || !unit->filename) continue;
+        GenerationReport report;
+        ExamRequest request = {0};
+        request.matiere = job->subject;
+        request.exam_type = job->exam_type;
+        request.avoid_near_duplicates = job->avoid_near_duplicates;
+        request.seeded = 1;
+        request.seed = unit->seed;
+        request.report = &report;
+        if (queue->stream_path) {
+            request.chapitre = job->partition.pools[unit->pool].chapitre;
+            unit->result = generate_exam_files_stream(queue->stream_path, &request, unit->filename, job->format);
+        } else {
+            unit->result = generate_exam_files_from_pool(queue->db, &request, &job->partition.pools[unit->pool],
+                                                         unit->filename, job->format);
+        }
+        if (unit->result != GEN_OK) {
+            snprintf(unit->error, sizeof(unit->error), "%s",
+                     report.message[0] ? report.message : gen_status_message(unit->result));
+        }
+    }
+    return NULL;
+}
+
+static void write_summary(FILE* out, const char* db_file, const char* manifest_path, int nb_questions,
+                          int nb_threads, double elapsed, BatchJob* jobs, int nb_jobs, BatchUnit* units,
+                          int generated, int failed) {
+    fprintf(out, "{\n");
+    fprintf(out, "  \"manifest\": ");
+    json_write_string(out, manifest_path);
+    fprintf(out, ",\n  \"database\": ");
+    json_write_string(out, db_file);
+    fprintf(out, ",\n  \"questions\": %d,\n  \"threads\": %d,\n  \"elapsed_ms\": %.1f,\n", nb_questions, nb_threads, elapsed);
+    if (perf_counters_enabled()) {
+        fprintf(out, "  \"perf_counters\": ");
+        perf_counters_write_json(out);
+        fprintf(out, ",\n");
+    }
+    fprintf(out, "  \"generated\": %d,\n  \"failed\": %d,\n  \"jobs\": [", generated, failed);
+
+    for (int j = 0; j < nb_jobs; j++) {
+        const BatchJob* job = &jobs[j];
+        int job_failed = 0;
+        for (int u = job->first_unit; u < job->first_unit + job->nb_units; u++) {
+            if (units[u].result != 0) job_failed++;
+        }
+        const char* status = job->error[0] ? "invalid"
+                           : (job_failed == 0) ? "ok"
+                           : (job_failed == job->nb_units) ? "failed" : "partial";
+
+        fprintf(out, "%s\n    {\"output\": ", j ? "," : "");
+        json_write_string(out, job->output);
+        fprintf(out, ", \"subject\": ");
+        json_write_string(out, job->subject);
+        fprintf(out, ", \"seed\": %llu, \"status\": \"%s\"", (unsigned long long)job->seed, status);
+        if (job->error[0]) {
+            fprintf(out, ", \"error\": ");
+            json_write_string(out, job->error);
+        }
+        fprintf(out, ", \"generated\": %d, \"failed\": %d,\n     \"exams\": [",
+                job->nb_units - job_failed, job->error[0] ? 1 : job_failed);
+        for (int u = job->first_unit; u < job->first_unit + job->nb_units; u++) {
+            // Nom affiché sans le point final ajouté par unit_filename()
+            char* name = units[u].filename;
+            if (name && name[0]) name[strlen(name) - 1] = 0;
+            fprintf(out, "%s{\"name\": ", (u > job->first_unit) ? ", " : "");
+            json_write_string(out, name);
+            fprintf(out, ", \"status\": \"%s\"", units[u].result == 0 ? "ok" : "failed");
+            if (units[u].error[0]) {
+                fprintf(out, ", \"error\": ");
+                json_write_string(out, units[u].error);
+            }
+            fprintf(out, "}");
+        }
+        fprintf(out, "]}");
+    }
+    fprintf(out, "%s]\n}\n", nb_jobs ? "\n  " : "");
+}
+
+int run_batch_jobs(const char* db_file, const char* manifest_path, int nb_threads) {
+    double start = now_ms();
+
+    // La sortie standard est réservée au résumé (la génération n'affiche rien) ;
+    // les messages de progression partent sur la sortie d'erreur.
+    FILE* summary = stdout;
+
+    char error[160];
+    JsonValue* manifest = NULL;
+    char* text = read_file(manifest_path);
+    if (!text) {
+        snprintf(error, sizeof(error), "impossible de lire le manifeste");
+    } else {
+        manifest = json_parse(text, error, sizeof(error));
+        free(text);
+    }
+
+    const JsonValue* list = manifest;
+    if (manifest && manifest->type == JSON_OBJECT) list = json_get(manifest, "jobs");
+    if (manifest && (!list || list->type != JSON_ARRAY)) {
+        snprintf(error, sizeof(error), "le manifeste doit etre un tableau de travaux ou un objet {\"jobs\": [...]}");
+        list = NULL;
+    }
+    if (!list) {
+        fprintf(stderr, "Manifeste '%s' : %s\n", manifest_path, error);
+        fprintf(summary, "{\"manifest\": ");
+        json_write_string(summary, manifest_path);
+        fprintf(summary, ", \"error\": ");
+        json_write_string(summary, error);
+        fprintf(summary, "}\n");
+        fflush(summary);
+        json_free(manifest);
+        return 2;
+    }
+
+    // Base chargée une seule fois, partagée en lecture par tous les threads ; en flux, chaque
+    // épreuve relit le fichier et la base reste vide (les partitions ne servent qu'aux noms)
+    Database db = {0};
+    int stream = (manifest->type == JSON_OBJECT) && json_get_bool(manifest, "stream", 0);
+    if (stream) {
+        fprintf(stderr, "Generation en flux depuis '%s' : la base n'est pas chargee.\n", db_file);
+    } else {
+        int status = load_database(&db, db_file);
+        if (status == GEN_ERROR_IO) {
+            fprintf(stderr, "AVERTISSEMENT: Fichier '%s' non trouve. Une base de donnees vide sera utilisee.\n", db_file);
+        } else if (status != GEN_OK) {
+            // Une base chargée en partie donnerait des épreuves incomplètes sans le signaler
+            fprintf(stderr, "Base de donnees '%s' : %s\n", db_file, gen_status_message(status));
+            fprintf(summary, "{\"database\": ");
+            json_write_string(summary, db_file);
+            fprintf(summary, ", \"error\": ");
+            json_write_string(summary, gen_status_message(status));
+            fprintf(summary, "}\n");
+            fflush(summary);
+            json_free(manifest);
+            free_database(&db);
+            return 2;
+        }
+        if (db.shards) {
+            fprintf(stderr, "Base decoupee '%s' : %d matieres, chargees selon les travaux.\n", db_file, db.shards->count);
+        } else {
+            fprintf(stderr, "Base de donnees '%s' chargee. %d questions trouvees.\n", db_file, db.count);
+        }
+    }
+
+    int nb_jobs = list->count;
+    BatchJob* jobs = calloc(nb_jobs > 0 ? nb_jobs : 1, sizeof(BatchJob));
+    if (!jobs) {
+        perror("Erreur d'allocation des travaux");
+        fflush(summary);
+        json_free(manifest);
+        free_database(&db);
+        return 2;
+    }
+
+    uint64_t default_seed = (uint64_t)time(NULL);
+    int nb_units = 0;
+    for (int j = 0; j < nb_jobs; j++) {
+        BatchJob* job = &jobs[j];
+        read_job(list->items[j], j, default_seed, job);
+        // Base découpée : seules les matières demandées sont chargées, avant le départ des threads
+        int loaded = (job->error[0] || stream) ? GEN_OK : database_require_subject(&db, job->subject);
+        if (loaded != GEN_OK) {
+            snprintf(job->error, sizeof(job->error), "matiere non chargee : %s", gen_status_message(loaded));
+        }
+        if (!job->error[0] &&
+            partition_by_chapter(&db, job->subject, job->chapters, job->nb_chapters, &job->partition) != GEN_OK) {
+            snprintf(job->error, sizeof(job->error), "memoire insuffisante");
+        }
+        if (job->error[0]) {
+            fprintf(stderr, "Travail %d ignore : %s\n", j + 1, job->error);
+            continue;
+        }
+        job->first_unit = nb_units;
+        job->nb_units = job->partition.count * job->count;
+        nb_units += job->nb_units;
+    }
+
+    BatchUnit* units = calloc(nb_units > 0 ? nb_units : 1, sizeof(BatchUnit));
+    if (!units) {
+        perror("Erreur d'allocation des epreuves");
+        for (int j = 0; j < nb_jobs; j++) {
+            if (!jobs[j].error[0]) snprintf(jobs[j].error, sizeof(jobs[j].error), "memoire insuffisante");
+            jobs[j].nb_units = 0;
+        }
+        nb_units = 0;
+    }
+
+    // Deux épreuves de même nom écriraient le même fichier dans la même seconde
+    StringMap names;
+    string_map_init(&names);
+    int u = 0;
+    for (int j = 0; j < nb_jobs && units; j++) {
+        BatchJob* job = &jobs[j];
+        if (job->error[0]) continue;
+        for (int c = 0; c < job->partition.count; c++) {
+            for (int v = 0; v < job->count; v++, u++) {
+                units[u].job = job;
+                units[u].pool = c;
+                units[u].variant = v;
+                units[u].seed = generator_mix_seed(job->seed ^ generator_mix_seed(((uint64_t)c << 32) | (uint64_t)v));
+                units[u].filename = unit_filename(job, c, v);
+                units[u].result = -1;
+                if (units[u].filename && string_map_put(&names, units[u].filename, u) == 0) {
+                    fprintf(stderr, "Travail %d : sortie '%s' deja produite par un autre travail\n",
+                            j + 1, units[u].filename);
+                    snprintf(units[u].error, sizeof(units[u].error), "sortie deja produite par un autre travail");
+                    units[u].job = NULL;
+                }
+            }
+        }
+    }
+    string_map_free(&names);
+
+    // Épreuves indépendantes : chaque thread prend la suivante dans la file
+    if (nb_threads <= 0) nb_threads = cpu_count();
+    if (nb_threads > nb_units) nb_threads = nb_units;
+    if (nb_threads < 1) nb_threads = 1;
+
+    BatchQueue queue;
+    queue.db = &db;
+    queue.stream_path = stream ? db_file : NULL;
+    queue.units = units;
+    queue.nb_units = nb_units;
+    queue.next = 0;
+    pthread_mutex_init(&queue.lock, NULL);
+    pthread_t* threads = malloc(sizeof(pthread_t) * nb_threads);
+    int started = 0;
+    for (int t = 0; t < nb_threads && threads; t++) {
+        if (pthread_create(&threads[t], NULL, batch_worker, &queue) != 0) break;
+        started++;
+    }
+    if (started == 0) batch_worker(&queue); // Pas de thread disponible : tout dans le thread principal
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&queue.lock);
+
+    int generated = 0, failed = 0;
+    for (int i = 0; i < queue.nb_units; i++) {
+        if (units[i].result == 0) generated++;
+        else failed++;
+    }
+    for (int j = 0; j < nb_jobs; j++) {
+        if (jobs[j].error[0]) failed++;
+    }
+
+    write_summary(summary, db_file, manifest_path, db.count, started ? started : 1, now_ms() - start,
+                  jobs, nb_jobs, units, generated, failed);
+    fflush(summary);
+
+    for (int i = 0; i < nb_units; i++) {
+        free(units[i].filename);
+    }
+    free(units);
+    for (int j = 0; j < nb_jobs; j++) {
+        free(jobs[j].chapters);
+        free_chapter_partition(&jobs[j].partition);
+    }
+    free(jobs);
+    json_free(manifest);
+    free_database(&db);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,30 @@
+// batch.h - Génération non interactive à partir d'un manifeste de travaux
+#ifndef BATCH_H
+#define BATCH_H
+
+// Nombre maximal de variantes par chapitre pour un travail (suffixe _v001 à _v999)
+#define BATCH_MAX_VARIANTS 999
+
+// Charge la base db_file une seule fois puis exécute chaque travail du manifeste JSON
+// sur nb_threads threads (0 : un par cœur). Le manifeste est un tableau de travaux, ou
+// un objet dont la clé "jobs" contient ce tableau :
+//
+//   { "jobs": [ { "subject": "Maths", "chapters": ["Algebre", "Analyse"],
+//                 "type": "mixte", "count": 3, "format": "PDF,HTML",
+//                 "seed": 42, "output": "maths_s1", "avoid_near_duplicates": true } ] }
+//
+// "subject" est obligatoire. Par défaut : tous les chapitres ensemble, type "qcm",
+// une épreuve, format "PDF", graine tirée de l'horloge (reportée dans le résumé),
+// sortie nommée d'après la matière. Chaque chapitre listé produit sa propre épreuve.
+//
+// Avec "stream": true au niveau du manifeste, la base n'est pas chargée : chaque épreuve
+// parcourt db_file en flux (generate_exam_stream), pour les bases trop grandes pour la mémoire.
+//
+// Les messages de progression passent sur la sortie d'erreur ; la sortie standard ne
+// reçoit qu'un résumé JSON, où chaque épreuve manquée porte le message du générateur
+// ("error"), et, si les compteurs matériels sont actifs (perf_counters.h), leurs cumuls par
+// phase ("perf_counters"). Retourne le code de sortie du programme : 0 si toutes les
+// épreuves ont été produites, 1 si au moins une a échoué, 2 si le manifeste est illisible.
+int run_batch_jobs(const char* db_file, const char* manifest_path, int nb_threads);
+
+#endif
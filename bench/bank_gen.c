@@ -0,0 +1,150 @@
+// bank_gen.c - Génère une base de questions synthétique pour les mesures de montée en charge
+//
+// Usage : bank_gen <nombre de questions> <fichier> [graine]
+//
+// Les proportions imitent questions.txt : quelques matières très fournies et une longue
+// traîne (loi de Zipf), 6 à 14 chapitres par matière, 85 % de QCM à 2-5 choix, des
+// énoncés de 4 à 14 mots (exercices : 12 à 40 mots). Même graine, même fichier.
+// 10 millions de questions occupent environ 1,5 Go.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static const char* SUBJECTS[] = {
+    "Algorithmes et Structures de Données", "Programmation", "Réseaux Informatiques",
+    "Bases de Données", "Génie Logiciel", "Architecture des Ordinateurs",
+    "Sécurité Informatique", "Intelligence Artificielle", "Systèmes d'Exploitation",
+    "Développement Web", "Développement Mobile", "Cloud Computing",
+    "Big Data et Analytics", "Systèmes Embarqués"
+};
+#define NB_SUBJECTS (int)(sizeof(SUBJECTS) / sizeof(SUBJECTS[0]))
+
+static const char* CHAPTER_WORDS[] = {
+    "Bases", "Pointeurs", "Tableaux", "Fonctions", "Fichiers", "Structures", "Arbres", "Graphes",
+    "Tri", "Complexité", "Piles", "Files", "Listes", "Hachage", "Transactions", "Normalisation",
+    "SQL", "Index", "Routage", "TCP", "Modèle OSI", "Processus", "Mémoire", "Ordonnancement",
+    "Cache", "Pipeline", "Tests", "UML", "Agilité", "Cryptographie", "Réseaux de neurones",
+    "Apprentissage", "Sécurité", "Conteneurs", "Virtualisation", "API REST", "Capteurs", "Temps réel"
+};
+#define NB_CHAPTER_WORDS (int)(sizeof(CHAPTER_WORDS) / sizeof(CHAPTER_WORDS[0]))
+
+static const char* WORDS[] = {
+    "quelle", "est", "la", "le", "les", "un", "une", "des", "de", "du", "en", "pour", "dans", "avec",
+    "complexité", "fonction", "pointeur", "tableau", "mémoire", "allocation", "structure", "liste",
+    "chaînée", "arbre", "binaire", "recherche", "tri", "rapide", "fusion", "graphe", "parcours",
+    "largeur", "profondeur", "pile", "file", "table", "hachage", "collision", "requête", "jointure",
+    "clé", "primaire", "étrangère", "index", "transaction", "verrou", "protocole", "paquet", "routeur",
+    "adresse", "couche", "transport", "session", "processus", "thread", "ordonnanceur", "interruption",
+    "registre", "cache", "instruction", "pipeline", "compilateur", "variable", "boucle", "récursivité",
+    "objet", "classe", "héritage", "interface", "module", "test", "unitaire", "intégration", "exigence",
+    "chiffrement", "signature", "certificat", "attaque", "réseau", "neurone", "apprentissage",
+    "gradient", "modèle", "donnée", "serveur", "client", "conteneur", "service", "capteur", "signal",
+    "valeur", "retour", "paramètre", "programme", "système", "fichier", "entier", "chaîne", "octet",
+    "expliquez", "décrivez", "comparez", "implémentez", "calculez", "justifiez", "donnez", "exemple",
+    "différence", "avantage", "inconvénient", "rôle", "principe", "utilisation", "algorithme", "coût"
+};
+#define NB_WORDS (int)(sizeof(WORDS) / sizeof(WORDS[0]))
+
+static uint64_t rng_state;
+
+static uint64_t next_random(void) {
+    uint64_t z = (rng_state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+static int uniform(int low, int high) {
+    return low + (int)(next_random() % (uint64_t)(high - low + 1));
+}
+
+// Tirage selon la loi de Zipf (poids 1/(k+1)) parmi n valeurs, par table cumulée
+static int zipf(const double* cumulative, int n) {
+    double x = (next_random() >> 11) * (1.0 / 9007199254740992.0) * cumulative[n - 1];
+    int k = 0;
+    while (k < n - 1 && cumulative[k] < x) k++;
+    return k;
+}
+
+static void zipf_table(double* cumulative, int n) {
+    double total = 0;
+    for (int k = 0; k < n; k++) {
+        total += 1.0 / (k + 1);
+        cumulative[k] = total;
+    }
+}
+
+// Ajoute nb mots au texte (le premier avec une majuscule si c'est une lettre ASCII)
+static int append_words(char* out, size_t size, int nb, const char* end) {
+    size_t len = 0;
+    for (int i = 0; i < nb && len < size; i++) {
+        const char* word = WORDS[uniform(0, NB_WORDS - 1)];
+        int n = snprintf(out + len, size - len, "%s%s", i ? " " : "", word);
+        if (i == 0 && out[len] >= 'a' && out[len] <= 'z') out[len] -= 'a' - 'A';
+        len += (size_t)n;
+    }
+    if (len < size) len += (size_t)snprintf(out + len, size - len, "%s", end);
+    return (int)(len < size ? len : size - 1);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage : %s <nombre de questions> <fichier> [graine]\n", argv[0]);
+        return 2;
+    }
+    long long count = atoll(argv[1]);
+    rng_state = (argc > 3) ? strtoull(argv[3], NULL, 10) : 42;
+    FILE* f = fopen(argv[2], "w");
+    if (!f || count < 0) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    // Chapitres de chaque matière : tirés une fois, puis choisis selon Zipf
+    double subject_weights[NB_SUBJECTS];
+    zipf_table(subject_weights, NB_SUBJECTS);
+    int nb_chapters[NB_SUBJECTS];
+    int chapters[NB_SUBJECTS][14];
+    double chapter_weights[14];
+    zipf_table(chapter_weights, 14);
+    for (int s = 0; s < NB_SUBJECTS; s++) {
+        // Chapitres distincts : début d'un mélange de Fisher-Yates de la liste
+        int order[NB_CHAPTER_WORDS];
+        for (int k = 0; k < NB_CHAPTER_WORDS; k++) order[k] = k;
+        nb_chapters[s] = uniform(6, 14);
+        for (int c = 0; c < nb_chapters[s]; c++) {
+            int k = uniform(c, NB_CHAPTER_WORDS - 1);
+            chapters[s][c] = order[k];
+            order[k] = order[c];
+        }
+    }
+
+    char enonce[400], choices[400];
+    for (long long i = 0; i < count; i++) {
+        int s = zipf(subject_weights, NB_SUBJECTS);
+        int c = zipf(chapter_weights, nb_chapters[s]);
+        int is_qcm = uniform(1, 100) <= 85;
+
+        if (is_qcm) {
+            append_words(enonce, sizeof(enonce), uniform(4, 14), " ?");
+            int nb_choices = uniform(1, 100) <= 5 ? 2 : uniform(3, 5);
+            size_t len = 0;
+            for (int k = 0; k < nb_choices; k++) {
+                if (k) choices[len++] = '|';
+                len += (size_t)append_words(choices + len, sizeof(choices) - len, uniform(1, 5), "");
+            }
+            fprintf(f, "%s;%s;QCM;%s;%d;%s;1\n", SUBJECTS[s], CHAPTER_WORDS[chapters[s][c]],
+                    enonce, uniform(1, nb_choices), choices);
+        } else {
+            append_words(enonce, sizeof(enonce), uniform(12, 40), ".");
+            fprintf(f, "%s;%s;Exercice;%s;-1;-;%d\n", SUBJECTS[s], CHAPTER_WORDS[chapters[s][c]],
+                    enonce, 5 * uniform(1, 4));
+        }
+    }
+    if (fclose(f) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    return 0;
+}
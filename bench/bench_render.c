@@ -0,0 +1,244 @@
+// bench_render.c - Mesure la coupure des lignes et la pagination du rendu PDF
+//
+// Usage : bench_render [--baseline ancien.json] [--threshold pourcentage] [--min-time secondes]
+//
+// Chaque cas est dessiné sur une surface d'enregistrement cairo (aucun PDF n'est produit) :
+//   wrap/<cas>      pdf_draw_wrapped_text() seul, sur l'énoncé et les choix du cas ;
+//   document/<cas>  une épreuve complète (en-tête, 20 QCM, un exercice) avec ses sauts de page.
+// Le résultat JSON (sortie standard) donne pour chaque mesure (meilleure de trois séries d'au
+// moins --min-time secondes, 0,2 par défaut) le temps par caractère dessiné,
+// les lignes et les pages par seconde. Avec --baseline, chaque mesure est comparée à celle du
+// même nom dans un résultat précédent ; le programme retourne 1 si l'une d'elles a ralenti de
+// plus de --threshold % (10 par défaut) en temps par caractère.
+//
+//   ./bench_render > avant.json
+//   (modification de la mise en page)
+//   ./bench_render --baseline avant.json > apres.json
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "../renderer_pdf.h"
+#include "../database.h"
+#include "../json.h"
+#include "../trace.h"
+
+#define BENCH_QCM_PER_DOCUMENT 20
+#define BENCH_ROUNDS 3
+
+typedef struct {
+    const char* name;
+    Question question;      // QCM dessiné par le cas
+    Question exercise;
+} RenderCase;
+
+typedef struct {
+    char name[64];
+    long iterations;
+    double seconds;
+    PdfLayoutStats stats;
+} RenderResult;
+
+// Répète words jusqu'à atteindre length octets (coupé sur un caractère entier)
+static char* repeat_text(const char* words, size_t length) {
+    char* text = malloc(length + 1);
+    if (!text) return NULL;
+    size_t n = strlen(words), len = 0;
+    while (len + n <= length) {
+        memcpy(text + len, words, n);
+        len += n;
+    }
+    text[len] = 0;
+    return text;
+}
+
+static int make_case(RenderCase* c, const char* name, const char* enonce, int nb_choices, const char* choice) {
+    const char* choices[QUESTION_MAX_CHOICES];
+    for (int i = 0; i < nb_choices; i++) choices[i] = choice;
+    c->name = name;
+    return question_init(&c->question, "Mesures", name, "QCM", enonce, choices, nb_choices, 0, 1) == GEN_OK &&
+           question_init(&c->exercise, "Mesures", name, "Exercice", enonce, NULL, 0, -1, 10) == GEN_OK;
+}
+
+static int make_cases(RenderCase* cases) {
+    char* typical = strdup("Quelle est la complexite moyenne du tri rapide sur un tableau de n elements ?");
+    char* long_statement = repeat_text("On considere une table de hachage a adressage ouvert dont le taux de "
+                                       "remplissage depasse les trois quarts ; decrivez le cout des insertions. ", 3000);
+    // Jeton plus large que la ligne (URL, empreinte) : la coupure ne trouve aucun espace
+    char* long_token = repeat_text("0123456789abcdef", 600);
+    char* heavy_utf8 = repeat_text("Élève à l'école : « déjà vu », ŒUVRE, αβγδ λόγος, 日本語の文章, "
+                                   "Ünïcödé ñ ç ø ß — ", 1200);
+    int ok = typical && long_statement && long_token && heavy_utf8 &&
+             make_case(&cases[0], "typical", typical, 4, "Une complexite en O(n log n)") &&
+             make_case(&cases[1], "long_statement", long_statement, 4, "Une complexite en O(n log n)") &&
+             make_case(&cases[2], "long_token", long_token, 4, long_token) &&
+             make_case(&cases[3], "many_choices", typical, 26,
+                       "Une proposition assez longue pour occuper une bonne partie de la ligne") &&
+             make_case(&cases[4], "heavy_utf8", heavy_utf8, 4, "Réponse « α » — 日本語");
+    // Les questions ont copié leurs textes
+    free(typical);
+    free(long_statement);
+    free(long_token);
+    free(heavy_utf8);
+    return ok ? 5 : 0;
+}
+
+static cairo_surface_t* recording_surface(void) {
+    cairo_rectangle_t extents = { 0, 0, PAGE_WIDTH, PAGE_HEIGHT };
+    return cairo_recording_surface_create(CAIRO_CONTENT_COLOR_ALPHA, &extents);
+}
+
+// Une passe de coupure : l'énoncé puis chaque choix, comme pdf_qcm()
+static void wrap_once(const RenderCase* c, PdfLayoutStats* stats) {
+    cairo_surface_t* surface = recording_surface();
+    cairo_t* cr = cairo_create(surface);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 11);
+    pdf_draw_wrapped_text(cr, question_enonce(&c->question), 55, 50, PAGE_WIDTH - 110, 16, stats);
+    for (int j = 0; j < c->question.nbChoix; j++) {
+        pdf_draw_wrapped_text(cr, question_choice(&c->question, j), 65, 50, PAGE_WIDTH - 120, 16, stats);
+    }
+    cairo_destroy(cr);
+    cairo_surface_destroy(surface);
+}
+
+static void document_once(const RenderCase* c, PdfLayoutStats* stats) {
+    ExamInfo info = {0};
+    info.matiere = "Mesures";
+    info.chapitre = c->name;
+    info.exam_type = EXAM_TYPE_MIXED;
+    info.nbQCM = BENCH_QCM_PER_DOCUMENT;
+    info.nbExercice = 1;
+    info.points_per_qcm = 0.5;
+    info.points_per_exercice = 10;
+
+    cairo_surface_t* surface = recording_surface();
+    void* state = pdf_begin_on_surface(surface, &info, stats);
+    int ok = state && RENDERER_PDF.header(state) == 0;
+    for (int i = 0; ok && i < BENCH_QCM_PER_DOCUMENT; i++) {
+        ok = RENDERER_PDF.qcm(state, i + 1, &c->question) == 0;
+    }
+    if (ok) ok = RENDERER_PDF.exercise(state, 1, &c->exercise) == 0;
+    if (state) RENDERER_PDF.end_document(state, ok);
+    cairo_surface_destroy(surface);
+}
+
+static double ns_per_glyph(const RenderResult* r) {
+    return r->stats.glyphs ? r->seconds * 1e9 / r->stats.glyphs : 0;
+}
+
+// Répète once() jusqu'à dépasser min_time secondes, en BENCH_ROUNDS séries dont on garde
+// la plus rapide (moins sensible aux interruptions de la machine)
+static void measure(RenderResult* r, const char* kind, const RenderCase* c,
+                    void (*once)(const RenderCase*, PdfLayoutStats*), double min_time) {
+    once(c, NULL); // Échauffement : polices et caches de glyphes de cairo
+    for (int round = 0; round < BENCH_ROUNDS; round++) {
+        RenderResult current = {0};
+        snprintf(current.name, sizeof(current.name), "%s/%s", kind, c->name);
+        uint64_t start = trace_now_ns();
+        do {
+            once(c, &current.stats);
+            current.iterations++;
+            current.seconds = (trace_now_ns() - start) / 1e9;
+        } while (current.seconds < min_time);
+        if (round == 0 || ns_per_glyph(&current) < ns_per_glyph(r)) *r = current;
+    }
+}
+
+static JsonValue* read_baseline(const char* path) {
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        perror(path);
+        return NULL;
+    }
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char* text = malloc(size + 1);
+    JsonValue* value = NULL;
+    if (text && fread(text, 1, size, f) == (size_t)size) {
+        text[size] = 0;
+        char error[256];
+        value = json_parse(text, error, sizeof(error));
+        if (!value) fprintf(stderr, "%s : %s\n", path, error);
+    }
+    free(text);
+    fclose(f);
+    return value;
+}
+
+// Compare aux mesures de même nom ; retourne le nombre de ralentissements au-delà du seuil
+static int compare_baseline(const JsonValue* baseline, const RenderResult* results, int count, double threshold) {
+    const JsonValue* previous = json_get(baseline, "results");
+    int regressions = 0;
+    fprintf(stderr, "%-28s %12s %12s %9s\n", "mesure", "avant ns/car", "apres ns/car", "ecart");
+    for (int i = 0; i < count; i++) {
+        double before = 0;
+        for (int k = 0; previous && previous->type == JSON_ARRAY && k < previous->count; k++) {
+            const char* name = json_get_string(previous->items[k], "name", "");
+            if (strcmp(name, results[i].name) == 0) before = json_get_number(previous->items[k], "ns_per_glyph", 0);
+        }
+        double after = ns_per_glyph(&results[i]);
+        if (before <= 0) {
+            fprintf(stderr, "%-28s %12s %12.1f %9s\n", results[i].name, "-", after, "nouveau");
+            continue;
+        }
+        double delta = (after - before) * 100 / before;
+        int slower = delta > threshold;
+        regressions += slower;
+        fprintf(stderr, "%-28s %12.1f %12.1f %+8.1f%%%s\n", results[i].name, before, after, delta,
+                slower ? "  RALENTI" : "");
+    }
+    return regressions;
+}
+
+int main(int argc, char** argv) {
+    const char* baseline_path = NULL;
+    double threshold = 10, min_time = 0.2;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time = atof(argv[++i]);
+        else {
+            fprintf(stderr, "Usage : %s [--baseline ancien.json] [--threshold pourcentage] [--min-time secondes]\n",
+                    argv[0]);
+            return 2;
+        }
+    }
+
+    RenderCase cases[5];
+    int nb_cases = make_cases(cases);
+    if (nb_cases == 0) {
+        fprintf(stderr, "Memoire insuffisante\n");
+        return 1;
+    }
+
+    RenderResult results[2 * 5];
+    int nb_results = 0;
+    for (int c = 0; c < nb_cases; c++) {
+        measure(&results[nb_results++], "wrap", &cases[c], wrap_once, min_time);
+        measure(&results[nb_results++], "document", &cases[c], document_once, min_time);
+    }
+
+    printf("{\"results\": [");
+    for (int i = 0; i < nb_results; i++) {
+        const RenderResult* r = &results[i];
+        printf("%s\n    {\"name\": \"%s\", \"iterations\": %ld, \"seconds\": %.3f, \"glyphs\": %ld, \"lines\": %ld, "
+               "\"pages\": %d, \"ns_per_glyph\": %.2f, \"lines_per_sec\": %.0f, \"pages_per_sec\": %.1f}",
+               i ? "," : "", r->name, r->iterations, r->seconds, r->stats.glyphs, r->stats.lines, r->stats.pages,
+               ns_per_glyph(r), r->stats.lines / r->seconds, r->stats.pages / r->seconds);
+    }
+    printf("\n]}\n");
+
+    int status = 0;
+    if (baseline_path) {
+        JsonValue* baseline = read_baseline(baseline_path);
+        if (!baseline) return 2;
+        status = compare_baseline(baseline, results, nb_results, threshold) > 0 ? 1 : 0;
+        json_free(baseline);
+    }
+    for (int c = 0; c < nb_cases; c++) {
+        free_question_content(&cases[c].question);
+        free_question_content(&cases[c].exercise);
+    }
+    return status;
+}
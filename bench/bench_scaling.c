@@ -0,0 +1,252 @@
+// bench_scaling.c - Mesure les opérations de la bibliothèque sur une base de taille donnée
+//
+// Usage : bench_scaling [--perf] <base> [fichier JSON]
+//
+// Pour chaque opération : durée totale, durée par appel, nombre d'allocations et pic de
+// mémoire résidente du processus (ru_maxrss, en Ko, depuis le lancement). Le résultat est
+// un objet JSON, écrit sur la sortie standard ou dans le fichier donné :
+//
+//   { "bank": "b100k.txt", "questions": 100000,
+//     "results": [ { "name": "load_database", "iterations": 1, "wall_ms": 412.5,
+//                    "per_op_us": 412500.0, "allocations": 700012, "peak_rss_kb": 98304 } ] }
+//
+// Série complète (le fichier de 10 millions de questions occupe environ 1,5 Go) :
+//
+//   for n in 10000 100000 1000000 10000000; do
+//       ./bank_gen $n bank_$n.txt && ./bench_scaling bank_$n.txt bench_$n.json
+//   done
+//
+// Avec --perf (Linux), chaque résultat porte aussi les compteurs matériels des phases mesurées
+// pendant l'opération, avec leur IPC et leurs défauts par mille instructions :
+//
+//     "phases": [ { "phase": "load_database", "calls": 1, "cycles": 1.2e9, "instructions": 2.9e9,
+//                   "cache_misses": 4.1e6, "branch_misses": 8.5e6, "ipc": 2.417, ... } ]
+//
+// Les allocations sont comptées en remplaçant malloc/calloc/realloc (glibc uniquement,
+// -1 ailleurs) : ne pas compiler ce programme avec un sanitizer.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include "../libgenerateur.h"
+
+#ifdef __GLIBC__
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t nmemb, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void __libc_free(void* ptr);
+
+static atomic_long nb_allocations;
+
+void* malloc(size_t size) {
+    atomic_fetch_add_explicit(&nb_allocations, 1, memory_order_relaxed);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t nmemb, size_t size) {
+    atomic_fetch_add_explicit(&nb_allocations, 1, memory_order_relaxed);
+    return __libc_calloc(nmemb, size);
+}
+
+void* realloc(void* ptr, size_t size) {
+    atomic_fetch_add_explicit(&nb_allocations, 1, memory_order_relaxed);
+    return __libc_realloc(ptr, size);
+}
+
+void free(void* ptr) {
+    __libc_free(ptr);
+}
+
+static long allocation_count(void) {
+    return atomic_load(&nb_allocations);
+}
+#else
+static long allocation_count(void) {
+    return -1;
+}
+#endif
+
+// Une mesure en cours : état relevé au début de l'opération
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+    long start_allocations;
+} Measure;
+
+static FILE* out;
+static int nb_results;
+
+static Measure measure_begin(const char* name) {
+    perf_counters_reset();
+    Measure m = { name, trace_now_ns(), allocation_count() };
+    return m;
+}
+
+static void measure_end(const Measure* m, int iterations) {
+    uint64_t elapsed = trace_now_ns() - m->start_ns;
+    long allocations = allocation_count();
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+
+    fprintf(out, "%s\n    {\"name\": \"%s\", \"iterations\": %d, \"wall_ms\": %.3f, \"per_op_us\": %.3f, "
+                 "\"allocations\": %ld, \"peak_rss_kb\": %ld",
+            nb_results ? "," : "", m->name, iterations, elapsed / 1e6, elapsed / 1e3 / iterations,
+            allocations < 0 ? -1 : allocations - m->start_allocations, usage.ru_maxrss);
+    if (perf_counters_enabled()) {
+        fprintf(out, ",\n     \"phases\": ");
+        perf_counters_write_json(out);
+    }
+    fprintf(out, "}");
+    nb_results++;
+}
+
+// Génère des épreuves en mémoire, avec des graines fixes pour comparer deux versions
+static void bench_generate(const Database* db, const char* name, const char* matiere,
+                           const Renderer* renderer, int iterations) {
+    Measure m = measure_begin(name);
+    int done = 0;
+    for (int i = 0; i < iterations; i++) {
+        OutputSink sink;
+        output_sink_init_memory(&sink);
+        ExamRequest request = {0};
+        request.matiere = matiere;
+        request.exam_type = EXAM_TYPE_MIXED;
+        request.seeded = 1;
+        request.seed = generator_mix_seed((uint64_t)i);
+        ExamOutput output = { renderer, &sink };
+        int status = generate_exam_outputs(db, &request, &output, 1);
+        output_sink_free(&sink);
+        if (status != GEN_OK) {
+            fprintf(stderr, "%s : %s\n", name, gen_status_message(status));
+            break;
+        }
+        done++;
+    }
+    if (done > 0) measure_end(&m, done);
+}
+
+// Une question analysée comme si elle venait du fichier (chaînes possédées)
+static int sample_question(Question* q, const char* matiere, int i) {
+    char line[512];
+    snprintf(line, sizeof(line), "%s;Mesures;QCM;Question de mesure numero %d ?;2;Oui|Non|Peut-etre;1\n",
+             matiere, i);
+    return parse_question_line(line, DATABASE_FORMAT_ESCAPED, q) > 0 ? GEN_OK : GEN_ERROR_NO_MEMORY;
+}
+
+// Ajouts en fin de base, remplacements et suppressions au milieu (décalage du tableau)
+static void bench_edits(Database* db, const char* matiere, int iterations) {
+    Measure m = measure_begin("add_question_to_db");
+    for (int i = 0; i < iterations; i++) {
+        Question q;
+        if (sample_question(&q, matiere, i) != GEN_OK) return;
+        if (add_question_to_db(db, q) != GEN_OK) {
+            free_question_content(&q);
+            return;
+        }
+    }
+    measure_end(&m, iterations);
+
+    m = measure_begin("update_question_in_db");
+    for (int i = 0; i < iterations; i++) {
+        Question q;
+        if (sample_question(&q, matiere, -i) != GEN_OK) return;
+        if (update_question_in_db(db, (int)((long long)db->count * i / iterations), q) != GEN_OK) return;
+    }
+    measure_end(&m, iterations);
+
+    m = measure_begin("delete_question_from_db");
+    for (int i = 0; i < iterations && db->count > 0; i++) {
+        if (delete_question_from_db(db, db->count / 2) != GEN_OK) return;
+    }
+    measure_end(&m, iterations);
+}
+
+int main(int argc, char** argv) {
+    const char* program = argv[0];
+    if (argc > 1 && strcmp(argv[1], "--perf") == 0) {
+        if (perf_counters_start() != GEN_OK) {
+            fprintf(stderr, "Compteurs materiels indisponibles (perf_event_open)\n");
+            return 1;
+        }
+        argc--;
+        argv++;
+    }
+    if (argc < 2) {
+        fprintf(stderr, "Usage : %s [--perf] <base> [fichier JSON]\n", program);
+        return 2;
+    }
+    out = stdout;
+    if (argc > 2 && !(out = fopen(argv[2], "w"))) {
+        perror(argv[2]);
+        return 1;
+    }
+
+    Database db = {0};
+    Measure m = measure_begin("load_database");
+    if (load_database(&db, argv[1]) != GEN_OK) {
+        fprintf(stderr, "Impossible de charger %s\n", argv[1]);
+        return 1;
+    }
+    fprintf(out, "{\"bank\": \"%s\", \"questions\": %d, \"results\": [", argv[1], db.count);
+    measure_end(&m, 1);
+
+    int nb_subjects = 0;
+    m = measure_begin("get_unique_subjects");
+    for (int i = 0; i < 10; i++) {
+        free_string_array(get_unique_subjects(&db, &nb_subjects), nb_subjects);
+    }
+    measure_end(&m, 10);
+
+    // La matière la plus fournie sert aux mesures suivantes
+    char** subjects = get_unique_subjects(&db, &nb_subjects);
+    if (!subjects) {
+        fprintf(stderr, "Base vide : %s\n", argv[1]);
+        return 1;
+    }
+    int best = 0, best_count = -1;
+    for (int s = 0; s < nb_subjects; s++) {
+        int n = 0;
+        for (int i = 0; i < db.count; i++) {
+            if (strcmp(question_matiere(&db, &db.questions[i]), subjects[s]) == 0) n++;
+        }
+        if (n > best_count) {
+            best = s;
+            best_count = n;
+        }
+    }
+    const char* matiere = subjects[best];
+
+    int nb_chapters = 0;
+    m = measure_begin("get_unique_chapters");
+    for (int i = 0; i < 10; i++) {
+        free_string_array(get_unique_chapters(&db, matiere, &nb_chapters), nb_chapters);
+    }
+    measure_end(&m, 10);
+
+    bench_generate(&db, "generate_exam_txt", matiere, &RENDERER_TXT, 20);
+    bench_generate(&db, "generate_exam_pdf", matiere, &RENDERER_PDF, 5);
+
+    char save_path[64];
+    snprintf(save_path, sizeof(save_path), "bench_save_%ld.txt", (long)getpid());
+    m = measure_begin("save_database");
+    int status = save_database(&db, save_path);
+    if (status == GEN_OK) measure_end(&m, 1);
+    else fprintf(stderr, "save_database : %s\n", gen_status_message(status));
+    remove(save_path);
+
+    bench_edits(&db, matiere, 1000);
+
+    free_string_array(subjects, nb_subjects);
+
+    m = measure_begin("free_database");
+    free_database(&db);
+    measure_end(&m, 1);
+    fprintf(out, "\n]}\n");
+    if (out != stdout && fclose(out) != 0) {
+        perror(argv[2]);
+        return 1;
+    }
+    return 0;
+}
@@ -4,155 +4,557 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/stat.h>
 #include "database.h"
+#include "bank_shards.h"
+#include "label_table.h"
+#include "storage.h"
+#include "minhash.h"
+#include "mem_track.h"
+#include "perf_counters.h"
+#include "trace.h"
 
 // --- Fonctions Privées ---
 
-// Fonction pour dupliquer une chaîne en utilisant malloc + strcpy (standard C)
+// Les chaînes de la base sont comptées dans MEM_LOADER (mem_track.h)
 static char* my_strdup(const char* s) {
-    if (s == NULL) return NULL;
-    size_t len = strlen(s) + 1;
-    char* new_str = malloc(len);
-    if (new_str == NULL) return NULL;
-    memcpy(new_str, s, len);
-    return new_str;
+    return mem_strdup(MEM_LOADER, s);
 }
 
-static void free_question_content(Question* q) {
-    free(q->matiere);
-    free(q->chapitre);
-    free(q->type);
-    free(q->enonce);
-    for (int i = 0; i < q->nbChoix; i++) {
-        free(q->choix[i]);
+// Copie str (et son '\0') à la position *used du bloc ; retourne la copie
+static char* pack_string(char* block, size_t* used, const char* str, size_t len) {
+    char* copy = block + *used;
+    memcpy(copy, str, len + 1);
+    *used += len + 1;
+    return copy;
+}
+
+// Indices des libellés dans labels (ajoutés s'ils sont nouveaux), ou QUESTION_LABEL_INLINE
+// pour tous sans table et pour ceux qui n'y entrent plus (table pleine) ; *size reçoit la
+// place des libellés à ranger dans le bloc
+static int intern_labels(LabelTable* labels, const char* const texts[QUESTION_LABEL_COUNT],
+                         uint16_t ids[QUESTION_LABEL_COUNT], size_t* size) {
+    *size = 0;
+    for (int i = 0; i < QUESTION_LABEL_COUNT; i++) {
+        int id = labels ? label_table_intern(labels, texts[i]) : GEN_ERROR_INVALID_ARGUMENT;
+        if (id == GEN_ERROR_INVALID_ARGUMENT) {
+            ids[i] = QUESTION_LABEL_INLINE;
+            *size += strlen(texts[i]) + 1;
+            continue;
+        }
+        if (id < 0) return id;
+        ids[i] = (uint16_t)id;
+    }
+    return GEN_OK;
+}
+
+// Range à la fin du bloc les libellés laissés dans le bloc par intern_labels
+static void pack_labels(Question* q, char* block, size_t used, const char* const texts[QUESTION_LABEL_COUNT]) {
+    for (int i = 0; i < QUESTION_LABEL_COUNT; i++) {
+        if (q->labels[i] == QUESTION_LABEL_INLINE) pack_string(block, &used, texts[i], strlen(texts[i]));
+    }
+}
+
+// Construit le bloc de q dans arena, ou avec mem_alloc pour une question isolée (arena NULL) ;
+// les libellés vont dans labels, ou dans le bloc sans table
+static int pack_question(Question* q, Arena* arena, LabelTable* labels, const char* matiere, const char* chapitre,
+                         const char* type, const char* enonce, const char* const* choix, int nbChoix,
+                         int bonneReponse, int points) {
+    memset(q, 0, sizeof(*q));
+    if (!matiere || !chapitre || !type || !enonce || nbChoix < 0 || nbChoix > QUESTION_MAX_CHOICES) {
+        return GEN_ERROR_INVALID_ARGUMENT;
+    }
+
+    const char* texts[QUESTION_LABEL_COUNT] = { matiere, chapitre, type };
+    size_t label_size;
+    int status = intern_labels(labels, texts, q->labels, &label_size);
+    if (status != GEN_OK) return status;
+    size_t enonce_length = strlen(enonce);
+    size_t size = nbChoix * sizeof(QuestionChoice) + enonce_length + 1 + label_size;
+    for (int i = 0; i < nbChoix; i++) size += strlen(choix[i]) + 1;
+    if (size > UINT32_MAX) return GEN_ERROR_INVALID_ARGUMENT;
+
+    char* block = arena ? arena_alloc(arena, size) : mem_alloc(MEM_LOADER, size);
+    if (!block) return GEN_ERROR_NO_MEMORY;
+    q->choix = (QuestionChoice*)block;
+    size_t used = nbChoix * sizeof(QuestionChoice);
+    pack_string(block, &used, enonce, enonce_length); // À l'adresse de question_enonce
+    // Les choix se suivent dans le bloc : le rendu les parcourt sans sauter en mémoire
+    for (int i = 0; i < nbChoix; i++) {
+        size_t len = strlen(choix[i]);
+        q->choix[i].offset = (uint32_t)used;
+        q->choix[i].length = (uint32_t)len;
+        pack_string(block, &used, choix[i], len);
+    }
+    pack_labels(q, block, used, texts);
+    q->nbChoix = (uint8_t)nbChoix;
+    q->bonneReponse = (int8_t)((bonneReponse >= -1 && bonneReponse < QUESTION_MAX_CHOICES) ? bonneReponse : -1);
+    q->points = (int16_t)((points > INT16_MAX) ? INT16_MAX : (points < INT16_MIN) ? INT16_MIN : points);
+    return GEN_OK;
+}
+
+int question_init(Question* q, const char* matiere, const char* chapitre, const char* type,
+                  const char* enonce, const char* const* choix, int nbChoix, int bonneReponse, int points) {
+    return pack_question(q, NULL, NULL, matiere, chapitre, type, enonce, choix, nbChoix, bonneReponse, points);
+}
+
+int question_init_arena(Question* q, Arena* arena, LabelTable* labels, const char* matiere, const char* chapitre,
+                        const char* type, const char* enonce, const char* const* choix, int nbChoix,
+                        int bonneReponse, int points) {
+    return pack_question(q, arena, labels, matiere, chapitre, type, enonce, choix, nbChoix, bonneReponse, points);
+}
+
+void free_question_content(Question* q) {
+    mem_free(MEM_LOADER, q->choix);
+}
+
+// Taille de l'énoncé et des choix dans le bloc : ils se terminent avec le dernier choix, ou
+// avec l'énoncé
+static size_t question_text_size(const Question* q) {
+    if (q->nbChoix > 0) {
+        const QuestionChoice* last = &q->choix[q->nbChoix - 1];
+        return last->offset + last->length + 1;
+    }
+    return q->nbChoix * sizeof(QuestionChoice) + strlen(question_enonce(q)) + 1;
+}
+
+// Taille du bloc d'une question, libellés rangés dans le bloc compris
+static size_t question_block_size(const Question* q) {
+    size_t size = question_text_size(q);
+    for (int i = 0; i < QUESTION_LABEL_COUNT; i++) {
+        if (q->labels[i] == QUESTION_LABEL_INLINE) size += strlen((const char*)q->choix + size) + 1;
+    }
+    return size;
+}
+
+const char* question_label(const LabelTable* labels, const Question* q, QuestionLabel which) {
+    if (q->labels[which] != QUESTION_LABEL_INLINE) return label_table_get(labels, q->labels[which]);
+    const char* text = (const char*)q->choix + question_text_size(q);
+    for (int i = 0; i < (int)which; i++) {
+        if (q->labels[i] == QUESTION_LABEL_INLINE) text += strlen(text) + 1;
+    }
+    return text;
+}
+
+int question_copy(Question* out, const Question* q, const LabelTable* from, Arena* arena, LabelTable* labels) {
+    const char* texts[QUESTION_LABEL_COUNT];
+    for (int i = 0; i < QUESTION_LABEL_COUNT; i++) texts[i] = question_label(from, q, (QuestionLabel)i);
+    Question copy = *q;
+    size_t label_size;
+    int status = intern_labels(labels, texts, copy.labels, &label_size);
+    if (status != GEN_OK) return status;
+
+    // L'énoncé et les choix sont recopiés tels quels : leurs positions dans le bloc ne changent pas
+    size_t text_size = question_text_size(q);
+    char* block = arena ? arena_alloc(arena, text_size + label_size) : mem_alloc(MEM_LOADER, text_size + label_size);
+    if (!block) return GEN_ERROR_NO_MEMORY;
+    memcpy(block, q->choix, text_size);
+    copy.choix = (QuestionChoice*)block;
+    pack_labels(&copy, block, text_size, texts);
+    *out = copy;
+    return GEN_OK;
+}
+
+LabelTable* database_labels(Database* db) {
+    if (!db->labels && (db->labels = mem_alloc(MEM_LOADER, sizeof(LabelTable)))) label_table_init(db->labels);
+    return db->labels;
+}
+
+// Range dans l'arène et la table de libellés de db une copie de la question isolée q
+// (l'original reste à libérer)
+static int copy_to_database(Database* db, Question* q) {
+    LabelTable* labels = database_labels(db);
+    if (!labels) return GEN_ERROR_NO_MEMORY;
+    return question_copy(q, q, NULL, &db->arena, labels);
+}
+
+void database_free_question_content(Database* db, Question* q) {
+    // Un bloc absent de l'arène appartient à une arène remplacée par un compactage,
+    // qui le rendra avec toutes ses régions
+    if (q->choix && arena_owns(&db->arena, q->choix)) {
+        arena_free(&db->arena, q->choix, question_block_size(q));
+    }
+}
+
+static void notify_listeners(const Database* db, DatabaseChange change, int index, int count,
+                             const Question* old_question) {
+    for (int i = 0; i < db->nbListeners; i++) {
+        db->listeners[i].func(db, change, index, count, old_question, db->listeners[i].user_data);
     }
-    free(q->choix);
 }
 
 
 // --- Fonctions Publiques ---
 
-int load_database(Database* db, const char* filename) {
-    FILE* f = fopen(filename, "r");
-    if (!f) {
-        printf("AVERTISSEMENT: Fichier '%s' non trouve. Une base de donnees vide sera utilisee.\n", filename);
-        db->questions = NULL;
-        db->count = 0;
-        db->capacity = 0;
-        return 1;
-    }
-
-    char line[1024];
-    while (fgets(line, sizeof(line), f)) {
-        line[strcspn(line, "\r\n")] = 0; // Gère \n et \r\n (Windows)
-
-        // On utilise une copie de la ligne pour strtok, car strtok modifie la chaîne
-        char line_copy[1024];
-        strcpy(line_copy, line);
-
-        char* tokens[7];
-        int token_count = 0;
-        char* token = strtok(line_copy, ";");
-        while (token != NULL && token_count < 7) {
-            tokens[token_count++] = token;
-            token = strtok(NULL, ";");
+char* database_next_field(char** cursor, char delim, DatabaseFormat format) {
+    char* p = *cursor;
+    while (*p == delim) p++;
+    if (*p == 0) {
+        *cursor = p;
+        return NULL;
+    }
+    char* token = p;
+    while (*p && *p != delim) {
+        if (*p == '\\' && p[1] && format == DATABASE_FORMAT_ESCAPED) p++;
+        p++;
+    }
+    if (*p) *p++ = 0;
+    *cursor = p;
+    return token;
+}
+
+void database_unescape_field(char* field) {
+    char* out = field;
+    for (const char* p = field; *p; p++) {
+        if (*p == '\\' && p[1]) {
+            p++;
+            *out++ = (*p == 'n') ? '\n' : *p;
+        } else {
+            *out++ = *p;
         }
+    }
+    *out = 0;
+}
 
-        if (token_count >= 6) {
-            Question q = {0};
-            q.matiere = my_strdup(tokens[0]);
-            q.chapitre = my_strdup(tokens[1]);
-            q.type = my_strdup(tokens[2]);
-            q.enonce = my_strdup(tokens[3]);
-            q.bonneReponse = atoi(tokens[4]);
-            
-            q.points = (token_count == 7) ? atoi(tokens[6]) : 1;
-
-            if (strcmp(tokens[5], "-") != 0) {
-                char* choix_str = my_strdup(tokens[5]);
-                char* p_choix = strtok(choix_str, "|");
-                q.nbChoix = 0;
-                q.choix = NULL;
-                while (p_choix) {
-                    q.choix = realloc(q.choix, sizeof(char*) * (q.nbChoix + 1));
-                    q.choix[q.nbChoix++] = my_strdup(p_choix);
-                    p_choix = strtok(NULL, "|");
-                }
-                free(choix_str);
-            } else {
-                q.choix = NULL;
-                q.nbChoix = 0;
-            }
-            add_question_to_db(db, q);
+DatabaseFormat database_file_format(const char* first_line) {
+    size_t len = strlen(DATABASE_FORMAT_HEADER);
+    if (strncmp(first_line, DATABASE_FORMAT_HEADER, len) != 0) return DATABASE_FORMAT_PLAIN;
+    return strchr("\r\n", first_line[len]) ? DATABASE_FORMAT_ESCAPED : DATABASE_FORMAT_PLAIN;
+}
+
+void database_write_header(FILE* f) {
+    fprintf(f, "%s\n", DATABASE_FORMAT_HEADER);
+}
+
+int split_question_line(const char* line, DatabaseFormat format, char line_copy[DATABASE_LINE_MAX], char* tokens[7]) {
+    size_t len = strcspn(line, "\r\n"); // Gère \n et \r\n (Windows)
+    if (len >= DATABASE_LINE_MAX) len = DATABASE_LINE_MAX - 1;
+    memcpy(line_copy, line, len);
+    line_copy[len] = 0;
+
+    int token_count = 0;
+    char* cursor = line_copy;
+    char* token = database_next_field(&cursor, ';', format);
+    while (token != NULL && token_count < 7) {
+        tokens[token_count++] = token;
+        token = database_next_field(&cursor, ';', format);
+    }
+    for (int i = 0; i < token_count && format == DATABASE_FORMAT_ESCAPED; i++) {
+        if (i != 5) database_unescape_field(tokens[i]); // Les choix sont découpés sur '|' avant
+    }
+    return token_count;
+}
+
+int is_question_line(const char* line, DatabaseFormat format) {
+    char line_copy[DATABASE_LINE_MAX];
+    char* tokens[7];
+    return split_question_line(line, format, line_copy, tokens) >= 6;
+}
+
+int parse_question_line_arena(const char* line, DatabaseFormat format, Question* q, Arena* arena,
+                              LabelTable* labels) {
+    char line_copy[DATABASE_LINE_MAX];
+    char* tokens[7];
+    int token_count = split_question_line(line, format, line_copy, tokens);
+    if (token_count < 6) return 0;
+
+    // Les choix au-delà de QUESTION_MAX_CHOICES sont ignorés
+    const char* choix[QUESTION_MAX_CHOICES];
+    int nbChoix = 0;
+    if (strcmp(tokens[5], "-") != 0) {
+        char* cursor = tokens[5];
+        for (char* p_choix = database_next_field(&cursor, '|', format); p_choix && nbChoix < QUESTION_MAX_CHOICES;
+             p_choix = database_next_field(&cursor, '|', format)) {
+            if (format == DATABASE_FORMAT_ESCAPED) database_unescape_field(p_choix);
+            choix[nbChoix++] = p_choix;
         }
     }
-    fclose(f);
+    int points = (token_count == 7) ? atoi(tokens[6]) : 1;
+    int status = pack_question(q, arena, labels, tokens[0], tokens[1], tokens[2], tokens[3], choix, nbChoix,
+                               atoi(tokens[4]), points);
+    if (status != GEN_OK) return status;
+    minhash_compute(question_enonce(q), q->minhash);
     return 1;
 }
 
-void save_database(const Database* db, const char* filename) {
-    FILE* f = fopen(filename, "w");
-    if (!f) {
-        perror("Erreur lors de la sauvegarde du fichier");
-        return;
+int parse_question_line(const char* line, DatabaseFormat format, Question* q) {
+    return parse_question_line_arena(line, format, q, NULL, NULL);
+}
+
+// Agrandit le tableau pour count questions de plus ; la base reste intacte en cas d'échec
+static int reserve_questions(Database* db, int count) {
+    if (db->count + count <= db->capacity) return GEN_OK;
+    int new_capacity = (db->capacity == 0) ? 10 : db->capacity * 2;
+    while (new_capacity < db->count + count) new_capacity *= 2;
+    Question* new_questions = mem_realloc(MEM_LOADER, db->questions, new_capacity * sizeof(Question));
+    if (!new_questions) return GEN_ERROR_NO_MEMORY;
+    db->questions = new_questions;
+    db->capacity = new_capacity;
+    return GEN_OK;
+}
+
+// Ajoute à la suite des questions dont les blocs sont déjà dans l'arène (place réservée).
+// Avec keys (support indexé), l'identifiant de chaque question est sa clé dans le support.
+static void append_questions(Database* db, const Question* questions, const StorageKey* keys, int count) {
+    int first = db->count;
+    for (int i = 0; i < count; i++) {
+        Question q = questions[i];
+        if (keys) db->next_id = (int)keys[i]; // Clés croissantes : les ids restent triés
+        q.id = db->next_id++;
+        db->questions[db->count++] = q;
     }
-    for (int i = 0; i < db->count; i++) {
-        Question q = db->questions[i];
-        fprintf(f, "%s;%s;%s;%s;%d;", q.matiere, q.chapitre, q.type, q.enonce, q.bonneReponse);
-        if (q.nbChoix > 0) {
-            for (int j = 0; j < q.nbChoix; j++) {
-                fprintf(f, "%s%s", q.choix[j], (j == q.nbChoix - 1) ? "" : "|");
-            }
-        } else {
-            fprintf(f, "-");
+    notify_listeners(db, DB_CHANGE_INSERTED, first, count, NULL);
+}
+
+typedef struct {
+    Database* db;
+    int keyed;     // Non nul : les clés du support deviennent les identifiants
+} LoadTarget;
+
+// Range une question lue par load_database
+static int load_question(void* user_data, StorageKey key, Question* q) {
+    LoadTarget* target = user_data;
+    int status = reserve_questions(target->db, 1);
+    if (status != GEN_OK) {
+        database_free_question_content(target->db, q);
+        return status;
+    }
+    append_questions(target->db, q, target->keyed ? &key : NULL, 1);
+    return GEN_OK;
+}
+
+int load_database(Database* db, const char* filename) {
+    if (bank_shards_is_directory(filename)) return bank_shards_open(db, filename);
+    struct stat st;
+    int missing = stat(filename, &st) != 0;
+    const StorageBackend* backend = storage_find(filename);
+    if (!backend) return GEN_ERROR_UNKNOWN_FORMAT;
+    if (missing && !backend->indexed) return GEN_ERROR_IO; // La base reste vide
+
+    Storage* storage;
+    int status = storage_open(filename, STORAGE_OPEN_EXISTING, &storage);
+    if (status != GEN_OK) return status;
+    // Un support indexé reste ouvert pour y reporter les modifications, si la base en vient
+    // entièrement (les identifiants sont alors ses clés)
+    if (backend->indexed && db->count == 0 && !db->storage && !db->shards) db->storage = storage;
+    LoadTarget target = { db, db->storage == storage };
+
+    uint64_t span = trace_begin();
+    PerfSample perf = perf_begin();
+    // Analysées directement dans l'arène : le chargement ne fait qu'avancer dans ses régions
+    LabelTable* labels = database_labels(db);
+    status = labels ? backend->iterate(storage->state, &db->arena, labels, load_question, &target)
+                    : GEN_ERROR_NO_MEMORY;
+    if (db->storage != storage) storage_close(storage);
+    perf_end(&perf, "load_database");
+    trace_end(span, "load_database");
+    if (status == GEN_OK && missing) status = GEN_ERROR_IO; // Support créé vide
+    return status;
+}
+
+void database_write_field(FILE* f, const char* field) {
+    for (;;) {
+        size_t len = strcspn(field, ";|\\\n\r"); // Écrit par morceaux entre deux caractères spéciaux
+        fwrite(field, 1, len, f);
+        field += len;
+        if (*field == 0) return;
+        if (*field == '\n') fputs("\\n", f);
+        else if (*field != '\r') fprintf(f, "\\%c", *field);
+        field++;
+    }
+}
+
+void database_write_question(FILE* f, const LabelTable* labels, const Question* q) {
+    const char* fields[4] = { question_label(labels, q, QUESTION_MATIERE), question_label(labels, q, QUESTION_CHAPITRE),
+                              question_label(labels, q, QUESTION_TYPE), question_enonce(q) };
+    for (int i = 0; i < 4; i++) {
+        database_write_field(f, fields[i]);
+        fputc(';', f);
+    }
+    fprintf(f, "%d;", q->bonneReponse);
+    if (q->nbChoix > 0) {
+        if (q->nbChoix == 1 && strcmp(question_choice(q, 0), "-") == 0) fputc('\\', f); // Pas "aucun choix"
+        for (int j = 0; j < q->nbChoix; j++) {
+            database_write_field(f, question_choice(q, j));
+            if (j < q->nbChoix - 1) fputc('|', f);
         }
-        fprintf(f, ";%d\n", q.points);
+    } else {
+        fprintf(f, "-");
+    }
+    fprintf(f, ";%d\n", q->points);
+}
+
+int save_database(const Database* db, const char* filename) {
+    if (bank_shards_is_directory(filename) || (db->shards && strcmp(filename, db->shards->directory) == 0)) {
+        return bank_shards_save(db, filename);
     }
-    fclose(f);
+    // Support d'origine : les modifications y sont déjà, il ne reste qu'à les valider
+    if (db->storage && strcmp(filename, db->storage->path) == 0) {
+        return db->storage->backend->commit(db->storage->state);
+    }
+    if (bank_shards_pending(db)) return GEN_ERROR_INVALID_ARGUMENT;
+
+    Storage* storage;
+    int status = storage_open(filename, STORAGE_OPEN_REPLACE, &storage);
+    if (status != GEN_OK) return status;
+    uint64_t span = trace_begin();
+    for (int i = 0; i < db->count && status == GEN_OK; i++) {
+        StorageKey key = 0;
+        status = storage->backend->put(storage->state, &key, &db->questions[i], db->labels);
+    }
+    if (status == GEN_OK) status = storage->backend->commit(storage->state);
+    storage_close(storage);
+    trace_end(span, "save_database");
+    return status;
+}
+
+int add_question_to_db(Database* db, Question q) {
+    minhash_compute(question_enonce(&q), q.minhash);
+    return add_questions_to_db(db, &q, 1);
 }
 
-void add_question_to_db(Database* db, Question q) {
-    if (db->count >= db->capacity) {
-        db->capacity = (db->capacity == 0) ? 10 : db->capacity * 2;
-        db->questions = realloc(db->questions, db->capacity * sizeof(Question));
-        if (!db->questions) {
-            perror("Erreur critique de re-allocation memoire");
-            exit(EXIT_FAILURE);
+// Ajoute les questions au support indexé de la base ; *keys (à libérer) reçoit leurs clés.
+// En cas d'échec, celles déjà ajoutées sont retirées.
+static int store_questions(Database* db, const Question* questions, int count, StorageKey** keys) {
+    const StorageBackend* backend = db->storage->backend;
+    *keys = mem_calloc(MEM_LOADER, count, sizeof(StorageKey));
+    if (!*keys) return GEN_ERROR_NO_MEMORY;
+    for (int i = 0; i < count; i++) {
+        int status = backend->put(db->storage->state, &(*keys)[i], &questions[i], db->labels);
+        if (status != GEN_OK) {
+            while (i-- > 0) backend->remove(db->storage->state, (*keys)[i]);
+            mem_free(MEM_LOADER, *keys);
+            *keys = NULL;
+            return status;
         }
     }
-    db->questions[db->count++] = q;
+    return GEN_OK;
 }
 
-void free_database(Database* db) {
-    for (int i = 0; i < db->count; i++) {
-        free_question_content(&db->questions[i]);
+int add_questions_to_db(Database* db, const Question* questions, int count) {
+    if (count <= 0) return GEN_OK;
+    uint64_t span = trace_begin();
+    // Base découpée : la matière est chargée avant, pour que son fichier soit réécrit en entier
+    for (int i = 0; i < count && db->shards; i++) {
+        int status = bank_shards_load(db, question_label(NULL, &questions[i], QUESTION_MATIERE));
+        if (status != GEN_OK) {
+            trace_end(span, "add_questions_to_db");
+            return status;
+        }
+    }
+    if (reserve_questions(db, count) != GEN_OK) {
+        trace_end(span, "add_questions_to_db");
+        return GEN_ERROR_NO_MEMORY; // La base reste intacte
     }
-    free(db->questions);
+    Question* copies = &db->questions[db->count];
+    for (int i = 0; i < count; i++) {
+        copies[i] = questions[i];
+        int status = copy_to_database(db, &copies[i]);
+        if (status != GEN_OK) {
+            while (i-- > 0) database_free_question_content(db, &copies[i]);
+            trace_end(span, "add_questions_to_db");
+            return status;
+        }
+    }
+    StorageKey* keys = NULL;
+    int status = db->storage ? store_questions(db, copies, count, &keys) : GEN_OK;
+    if (status != GEN_OK) {
+        for (int i = 0; i < count; i++) database_free_question_content(db, &copies[i]);
+        trace_end(span, "add_questions_to_db");
+        return status;
+    }
+    // La base ne garde que ses copies : les blocs d'origine sont rendus
+    for (int i = 0; i < count; i++) {
+        Question original = questions[i];
+        free_question_content(&original);
+    }
+    append_questions(db, copies, keys, count);
+    mem_free(MEM_LOADER, keys);
+    trace_end(span, "add_questions_to_db");
+    return GEN_OK;
+}
+
+void free_database(Database* db) {
+    arena_release(&db->arena); // Toutes les questions d'un coup, région par région
+    bank_shards_free(db->shards);
+    db->shards = NULL;
+    if (db->labels) label_table_free(db->labels);
+    mem_free(MEM_LOADER, db->labels);
+    db->labels = NULL;
+    storage_close(db->storage); // Les modifications non enregistrées sont abandonnées
+    db->storage = NULL;
+    mem_free(MEM_LOADER, db->questions);
+    mem_free(MEM_LOADER, db->listeners);
     db->questions = NULL;
     db->count = 0;
     db->capacity = 0;
+    db->listeners = NULL;
+    db->nbListeners = 0;
 }
 
-void print_database(const Database* db) {
-    printf("\n--- Contenu de la base de donnees (%d questions) ---\n", db->count);
-    if(db->count == 0) {
-        printf("La base de donnees est vide.\n");
+int database_compact(Database* db) {
+    uint64_t span = trace_begin();
+    Arena fresh = {0};
+    char** blocks = NULL;
+    Arena* old = NULL;
+    int status = GEN_OK;
+    if (db->count > 0 && !(blocks = mem_alloc(MEM_LOADER, db->count * sizeof(char*)))) status = GEN_ERROR_NO_MEMORY;
+    if (status == GEN_OK && db->retire_arena && !(old = mem_alloc(MEM_LOADER, sizeof(Arena)))) {
+        status = GEN_ERROR_NO_MEMORY;
+    }
+
+    // Copies dans l'ordre du tableau, à la suite : la base ne change qu'une fois toutes faites
+    for (int i = 0; i < db->count && status == GEN_OK; i++) {
+        size_t size = question_block_size(&db->questions[i]);
+        blocks[i] = arena_alloc(&fresh, size);
+        if (blocks[i]) memcpy(blocks[i], db->questions[i].choix, size);
+        else status = GEN_ERROR_NO_MEMORY;
+    }
+    if (status != GEN_OK) {
+        arena_release(&fresh);
+        mem_free(MEM_LOADER, blocks);
+        mem_free(MEM_LOADER, old);
+        trace_end(span, "database_compact");
+        return status;
+    }
+
+    for (int i = 0; i < db->count; i++) {
+        db->questions[i].choix = (QuestionChoice*)blocks[i];
+    }
+    mem_free(MEM_LOADER, blocks);
+    if (old) {
+        *old = db->arena;
+        db->arena = fresh;
+        db->retire_arena(old, db->retire_data);
     } else {
-        for (int i = 0; i < db->count; i++) {
-            printf("%d. [%s - %s] (%s): %s\n", i + 1, db->questions[i].matiere, db->questions[i].chapitre, db->questions[i].type, db->questions[i].enonce);
-        }
+        arena_release(&db->arena);
+        db->arena = fresh;
     }
-    printf("--------------------------------------------------\n");
+    trace_end(span, "database_compact");
+    return GEN_OK;
 }
 
-void delete_question_from_db(Database* db, int index) {
-    if (index < 0 || index >= db->count) {
-        printf("Erreur : Index de suppression invalide.\n");
-        return;
+// Contenu qui quitte la base : libéré tout de suite, ou confié à db->retire
+static void release_question(Database* db, Question* q) {
+    if (db->retire) db->retire(q, db->retire_data);
+    else database_free_question_content(db, q);
+
+    // Compactage quand les blocs libérés occupent une part notable de l'arène
+    const Arena* arena = &db->arena;
+    if (arena->free_bytes >= DATABASE_COMPACT_MIN_FREE && arena->free_bytes * 4 >= arena->reserved_bytes) {
+        database_compact(db); // En cas d'échec, la base garde son arène actuelle
+    }
+}
+
+int delete_question_from_db(Database* db, int index) {
+    if (index < 0 || index >= db->count) return GEN_ERROR_INVALID_ARGUMENT;
+    if (db->storage) {
+        int status = db->storage->backend->remove(db->storage->state, db->questions[index].id);
+        if (status != GEN_OK) return status;
     }
 
-    // 1. Libérer la mémoire de la question que l'on va supprimer
-    free_question_content(&db->questions[index]);
+    // 1. Mettre de côté la question supprimée : les écouteurs la reçoivent avant sa libération
+    Question removed = db->questions[index];
 
     // 2. Décaler tous les éléments suivants vers la gauche pour combler le trou
     // memmove est plus sûr que memcpy pour les zones qui se chevauchent.
@@ -164,7 +566,9 @@ void delete_question_from_db(Database* db, int index) {
     // 3. Mettre à jour le nombre total de questions
     db->count--;
 
-    printf("Question supprimee avec succes.\n");
+    notify_listeners(db, DB_CHANGE_REMOVED, index, 1, &removed);
+    release_question(db, &removed);
+    return GEN_OK;
 }
 
 // Fonction utilitaire pour vérifier si une chaîne est déjà dans un tableau de chaînes
@@ -177,51 +581,171 @@ static int is_in_array(char** array, int count, const char* value) {
     return 0; // Non trouvé
 }
 
+// Ajoute une copie de value à la liste si elle n'y figure pas encore ; retourne 0 si la mémoire manque
+static int add_unique_string(char*** array, int* count, const char* value) {
+    if (is_in_array(*array, *count, value)) return 1;
+    char** grown = mem_realloc(MEM_LOADER, *array, sizeof(char*) * (*count + 1));
+    if (!grown) return 0;
+    *array = grown;
+    char* copy = my_strdup(value);
+    if (!copy) return 0;
+    grown[(*count)++] = copy;
+    return 1;
+}
+
 char** get_unique_subjects(const Database* db, int* count) {
     char** subjects = NULL;
     *count = 0;
     for (int i = 0; i < db->count; i++) {
-        if (!is_in_array(subjects, *count, db->questions[i].matiere)) {
-            subjects = realloc(subjects, sizeof(char*) * (*count + 1));
-            subjects[*count] = db->questions[i].matiere; // On pointe directement, pas de copie
-            (*count)++;
+        if (!add_unique_string(&subjects, count, question_matiere(db, &db->questions[i]))) {
+            free_string_array(subjects, *count);
+            *count = 0;
+            return NULL;
         }
     }
-    return subjects;
+    if (!db->shards) return subjects;
+
+    // Base découpée : l'ordre du manifeste, les matières non chargées d'après leur nombre
+    // de questions, puis celles qui n'y figurent pas encore
+    char** ordered = NULL;
+    int ordered_count = 0;
+    int ok = 1;
+    for (int i = 0; ok && i < db->shards->count; i++) {
+        const BankShard* shard = &db->shards->shards[i];
+        int present = shard->loaded ? is_in_array(subjects, *count, shard->matiere) : shard->count > 0;
+        if (present) ok = add_unique_string(&ordered, &ordered_count, shard->matiere);
+    }
+    for (int i = 0; ok && i < *count; i++) {
+        ok = add_unique_string(&ordered, &ordered_count, subjects[i]);
+    }
+    free_string_array(subjects, *count);
+    if (!ok) {
+        free_string_array(ordered, ordered_count);
+        ordered = NULL;
+        ordered_count = 0;
+    }
+    *count = ordered_count;
+    return ordered;
 }
 
 char** get_unique_chapters(const Database* db, const char* subject, int* count) {
     char** chapters = NULL;
     *count = 0;
-    for (int i = 0; i < db->count; i++) {
-        if (strcmp(db->questions[i].matiere, subject) == 0) {
-            if (!is_in_array(chapters, *count, db->questions[i].chapitre)) {
-                chapters = realloc(chapters, sizeof(char*) * (*count + 1));
-                chapters[*count] = db->questions[i].chapitre;
-                (*count)++;
+    const BankShard* shard = bank_shards_find(db, subject);
+    if (shard && !shard->loaded) {
+        for (int i = 0; i < shard->nb_chapters; i++) {
+            if (!add_unique_string(&chapters, count, shard->chapters[i])) {
+                free_string_array(chapters, *count);
+                *count = 0;
+                return NULL;
             }
         }
+        return chapters;
+    }
+    for (int i = 0; i < db->count; i++) {
+        if (strcmp(question_matiere(db, &db->questions[i]), subject) != 0) continue;
+        if (!add_unique_string(&chapters, count, question_chapitre(db, &db->questions[i]))) {
+            free_string_array(chapters, *count);
+            *count = 0;
+            return NULL;
+        }
     }
     return chapters;
 }
 
-// NOTE: Cette fonction libère uniquement le tableau de pointeurs, pas les chaînes elles-mêmes,
-// car elles pointent vers les données de la base de données principale.
+// Les chaînes sont des copies : elles restent valides si la base change entre-temps
 void free_string_array(char** array, int count) {
-    free(array);
+    if (!array) return;
+    for (int i = 0; i < count; i++) {
+        mem_free(MEM_LOADER, array[i]);
+    }
+    mem_free(MEM_LOADER, array);
 }
 
-void update_question_in_db(Database* db, int index, Question new_question) {
+int update_question_in_db(Database* db, int index, Question new_question) {
     if (index < 0 || index >= db->count) {
-        printf("Erreur : Index de mise a jour invalide.\n");
-        return;
-    }
-    
-    // Free old question content
-    free_question_content(&db->questions[index]);
-    
-    // Replace with new question
+        free_question_content(&new_question);
+        return GEN_ERROR_INVALID_ARGUMENT;
+    }
+    // Une question qui change de matière rejoint une matière chargée (les index restent valides)
+    int status = database_require_subject(db, question_label(NULL, &new_question, QUESTION_MATIERE));
+    if (status != GEN_OK) {
+        free_question_content(&new_question);
+        return status;
+    }
+    Question original = new_question;
+    status = copy_to_database(db, &new_question);
+    free_question_content(&original);
+    if (status != GEN_OK) return status;
+
+    // Replace with new question (same id), then free old content once listeners have seen it
+    Question old_question = db->questions[index];
+    new_question.id = old_question.id;
+    minhash_compute(question_enonce(&new_question), new_question.minhash);
+    if (db->storage) {
+        StorageKey key = old_question.id; // Une seule ligne réécrite
+        status = db->storage->backend->put(db->storage->state, &key, &new_question, db->labels);
+        if (status != GEN_OK) {
+            database_free_question_content(db, &new_question);
+            return status;
+        }
+    }
     db->questions[index] = new_question;
-    
-    printf("Question mise a jour avec succes.\n");
+
+    notify_listeners(db, DB_CHANGE_CHANGED, index, 1, &old_question);
+    release_question(db, &old_question);
+    return GEN_OK;
+}
+
+int database_add_listener(Database* db, DatabaseListenerFunc func, void* user_data) {
+    DatabaseListener* listeners = mem_realloc(MEM_LOADER, db->listeners, sizeof(DatabaseListener) * (db->nbListeners + 1));
+    if (!listeners) return GEN_ERROR_NO_MEMORY;
+    db->listeners = listeners;
+    db->listeners[db->nbListeners].func = func;
+    db->listeners[db->nbListeners].user_data = user_data;
+    db->nbListeners++;
+    return GEN_OK;
+}
+
+void database_remove_listener(Database* db, DatabaseListenerFunc func, void* user_data) {
+    for (int i = 0; i < db->nbListeners; i++) {
+        if (db->listeners[i].func == func && db->listeners[i].user_data == user_data) {
+            memmove(&db->listeners[i], &db->listeners[i + 1], (db->nbListeners - i - 1) * sizeof(DatabaseListener));
+            db->nbListeners--;
+            return;
+        }
+    }
+}
+
+int database_require_subject(Database* db, const char* subject) {
+    return bank_shards_load(db, subject);
+}
+
+int database_require_all(Database* db) {
+    int status = GEN_OK;
+    for (int i = 0; db->shards && i < db->shards->count; i++) {
+        int loaded = bank_shards_load(db, db->shards->shards[i].matiere);
+        if (status == GEN_OK) status = loaded;
+    }
+    return status;
+}
+
+int database_total_count(const Database* db) {
+    int total = db->count;
+    for (int i = 0; db->shards && i < db->shards->count; i++) {
+        if (!db->shards->shards[i].loaded) total += db->shards->shards[i].count;
+    }
+    return total;
+}
+
+int database_find_by_id(const Database* db, int id) {
+    int low = 0, high = db->count - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        int mid_id = db->questions[mid].id;
+        if (mid_id == id) return mid;
+        if (mid_id < id) low = mid + 1;
+        else high = mid - 1;
+    }
+    return -1;
 }
@@ -2,36 +2,206 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <stdio.h>
 #include "structures.h"
+#include "gen_status.h"
 
-// Charge les questions depuis le fichier dans la structure Database
+// Taille des lectures du fichier de questions : une ligne plus longue est lue en plusieurs morceaux
+#define DATABASE_LINE_MAX 1024
+
+// Première ligne des fichiers de questions écrits par database_write_header
+#define DATABASE_FORMAT_HEADER "#generateur-epreuves format 2"
+
+// Format d'un fichier de questions, annoncé par sa première ligne (database_file_format)
+typedef enum {
+    DATABASE_FORMAT_PLAIN,     // Sans en-tête (fichiers historiques) : '\' est un caractère ordinaire
+    DATABASE_FORMAT_ESCAPED    // En-tête DATABASE_FORMAT_HEADER : champs échappés (split_question_line)
+} DatabaseFormat;
+
+// Seuil de compactage automatique : octets libérés dans l'arène de la base (voir database_compact)
+#define DATABASE_COMPACT_MIN_FREE (1024 * 1024)
+
+// Les fonctions qui peuvent échouer retournent GEN_OK ou un code GenStatus (gen_status.h)
+// et n'affichent rien. Une base n'est pas protégée contre les accès concurrents : un seul
+// thread la modifie, les autres lisent un instantané (snapshot.h).
+
+// Charge les questions depuis le fichier dans la structure Database.
+// Si filename est un répertoire (base découpée, bank_shards.h), seul son manifeste est lu :
+// les questions d'une matière arrivent avec database_require_subject.
+// Un fichier SQLite (storage.h) chargé dans une base vide reste ouvert (db->storage) : les
+// identifiants des questions sont leurs clés, et chaque modification y est reportée en place.
+// GEN_ERROR_IO si le fichier n'existe pas (un fichier SQLite est alors créé vide) ou ne peut
+// être lu (la base reste alors utilisable), GEN_ERROR_UNKNOWN_FORMAT pour un fichier SQLite
+// sans -DGEN_WITH_SQLITE.
 int load_database(Database* db, const char* filename);
 
-// Sauvegarde la base de donnes en mmoire dans le fichier
-void save_database(const Database* db, const char* filename);
+// Sauvegarde la base de donnes en mmoire dans le fichier.
+// Un répertoire (ou celui d'où vient une base découpée) reçoit un fichier par matière.
+// Le fichier de db->storage ne reçoit que la validation des modifications déjà reportées ;
+// tout autre fichier est remplacé d'un coup par le contenu de la base (support d'après
+// l'extension, storage_find).
+// GEN_ERROR_INVALID_ARGUMENT si des matières d'une base découpée ne sont pas chargées et que
+// filename n'est pas son répertoire : elles seraient perdues.
+int save_database(const Database* db, const char* filename);
+
+// Écrit q (libellés dans labels, NULL pour une question isolée) sur une ligne au format
+// DATABASE_FORMAT_ESCAPED, séparateurs échappés (split_question_line) ; le fichier commence
+// par database_write_header
+void database_write_question(FILE* f, const LabelTable* labels, const Question* q);
+
+// Écrit la ligne d'en-tête DATABASE_FORMAT_HEADER
+void database_write_header(FILE* f);
+
+// Écrit un champ au format DATABASE_FORMAT_ESCAPED : '\' devant les séparateurs (';', '|')
+// et '\', \n pour un saut de ligne. Sert aussi au manifeste d'une base découpée.
+void database_write_field(FILE* f, const char* field);
+
+// Équivalent réentrant de strtok : découpe *cursor (modifié sur place) au prochain delim,
+// en sautant les champs vides comme strtok. Au format DATABASE_FORMAT_ESCAPED, un délimiteur
+// précédé de '\' fait partie du champ, qui reste échappé (database_unescape_field).
+// Retourne NULL quand il n'y a plus de champ.
+char* database_next_field(char** cursor, char delim, DatabaseFormat format);
+
+// Retire sur place les échappements d'un champ de database_next_field : \n redevient un
+// saut de ligne, '\' suivi d'un autre caractère redevient ce caractère
+void database_unescape_field(char* field);
+
+// Format d'un fichier d'après sa première ligne (fin de ligne comprise ou non). La ligne
+// d'en-tête n'est pas une question : les fonctions d'analyse la rejettent comme telle.
+DatabaseFormat database_file_format(const char* first_line);
+
+// Base découpée : charge les questions de la matière si ce n'est pas encore fait.
+// Sans effet pour une base d'un seul fichier ou une matière inconnue.
+// Retourne GEN_OK, GEN_ERROR_IO ou GEN_ERROR_NO_MEMORY (matière alors laissée à charger).
+int database_require_subject(Database* db, const char* subject);
+
+// Charge toutes les matières (liste, recherche, doublons sur toute la base) ;
+// retourne la première erreur rencontrée
+int database_require_all(Database* db);
+
+// Nombre de questions de la base, matières pas encore chargées comprises
+int database_total_count(const Database* db);
 
 // Ajoute une question la base de donnes en mmoire
-void add_question_to_db(Database* db, Question q);
+int add_question_to_db(Database* db, Question q);
+
+// Ajoute un lot de questions isolées analysées par parse_question_line (signatures déjà
+// calculées) ; leurs blocs sont recopiés dans l'arène de la base, sans les libellés, rangés
+// dans db->labels, puis libérés, et les écouteurs reçoivent une seule notification pour tout le lot.
+// Dans une base découpée, la matière de chaque question est d'abord chargée ; avec
+// db->storage, les questions y sont ajoutées et leurs clés deviennent leurs identifiants.
+// En cas d'échec (GEN_ERROR_NO_MEMORY, GEN_ERROR_IO au chargement d'une matière ou dans le
+// support), la base est inchangée (hormis les matières chargées) et les questions restent à l'appelant.
+int add_questions_to_db(Database* db, const Question* questions, int count);
+
+// Analyse une ligne du fichier de questions (matiere;chapitre;type;enonce;reponse;choix;points),
+// de format celui du fichier d'où elle vient.
+// Retourne 1 et remplit q si la ligne est valide, 0 sinon, GEN_ERROR_NO_MEMORY si la mémoire
+// manque. Ne touche à aucune base : peut être appelée depuis un autre thread.
+int parse_question_line(const char* line, DatabaseFormat format, Question* q);
+
+// parse_question_line avec le bloc de la question pris dans arena (isolé si NULL) et ses
+// libellés rangés dans labels (dans le bloc si NULL)
+int parse_question_line_arena(const char* line, DatabaseFormat format, Question* q, Arena* arena,
+                              LabelTable* labels);
+
+// Retourne 1 si parse_question_line retiendrait la ligne, 0 sinon, sans rien allouer
+int is_question_line(const char* line, DatabaseFormat format);
+
+// Découpe une copie de la ligne (sans sa fin de ligne) en 7 champs au plus, comme
+// parse_question_line mais sans rien allouer ; tokens pointe dans line_copy.
+// Au format DATABASE_FORMAT_ESCAPED, '\' protège le caractère qui le suit (';', '|', '\') et
+// \n note un saut de ligne : les champs sont rendus sans ces échappements, sauf tokens[5]
+// (les choix, encore à séparer sur '|'). Au format DATABASE_FORMAT_PLAIN, la ligne est
+// découpée telle quelle. Retourne le nombre de champs (au moins 6 pour une question).
+int split_question_line(const char* line, DatabaseFormat format, char line_copy[DATABASE_LINE_MAX], char* tokens[7]);
+
+// Construit la question isolée q dans un seul bloc (structures.h) avec des copies des chaînes
+// et des nbChoix choix ; id et minhash sont mis à zéro. Une bonne réponse hors de
+// [-1, QUESTION_MAX_CHOICES[ devient -1. Retourne GEN_OK, GEN_ERROR_NO_MEMORY, ou
+// GEN_ERROR_INVALID_ARGUMENT (chaîne manquante, plus de QUESTION_MAX_CHOICES choix) ; q est
+// alors vide.
+int question_init(Question* q, const char* matiere, const char* chapitre, const char* type,
+                  const char* enonce, const char* const* choix, int nbChoix, int bonneReponse, int points);
+
+// question_init avec le bloc pris dans arena (isolé si NULL) et les libellés rangés dans
+// labels (dans le bloc si NULL, ou pour les nouveaux libellés quand labels est plein)
+int question_init_arena(Question* q, Arena* arena, LabelTable* labels, const char* matiere, const char* chapitre,
+                        const char* type, const char* enonce, const char* const* choix, int nbChoix,
+                        int bonneReponse, int points);
+
+// Copie q (libellés dans from, NULL pour une question isolée) et son bloc dans arena (bloc
+// isolé si NULL), id et signature compris ; les libellés de la copie vont dans labels, ou
+// dans son bloc si NULL. out peut désigner q. Retourne GEN_OK ou une erreur de question_init.
+int question_copy(Question* out, const Question* q, const LabelTable* from, Arena* arena, LabelTable* labels);
+
+// Libellé de q : texte de labels (la table de sa base), ou rangé dans le bloc d'une
+// question isolée (labels peut alors être NULL). Valide tant que q et la base le sont.
+const char* question_label(const LabelTable* labels, const Question* q, QuestionLabel which);
+
+// Libellés d'une question de db
+static inline const char* question_matiere(const Database* db, const Question* q) {
+    return question_label(db->labels, q, QUESTION_MATIERE);
+}
+
+static inline const char* question_chapitre(const Database* db, const Question* q) {
+    return question_label(db->labels, q, QUESTION_CHAPITRE);
+}
+
+static inline const char* question_type(const Database* db, const Question* q) {
+    return question_label(db->labels, q, QUESTION_TYPE);
+}
+
+// Table des libellés de db, créée au premier appel ; NULL si la mémoire manque
+LabelTable* database_labels(Database* db);
+
+// Libère le bloc d'une question isolée (question_init, parse_question_line), pas la structure
+void free_question_content(Question* q);
+
+// Rend à l'arène de db le bloc d'une question qui a quitté la base (voir retire dans
+// structures.h). Sans effet si le bloc appartient à une arène déjà remplacée par un compactage.
+void database_free_question_content(Database* db, Question* q);
 
 // Libre toute la mmoire alloue pour la base de donnes
 void free_database(Database* db);
 
-// Affiche toutes les questions (pour le dbogage/vrification)
-void print_database(const Database* db);
+// Recopie les blocs de toutes les questions à la suite dans une arène neuve et rend
+// l'ancienne (aussitôt, ou par db->retire_arena). Appelée d'elle-même après une suppression
+// ou un remplacement quand les blocs libérés dépassent DATABASE_COMPACT_MIN_FREE octets et
+// le quart de l'arène. Les énoncés et les choix lus avant l'appel ne sont plus valides (les
+// libellés, hors de l'arène, le restent).
+// Retourne GEN_OK, ou GEN_ERROR_NO_MEMORY (la base garde alors son arène).
+int database_compact(Database* db);
 
 // Supprime une question de la base de donnes un index donn
-void delete_question_from_db(Database* db, int index);
+// (et de db->storage : la base est inchangée si le support refuse)
+int delete_question_from_db(Database* db, int index);
 
-// Extrait une liste de matires uniques depuis la base de donnes
+// Extrait une liste de matires uniques depuis la base de donnes (copies des chaînes).
+// Une base découpée donne d'abord les matières de son manifeste, chargées ou non.
+// Retourne NULL si la base est vide ou si la mémoire manque.
 char** get_unique_subjects(const Database* db, int* count);
 
 // Extrait une liste de chapitres uniques pour une matire donne
+// (d'après le manifeste si la matière d'une base découpée n'est pas chargée)
 char** get_unique_chapters(const Database* db, const char* subject, int* count);
 
-// Libre la mmoire alloue par les fonctions ci-dessus
+// Libre la mmoire alloue par les fonctions ci-dessus (le tableau et ses count chaînes)
 void free_string_array(char** array, int count);
 
-// Met jour une question dans la base de donnes en mmoire
-void update_question_in_db(Database* db, int index, Question new_question);
+// Met jour une question dans la base de donnes en mmoire.
+// La base devient propriétaire de new_question, même en cas d'erreur (contenu libéré).
+// Dans une base découpée, la matière de new_question est d'abord chargée.
+// Avec db->storage, seule la question modifiée y est réécrite.
+int update_question_in_db(Database* db, int index, Question new_question);
+
+// Abonne une fonction aux modifications (insertion, suppression, remplacement)
+int database_add_listener(Database* db, DatabaseListenerFunc func, void* user_data);
+
+// Désabonne une fonction enregistrée avec database_add_listener
+void database_remove_listener(Database* db, DatabaseListenerFunc func, void* user_data);
+
+// Retourne l'index de la question d'identifiant id, ou -1 (recherche dichotomique)
+int database_find_by_id(const Database* db, int id);
 
 #endif
@@ -0,0 +1,15 @@
+// gen_status.c
+#include "gen_status.h"
+
+const char* gen_status_message(int status) {
+    switch (status) {
+        case GEN_OK: return "succes";
+        case GEN_CANCELLED: return "operation annulee";
+        case GEN_ERROR_NO_MEMORY: return "memoire insuffisante";
+        case GEN_ERROR_IO: return "erreur de lecture ou d'ecriture de fichier";
+        case GEN_ERROR_INVALID_ARGUMENT: return "parametre invalide";
+        case GEN_ERROR_UNKNOWN_FORMAT: return "format inconnu ou non pris en charge";
+        case GEN_ERROR_NOT_ENOUGH_QUESTIONS: return "pas assez de questions dans la base";
+        default: return "erreur";
+    }
+}
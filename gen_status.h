@@ -0,0 +1,21 @@
+// gen_status.h - Codes de retour communs de la bibliothèque
+#ifndef GEN_STATUS_H
+#define GEN_STATUS_H
+
+// Les fonctions de la bibliothèque n'affichent rien et ne quittent jamais le programme :
+// elles retournent GEN_OK (0) ou l'un de ces codes négatifs, que l'appelant présente.
+typedef enum {
+    GEN_OK = 0,
+    GEN_ERROR = -1,                      // Échec sans précision
+    GEN_CANCELLED = -2,                  // Arrêt demandé par la fonction de progression
+    GEN_ERROR_NO_MEMORY = -3,
+    GEN_ERROR_IO = -4,                   // Fichier introuvable, illisible ou impossible à écrire
+    GEN_ERROR_INVALID_ARGUMENT = -5,     // Index hors limites, paramètre manquant...
+    GEN_ERROR_UNKNOWN_FORMAT = -6,       // Format de sortie ou de base inconnu (ou SQLite non compilé)
+    GEN_ERROR_NOT_ENOUGH_QUESTIONS = -7  // La base ne permet pas de composer l'épreuve
+} GenStatus;
+
+// Description en français d'un code de retour (chaîne statique)
+const char* gen_status_message(int status);
+
+#endif
@@ -2,23 +2,51 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <errno.h>
 #include <time.h>
-#include <cairo.h>
-#include <cairo-pdf.h>
+#include <sys/stat.h>
 #ifdef _WIN32
     #include <direct.h>
     #define mkdir(path, mode) _mkdir(path)
 #else
-    #include <sys/stat.h>
     #include <sys/types.h>
 #endif
 #include "generator.h"
+#include "storage.h"
+#include "database.h"
+#include "bank_shards.h"
+#include "output_sink.h"
+#include "renderer.h"
+#include "string_map.h"
+#include "minhash.h"
+#include "mem_track.h"
+#include "perf_counters.h"
+#include "trace.h"
 
-// Fonction pour mélanger un tableau d'indices (Fisher-Yates shuffle)
-void shuffle(int *array, size_t n) {
+// Borne sur le nombre de questions d'une épreuve (20 QCM, ou 10 QCM + 1 exercice)
+#define GENERATOR_MAX_QUESTIONS 32
+
+// Génération en flux avec écart des quasi-doublons : candidats gardés par question demandée
+#define STREAM_NEAR_DUPLICATE_SPARE 4
+
+uint64_t generator_mix_seed(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Générateur pseudo-aléatoire splitmix64 : un état par épreuve, aucun état partagé
+static uint64_t next_random(uint64_t* state) {
+    return generator_mix_seed(*state += 0x9E3779B97F4A7C15ULL);
+}
+
+// Mélange un tableau d'indices (Fisher-Yates), tiré depuis state
+static void shuffle(int *array, size_t n, uint64_t* state) {
     if (n > 1) {
         for (size_t i = 0; i < n - 1; i++) {
-            size_t j = i + rand() / (RAND_MAX / (n - i) + 1);
+            size_t j = i + (size_t)(next_random(state) % (n - i));
             int t = array[j];
             array[j] = array[i];
             array[i] = t;
@@ -26,457 +54,704 @@ void shuffle(int *array, size_t n) {
     }
 }
 
-static double draw_wrapped_text(cairo_t *cr, const char *text, double x, double y, double max_width, double line_height) {
-    if (!text || strlen(text) == 0) return y;
-    
-    char *text_copy = strdup(text);
-    char *line_start = text_copy;
-    char *current = text_copy;
-    double current_y = y;
-    int text_rendered = 0;
-    
-    while (*current) {
-        char *word_end = current;
-        while (*word_end && *word_end != ' ' && *word_end != '\n') word_end++;
-        
-        char saved = *word_end;
-        *word_end = '\0';
-        
-        cairo_text_extents_t extents;
-        cairo_text_extents(cr, line_start, &extents);
-        
-        if (extents.width > max_width && current != line_start) {
-            *(current - 1) = '\0';
-            cairo_move_to(cr, x, current_y);
-            cairo_show_text(cr, line_start);
-            current_y += line_height;
-            line_start = current;
-            *word_end = saved;
-            text_rendered = 0;
+// Graine d'une requête sans graine : horloge mélangée à un compteur atomique, pour que deux
+// épreuves produites dans la même seconde (par deux threads) ne soient pas identiques
+static uint64_t fresh_seed(void) {
+    static atomic_uint_fast64_t counter;
+    uint64_t n = atomic_fetch_add(&counter, 1);
+    return generator_mix_seed((uint64_t)time(NULL) ^ generator_mix_seed(n + (uint64_t)clock()));
+}
+
+// Écrit le message d'erreur dans le compte rendu, s'il y en a un
+static void report_error(const ExamRequest* request, const char* format, ...) {
+    if (!request->report) return;
+    va_list args;
+    va_start(args, format);
+    vsnprintf(request->report->message, sizeof(request->report->message), format, args);
+    va_end(args);
+}
+
+// localtime() partage son résultat entre threads : on utilise la variante réentrante
+static void local_time(time_t t, struct tm* out) {
+#ifdef _WIN32
+    localtime_s(out, &t);
+#else
+    localtime_r(&t, out);
+#endif
+}
+
+// Construit "<dossier>/<base>_<horodatage>.<ext>" en allouant exactement la taille nécessaire
+static char* build_output_path(const char* output_dir, const char* output_filename, const char* extension,
+                               const struct tm* t) {
+    const char* dot = strrchr(output_filename, '.');
+    size_t base_len = dot ? (size_t)(dot - output_filename) : strlen(output_filename);
+
+    char timestamp[64];
+    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", t);
+
+    size_t size = strlen(output_dir) + 1 + base_len + 1 + strlen(timestamp) + 1 + strlen(extension) + 1;
+    char* full_path = mem_alloc(MEM_GENERATOR, size);
+    if (!full_path) return NULL;
+    snprintf(full_path, size, "%s/%.*s_%s.%s", output_dir, (int)base_len, output_filename, timestamp, extension);
+    return full_path;
+}
+
+int generate_exam(const Database* db, const char* matiere, const char* chapitre, 
+                  ExamType exam_type, const char* output_filename, const char* format) {
+    ExamRequest request = {0};
+    request.matiere = matiere;
+    request.chapitre = chapitre;
+    request.exam_type = exam_type;
+    return generate_exam_files(db, &request, output_filename, format);
+}
+
+// Ouvre un fichier par format puis produit l'épreuve, depuis pool s'il est fourni, ou en
+// lisant bank_path (generate_exam_stream)
+static int write_exam_files(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                            const char* bank_path, const char* output_filename, const char* format) {
+    // Un format simple ("PDF") ou une liste ("PDF,HTML") : tous les fichiers
+    // partagent la même sélection de questions et le même horodatage.
+    ExamOutput outputs[GENERATOR_MAX_OUTPUTS];
+    OutputSink sinks[GENERATOR_MAX_OUTPUTS];
+    char* paths[GENERATOR_MAX_OUTPUTS];
+    int nb_outputs = 0;
+    const char* output_dir = request->output_dir ? request->output_dir : GENERATOR_OUTPUT_DIR;
+    if (request->report) {
+        request->report->nb_files = 0;
+        request->report->message[0] = 0;
+    }
+
+    // Sans effet si le dossier existe déjà ; pas d'indicateur statique partagé entre threads
+    mkdir(output_dir, 0777);
+
+    struct tm now;
+    local_time(time(NULL), &now);
+
+    int result = GEN_OK;
+    const char* p = format;
+    while (*p && nb_outputs < GENERATOR_MAX_OUTPUTS && result == GEN_OK) {
+        size_t len = strcspn(p, ",+");
+        const Renderer* renderer = renderer_find_n(p, len);
+        char* full_path = renderer ? build_output_path(output_dir, output_filename, renderer->extension, &now) : NULL;
+        if (!renderer) {
+            report_error(request, "Format de sortie inconnu : '%.*s'", (int)len, p);
+            result = GEN_ERROR_UNKNOWN_FORMAT;
+        } else if (!full_path) {
+            report_error(request, "Memoire insuffisante");
+            result = GEN_ERROR_NO_MEMORY;
         } else {
-            *word_end = saved;
-            if (*word_end == '\n' || *word_end == '\0') {
-                cairo_move_to(cr, x, current_y);
-                cairo_show_text(cr, line_start);
-                current_y += line_height;
-                text_rendered = 1;
-                if (*word_end == '\n') {
-                    current = word_end + 1;
-                    line_start = current;
-                    text_rendered = 0;
-                } else {
-                    break;
-                }
-            } else {
-                current = word_end + 1;
-                text_rendered = 0;
-            }
+            paths[nb_outputs] = full_path;
+            output_sink_init_file(&sinks[nb_outputs], full_path);
+            outputs[nb_outputs].renderer = renderer;
+            outputs[nb_outputs].sink = &sinks[nb_outputs];
+            nb_outputs++;
         }
+        p += len;
+        if (*p) p++;
     }
-    
-    if (!text_rendered && line_start < current && *line_start != '\0') {
-        cairo_move_to(cr, x, current_y);
-        cairo_show_text(cr, line_start);
-        current_y += line_height;
-    }
-    
-    free(text_copy);
-    return current_y;
-}
-
-// PDF generation function
-static void generate_exam_pdf(const Database* db, const char* matiere, const char* chapitre,
-                              ExamType exam_type, const char* full_path,
-                              int* qcm_indices, int* exercice_indices,
-                              int nbQCM, int nbExercice, double points_per_qcm, int points_per_exercice) {
-    cairo_surface_t *surface = cairo_pdf_surface_create(full_path, 595, 842); // A4 size
-    cairo_t *cr = cairo_create(surface);
-    
-    double margin = 50;
-    double page_width = 595 - 2 * margin;
-    double y = margin;
-    
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    
-    // Header with gradient effect
-    cairo_set_source_rgb(cr, 0.12, 0.25, 0.69); // Blue color
-    cairo_rectangle(cr, 0, 0, 595, 80);
-    cairo_fill(cr);
-    
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 20);
-    cairo_move_to(cr, margin, 35);
-    cairo_show_text(cr, "EPREUVE D'INGENIERIE INFORMATIQUE");
-    
-    y = 100;
-    
-    // Exam details
-    cairo_set_source_rgb(cr, 0, 0, 0);
-    cairo_set_font_size(cr, 12);
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    
-    char buffer[256];
-    snprintf(buffer, sizeof(buffer), "Matiere : %s", matiere);
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, buffer);
-    y += 20;
-    
-    snprintf(buffer, sizeof(buffer), "Chapitre : %s", (chapitre && strlen(chapitre) > 0) ? chapitre : "Tous");
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, buffer);
-    y += 20;
-    
-    snprintf(buffer, sizeof(buffer), "Type d'epreuve : %s", 
-             exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, buffer);
-    y += 20;
-    
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, "Note totale : 20 points");
-    y += 20;
-    
-    snprintf(buffer, sizeof(buffer), "Date : %02d/%02d/%04d", 
-             t->tm_mday, t->tm_mon + 1, t->tm_year + 1900);
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, buffer);
-    y += 30;
-    
-    // Separator line
-    cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
-    cairo_set_line_width(cr, 1);
-    cairo_move_to(cr, margin, y);
-    cairo_line_to(cr, 595 - margin, y);
-    cairo_stroke(cr);
-    y += 25;
-    
-    // QCM Section
-    cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 14);
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, "PARTIE 1 : QUESTIONS A CHOIX MULTIPLES");
-    y += 20;
-    
-    cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
-    cairo_set_font_size(cr, 10);
-    snprintf(buffer, sizeof(buffer), "(%d questions - %.1f point%s chacune)", 
-             nbQCM, points_per_qcm, points_per_qcm > 1 ? "s" : "");
-    cairo_move_to(cr, margin, y);
-    cairo_show_text(cr, buffer);
-    y += 25;
-    
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-    cairo_set_font_size(cr, 11);
-    
-    for (int i = 0; i < nbQCM; i++) {
-        if (y > 750) { // New page if needed
-            cairo_show_page(cr);
-            y = margin;
+    if (result == GEN_OK && nb_outputs == 0) {
+        report_error(request, "Aucun format de sortie demande");
+        result = GEN_ERROR_UNKNOWN_FORMAT;
+    }
+
+    if (result == GEN_OK) {
+        result = bank_path ? generate_exam_stream(bank_path, request, outputs, nb_outputs)
+               : pool ? generate_exam_from_pool(db, request, pool, outputs, nb_outputs)
+                      : generate_exam_outputs(db, request, outputs, nb_outputs);
+    }
+
+    for (int i = 0; i < nb_outputs; i++) {
+        output_sink_free(&sinks[i]);
+        if (result != GEN_OK) {
+            remove(paths[i]); // Pas de fichier tronqué après une erreur ou une annulation
+        } else if (request->report) {
+            snprintf(request->report->files[i], GENERATOR_MAX_PATH, "%s", paths[i]);
+            request->report->nb_files++;
         }
-        
-        Question q = db->questions[qcm_indices[i]];
-        
-        // Question header
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        snprintf(buffer, sizeof(buffer), "Question %d (%.1f point%s) :", 
-                 i + 1, points_per_qcm, points_per_qcm > 1 ? "s" : "");
-        cairo_move_to(cr, margin, y);
-        cairo_show_text(cr, buffer);
-        y += 20;
-        
-        // Question text with proper wrapping
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-        y = draw_wrapped_text(cr, q.enonce, margin + 5, y, page_width - 10, 16);
-        y += 10; // Space after question text
-        
-        // Choices
-        for (int j = 0; j < q.nbChoix; j++) {
-            if (y > 780) { // Check for page break
-                cairo_show_page(cr);
-                y = margin;
-            }
-            snprintf(buffer, sizeof(buffer), "%c) %s", 'A' + j, q.choix[j]);
-            y = draw_wrapped_text(cr, buffer, margin + 15, y, page_width - 20, 16);
-            y += 5; // Small space between choices
+        mem_free(MEM_GENERATOR, paths[i]);
+    }
+    return result;
+}
+
+int generate_exam_files(const Database* db, const ExamRequest* request,
+                        const char* output_filename, const char* format) {
+    return write_exam_files(db, request, NULL, NULL, output_filename, format);
+}
+
+int generate_exam_files_from_pool(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                                  const char* output_filename, const char* format) {
+    return write_exam_files(db, request, pool, NULL, output_filename, format);
+}
+
+int generate_exam_files_stream(const char* bank_path, const ExamRequest* request,
+                               const char* output_filename, const char* format) {
+    return write_exam_files(NULL, request, NULL, bank_path, output_filename, format);
+}
+
+int generate_exams_by_chapter(const Database* db, const ExamRequest* request,
+                              const char* const* chapters, int nb_chapters,
+                              const char* output_filename, const char* format) {
+    ChapterPartition partition;
+    if (partition_by_chapter(db, request->matiere, chapters, nb_chapters, &partition) != GEN_OK) {
+        report_error(request, "Memoire insuffisante");
+        return nb_chapters;
+    }
+
+    const char* dot = strrchr(output_filename, '.');
+    int base_len = dot ? (int)(dot - output_filename) : (int)strlen(output_filename);
+    int failed = 0;
+    for (int c = 0; c < partition.count; c++) {
+        const char* chapter = partition.pools[c].chapitre;
+        size_t size = base_len + strlen(chapter) + 8;
+        char* filename = mem_alloc(MEM_GENERATOR, size);
+        if (!filename) {
+            failed++;
+            continue;
         }
-        
-        // Answer line
-        cairo_set_source_rgb(cr, 0.6, 0.6, 0.6);
-        cairo_move_to(cr, margin + 15, y);
-        cairo_show_text(cr, "Reponse : _____");
-        y += 25;
-        
-        // Separator
-        cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
-        cairo_set_line_width(cr, 0.5);
-        cairo_move_to(cr, margin, y);
-        cairo_line_to(cr, 595 - margin, y);
-        cairo_stroke(cr);
-        y += 20;
-    }
-    
-    if (nbExercice > 0) {
-        if (y > 600) { // Ensure enough space for exercise
-            cairo_show_page(cr);
-            y = margin;
+        // Le point final garantit que le nom du chapitre n'est pas pris pour une extension
+        snprintf(filename, size, "%.*s_%s.", base_len, output_filename, chapter);
+        for (char* p = filename + base_len; *p; ++p) {
+            if (*p == ' ') *p = '_';
         }
-        
-        y += 15;
-        cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, 14);
-        cairo_move_to(cr, margin, y);
-        cairo_show_text(cr, "PARTIE 2 : EXERCICE");
-        y += 20;
-        
-        cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
-        cairo_set_font_size(cr, 10);
-        snprintf(buffer, sizeof(buffer), "(%d point%s)", 
-                 points_per_exercice, points_per_exercice > 1 ? "s" : "");
-        cairo_move_to(cr, margin, y);
-        cairo_show_text(cr, buffer);
-        y += 25;
-        
-        Question q = db->questions[exercice_indices[0]];
-        
-        cairo_set_source_rgb(cr, 0, 0, 0);
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-        cairo_set_font_size(cr, 11);
-        snprintf(buffer, sizeof(buffer), "Exercice (%d points) :", points_per_exercice);
-        cairo_move_to(cr, margin, y);
-        cairo_show_text(cr, buffer);
-        y += 20;
-        
-        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
-        y = draw_wrapped_text(cr, q.enonce, margin + 5, y, page_width - 10, 16);
-        y += 25;
-        
-        cairo_set_source_rgb(cr, 0.6, 0.6, 0.6);
-        cairo_move_to(cr, margin + 5, y);
-        cairo_show_text(cr, "Reponse :");
-        y += 20;
-        
-        // Answer lines
-        for (int i = 0; i < 5; i++) {
-            if (y > 800) {
-                cairo_show_page(cr);
-                y = margin;
-            }
-            cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
-            cairo_set_line_width(cr, 0.5);
-            cairo_move_to(cr, margin + 5, y);
-            cairo_line_to(cr, 595 - margin - 5, y);
-            cairo_stroke(cr);
-            y += 25;
+        if (write_exam_files(db, request, &partition.pools[c], NULL, filename, format) != GEN_OK) failed++;
+        mem_free(MEM_GENERATOR, filename);
+    }
+    free_chapter_partition(&partition);
+    return failed;
+}
+
+int generate_exam_to_sink(const Database* db, const char* matiere, const char* chapitre,
+                          ExamType exam_type, const char* format, OutputSink* sink) {
+    const Renderer* renderer = renderer_find(format);
+    if (!renderer) return GEN_ERROR_UNKNOWN_FORMAT;
+
+    ExamRequest request = {0};
+    request.matiere = matiere;
+    request.chapitre = chapitre;
+    request.exam_type = exam_type;
+    ExamOutput output = { renderer, sink };
+    return generate_exam_outputs(db, &request, &output, 1);
+}
+
+int generate_exam_outputs(const Database* db, const ExamRequest* request,
+                          const ExamOutput* outputs, int nb_outputs) {
+    ChapterPartition partition;
+    const char* chapitre = request->chapitre;
+    int nb_chapters = (chapitre == NULL || strcmp(chapitre, "") == 0) ? 0 : 1;
+
+    if (partition_by_chapter(db, request->matiere, &chapitre, nb_chapters, &partition) != GEN_OK) {
+        report_error(request, "Memoire insuffisante");
+        return GEN_ERROR_NO_MEMORY;
+    }
+    int result = generate_exam_from_pool(db, request, &partition.pools[0], outputs, nb_outputs);
+    free_chapter_partition(&partition);
+    return result;
+}
+
+// Ajoute la question à la liste si son énoncé n'y figure pas encore
+static int add_unique_candidate(int** indices, int* count, int* capacity, StringMap* seen,
+                                const char* enonce, int index) {
+    int inserted = string_map_put(seen, enonce, index);
+    if (inserted <= 0) return inserted;
+    if (*count >= *capacity) {
+        int new_capacity = (*capacity == 0) ? 16 : *capacity * 2;
+        int* p = mem_realloc(MEM_GENERATOR, *indices, new_capacity * sizeof(int));
+        if (!p) return -1;
+        *indices = p;
+        *capacity = new_capacity;
+    }
+    (*indices)[(*count)++] = index;
+    return 1;
+}
+
+// Vrai si le libellé which de q vaut text. *id retient l'indice du libellé dès qu'une question
+// le porte : un texte n'a qu'un indice dans la table de la base, les questions suivantes se
+// comparent sans lire leur chaîne. Une question isolée (libellé dans son bloc) est comparée
+// sur son texte.
+static int label_matches(const Database* db, const Question* q, QuestionLabel which, const char* text, int* id) {
+    int label = q->labels[which];
+    if (label != QUESTION_LABEL_INLINE && *id >= 0) return label == *id;
+    if (strcmp(question_label(db->labels, q, which), text) != 0) return 0;
+    if (label != QUESTION_LABEL_INLINE) *id = label;
+    return 1;
+}
+
+int partition_by_chapter(const Database* db, const char* matiere,
+                         const char* const* chapters, int nb_chapters, ChapterPartition* out) {
+    uint64_t span = trace_begin();
+    PerfSample perf = perf_begin();
+    int nb_pools = (nb_chapters > 0) ? nb_chapters : 1;
+    out->count = nb_pools;
+    out->pools = mem_calloc(MEM_GENERATOR, nb_pools, sizeof(ChapterPool));
+    StringMap* seen = mem_calloc(MEM_GENERATOR, 2 * nb_pools, sizeof(StringMap)); // Énoncés déjà retenus : QCM puis exercices
+    int* capacities = mem_calloc(MEM_GENERATOR, 2 * nb_pools, sizeof(int));
+    StringMap chapter_index;
+    string_map_init(&chapter_index);
+    int error = (!out->pools || !seen || !capacities);
+
+    for (int c = 0; c < nb_chapters && !error; c++) {
+        out->pools[c].chapitre = chapters[c];
+        if (string_map_put(&chapter_index, chapters[c], c) < 0) error = 1;
+    }
+    if (nb_chapters == 0 && !error) out->pools[0].chapitre = "";
+
+    // Un seul parcours de la base, quel que soit le nombre de chapitres demandés
+    int matiere_id = -1, qcm_id = -1, exercice_id = -1;
+    for (int i = 0; i < db->count && !error; i++) {
+        const Question* q = &db->questions[i];
+        if (!label_matches(db, q, QUESTION_MATIERE, matiere, &matiere_id)) continue;
+
+        int c = 0;
+        if (nb_chapters > 0 && !string_map_get(&chapter_index, question_chapitre(db, q), &c)) continue;
+
+        ChapterPool* pool = &out->pools[c];
+        int inserted = 0;
+        if (label_matches(db, q, QUESTION_TYPE, "QCM", &qcm_id)) {
+            inserted = add_unique_candidate(&pool->qcm_indices, &pool->nb_qcm, &capacities[2 * c],
+                                            &seen[2 * c], question_enonce(q), i);
+        } else if (label_matches(db, q, QUESTION_TYPE, "Exercice", &exercice_id)) {
+            inserted = add_unique_candidate(&pool->exercice_indices, &pool->nb_exercice, &capacities[2 * c + 1],
+                                            &seen[2 * c + 1], question_enonce(q), i);
         }
+        if (inserted < 0) error = 1;
     }
-    
-    // Footer
-    if (y > 750) {
-        cairo_show_page(cr);
-    }
-    
-    y = 800;
-    cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
-    cairo_rectangle(cr, 0, y, 595, 42);
-    cairo_fill(cr);
-    
-    cairo_set_source_rgb(cr, 1, 1, 1);
-    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
-    cairo_set_font_size(cr, 14);
-    cairo_move_to(cr, 200, y + 25);
-    cairo_show_text(cr, "FIN DE L'EPREUVE");
-    
-    cairo_destroy(cr);
-    cairo_surface_destroy(surface);
-}
-
-void generate_exam(const Database* db, const char* matiere, const char* chapitre, 
-                   ExamType exam_type, const char* output_filename, const char* format) {
-    const char* output_dir = "Epreuves_Generees";
-    mkdir(output_dir, 0777);
-    
-    char base_filename[256];
-    const char* dot = strrchr(output_filename, '.');
-    if (dot) {
-        size_t len = dot - output_filename;
-        strncpy(base_filename, output_filename, len);
-        base_filename[len] = '\0';
-    } else {
-        strcpy(base_filename, output_filename);
+
+    if (seen) {
+        for (int k = 0; k < 2 * nb_pools; k++) string_map_free(&seen[k]);
     }
-    
-    char full_path[512];
-    time_t now = time(NULL);
-    struct tm *t = localtime(&now);
-    char timestamp[64];
-    strftime(timestamp, sizeof(timestamp), "%Y%m%d_%H%M%S", t);
-    
-    const char* extension = (strcmp(format, "PDF") == 0) ? "pdf" : "txt";
-    snprintf(full_path, sizeof(full_path), "%s/%s_%s.%s", 
-             output_dir, base_filename, timestamp, extension);
-    
-    int* qcm_indices = malloc(db->count * sizeof(int));
-    int* exercice_indices = malloc(db->count * sizeof(int));
-    int cQCM = 0, cExercice = 0;
-
-    char** used_qcm_enonces = malloc(db->count * sizeof(char*));
-    char** used_exercice_enonces = malloc(db->count * sizeof(char*));
-    int used_qcm_count = 0;
-    int used_exercice_count = 0;
+    mem_free(MEM_GENERATOR, seen);
+    mem_free(MEM_GENERATOR, capacities);
+    string_map_free(&chapter_index);
+    perf_end(&perf, "partition_by_chapter");
+    trace_end(span, "partition_by_chapter");
 
-    int chapitre_is_optional = (chapitre == NULL || strcmp(chapitre, "") == 0);
+    if (error) {
+        free_chapter_partition(out);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    return GEN_OK;
+}
 
-    for (int i = 0; i < db->count; i++) {
-        int matiere_match = (strcmp(db->questions[i].matiere, matiere) == 0);
-        int chapitre_match = (chapitre_is_optional || strcmp(db->questions[i].chapitre, chapitre) == 0);
-
-        if (matiere_match && chapitre_match) {
-            if (strcmp(db->questions[i].type, "QCM") == 0) {
-                int is_duplicate = 0;
-                for (int j = 0; j < used_qcm_count; j++) {
-                    if (strcmp(db->questions[i].enonce, used_qcm_enonces[j]) == 0) {
-                        is_duplicate = 1;
-                        break;
-                    }
-                }
-                if (!is_duplicate) {
-                    qcm_indices[cQCM] = i;
-                    used_qcm_enonces[used_qcm_count] = db->questions[i].enonce;
-                    cQCM++;
-                    used_qcm_count++;
-                }
-            } else if (strcmp(db->questions[i].type, "Exercice") == 0) {
-                int is_duplicate = 0;
-                for (int j = 0; j < used_exercice_count; j++) {
-                    if (strcmp(db->questions[i].enonce, used_exercice_enonces[j]) == 0) {
-                        is_duplicate = 1;
-                        break;
-                    }
-                }
-                if (!is_duplicate) {
-                    exercice_indices[cExercice] = i;
-                    used_exercice_enonces[used_exercice_count] = db->questions[i].enonce;
-                    cExercice++;
-                    used_exercice_count++;
-                }
-            }
+void free_chapter_partition(ChapterPartition* partition) {
+    if (partition->pools) {
+        for (int c = 0; c < partition->count; c++) {
+            mem_free(MEM_GENERATOR, partition->pools[c].qcm_indices);
+            mem_free(MEM_GENERATOR, partition->pools[c].exercice_indices);
         }
     }
+    mem_free(MEM_GENERATOR, partition->pools);
+    partition->pools = NULL;
+    partition->count = 0;
+}
 
-    free(used_qcm_enonces);
-    free(used_exercice_enonces);
+// Ramène en tête de indices (déjà mélangé) jusqu'à wanted questions dont l'énoncé n'est
+// proche d'aucune question déjà retenue ; retourne le nombre trouvé. Le coût ne dépend
+// que du nombre de questions de l'épreuve, pas de la taille de la base.
+static int select_distinct(const Database* db, int* indices, int count, int wanted,
+                           const Question** chosen, int* nb_chosen) {
+    int found = 0;
+    for (int i = 0; i < count && found < wanted; i++) {
+        const Question* q = &db->questions[indices[i]];
+        int duplicate = 0;
+        for (int k = 0; k < *nb_chosen && !duplicate; k++) {
+            duplicate = minhash_matches(q->minhash, chosen[k]->minhash) >= NEAR_DUPLICATE_MIN_MATCHES;
+        }
+        if (duplicate) continue;
+        chosen[(*nb_chosen)++] = q;
+        int tmp = indices[found];
+        indices[found] = indices[i];
+        indices[i] = tmp;
+        found++;
+    }
+    return found;
+}
 
-    int nbQCM = 0, nbExercice = 0;
-    double points_per_qcm = 0;
-    int points_per_exercice = 0;
-    
+// Nombre de questions de chaque type et barème d'une épreuve
+static void exam_layout(ExamType exam_type, int* nbQCM, int* nbExercice,
+                        double* points_per_qcm, int* points_per_exercice) {
     if (exam_type == EXAM_TYPE_QCM_ONLY) {
-        nbQCM = 20;
-        nbExercice = 0;
-        points_per_qcm = 1.0;
+        *nbQCM = 20;
+        *nbExercice = 0;
+        *points_per_qcm = 1.0;
+        *points_per_exercice = 0;
     } else {
-        nbQCM = 10;
-        nbExercice = 1;
-        points_per_qcm = 0.5;
-        points_per_exercice = 15;
+        *nbQCM = 10;
+        *nbExercice = 1;
+        *points_per_qcm = 0.5;
+        *points_per_exercice = 15;
+    }
+}
+
+static int compose_exam(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                        const ExamOutput* outputs, int nb_outputs) {
+    const char* matiere = request->matiere;
+    const char* chapitre = pool->chapitre;
+    ExamType exam_type = request->exam_type;
+    int chapitre_is_optional = (chapitre == NULL || strcmp(chapitre, "") == 0);
+    int cQCM = pool->nb_qcm, cExercice = pool->nb_exercice;
+
+    int nbQCM, nbExercice, points_per_exercice;
+    double points_per_qcm;
+    exam_layout(exam_type, &nbQCM, &nbExercice, &points_per_qcm, &points_per_exercice);
+
+    const char* chapitre_label = chapitre_is_optional ? "(tous)" : chapitre;
+    GenerationReport* report = request->report;
+    if (report) {
+        report->nb_qcm_available = cQCM;
+        report->nb_exercice_available = cExercice;
+        report->nb_qcm_required = nbQCM;
+        report->nb_exercice_required = nbExercice;
+        report->message[0] = 0;
     }
 
     if (cQCM < nbQCM || (nbExercice > 0 && cExercice < nbExercice)) {
-        printf("\n=== ERREUR DE GENERATION ===\n");
-        printf("Pas assez de questions uniques dans la base de donnees pour generer l'epreuve.\n\n");
-        printf("Filtre applique :\n");
-        printf("  - Matiere: '%s'\n", matiere);
-        printf("  - Chapitre: '%s'\n", chapitre_is_optional ? "(tous)" : chapitre);
-        printf("\nQuestions uniques disponibles :\n");
-        printf("  - QCM disponibles: %d (requis: %d)\n", cQCM, nbQCM);
-        printf("  - Exercices disponibles: %d (requis: %d)\n", cExercice, nbExercice);
-        printf("\nVeuillez ajouter plus de questions uniques pour cette matiere dans la base de donnees.\n");
-        printf("============================\n\n");
-        free(qcm_indices);
-        free(exercice_indices);
-        return;
-    }
-
-    shuffle(qcm_indices, cQCM);
-    shuffle(exercice_indices, cExercice);
-
-    if (strcmp(format, "PDF") == 0) {
-        generate_exam_pdf(db, matiere, chapitre, exam_type, full_path,
-                         qcm_indices, exercice_indices, nbQCM, nbExercice,
-                         points_per_qcm, points_per_exercice);
-    } else {
-        // TXT generation code
-        FILE *f = fopen(full_path, "w");
-        if (!f) {
-            perror("Impossible de creer le fichier d'examen");
-            free(qcm_indices);
-            free(exercice_indices);
-            return;
+        report_error(request, "Pas assez de questions uniques pour '%s' / '%s' : %d QCM (requis : %d), "
+                     "%d exercices (requis : %d)", matiere, chapitre_label, cQCM, nbQCM, cExercice, nbExercice);
+        return GEN_ERROR_NOT_ENOUGH_QUESTIONS;
+    }
+
+    // Copie locale : la partition reste intacte pour les variantes suivantes
+    int* qcm_indices = mem_alloc(MEM_GENERATOR, (cQCM + cExercice + 1) * sizeof(int));
+    if (!qcm_indices) {
+        report_error(request, "Memoire insuffisante");
+        return GEN_ERROR_NO_MEMORY;
+    }
+    int* exercice_indices = qcm_indices + cQCM;
+    if (cQCM > 0) memcpy(qcm_indices, pool->qcm_indices, cQCM * sizeof(int));
+    if (cExercice > 0) memcpy(exercice_indices, pool->exercice_indices, cExercice * sizeof(int));
+
+    uint64_t span = trace_begin();
+    PerfSample perf = perf_begin();
+    uint64_t state = request->seeded ? request->seed : fresh_seed();
+    shuffle(qcm_indices, cQCM, &state);
+    shuffle(exercice_indices, cExercice, &state);
+    perf_end(&perf, "shuffle");
+    trace_end(span, "shuffle");
+
+    if (request->avoid_near_duplicates) {
+        const Question* chosen[GENERATOR_MAX_QUESTIONS];
+        int nb_chosen = 0;
+        span = trace_begin();
+        perf = perf_begin();
+        int found_qcm = select_distinct(db, qcm_indices, cQCM, nbQCM, chosen, &nb_chosen);
+        int found_exercice = select_distinct(db, exercice_indices, cExercice, nbExercice, chosen, &nb_chosen);
+        perf_end(&perf, "select_distinct");
+        trace_end(span, "select_distinct");
+        if (report) {
+            report->nb_qcm_available = found_qcm;
+            report->nb_exercice_available = found_exercice;
+        }
+        if (found_qcm < nbQCM || found_exercice < nbExercice) {
+            report_error(request, "Pas assez de questions distinctes (hors quasi-doublons) pour '%s' / '%s' : "
+                         "%d QCM (requis : %d), %d exercices (requis : %d)",
+                         matiere, chapitre_label, found_qcm, nbQCM, found_exercice, nbExercice);
+            mem_free(MEM_GENERATOR, qcm_indices);
+            return GEN_ERROR_NOT_ENOUGH_QUESTIONS;
         }
+    }
+
+    ExamInfo info = {0};
+    info.matiere = matiere;
+    info.chapitre = chapitre_is_optional ? "Tous" : chapitre;
+    info.exam_type = exam_type;
+    info.nbQCM = nbQCM;
+    info.nbExercice = nbExercice;
+    info.points_per_qcm = points_per_qcm;
+    info.points_per_exercice = points_per_exercice;
+    local_time(time(NULL), &info.date);
+    for (int i = 0; i < nbQCM; i++) {
+        const Question* q = &db->questions[qcm_indices[i]];
+        info.text_size += strlen(question_enonce(q));
+        for (int j = 0; j < q->nbChoix; j++) info.text_size += q->choix[j].length;
+    }
+    for (int i = 0; i < nbExercice; i++) {
+        info.text_size += strlen(question_enonce(&db->questions[exercice_indices[i]]));
+    }
 
-        fprintf(f, "========================================\n");
-        fprintf(f, "       EPREUVE D'INGENIERIE INFORMATIQUE\n");
-        fprintf(f, "========================================\n\n");
-        fprintf(f, "Matiere : %s\n", matiere);
-        fprintf(f, "Chapitre : %s\n", chapitre_is_optional ? "Tous" : chapitre);
-        fprintf(f, "Type d'epreuve : %s\n", exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
-        fprintf(f, "Note totale : 20 points\n");
-        fprintf(f, "Date de generation : %02d/%02d/%04d %02d:%02d:%02d\n", 
-                t->tm_mday, t->tm_mon + 1, t->tm_year + 1900,
-                t->tm_hour, t->tm_min, t->tm_sec);
-        fprintf(f, "========================================\n\n");
-
-        int question_num = 1;
-        
-        fprintf(f, "PARTIE 1 : QUESTIONS A CHOIX MULTIPLES\n");
-        fprintf(f, "---------------------------------------\n");
-        fprintf(f, "(%d questions - %.1f point%s chacune)\n\n", nbQCM, points_per_qcm, points_per_qcm > 1 ? "s" : "");
-        
-        for (int i = 0; i < nbQCM; i++) {
-            Question q = db->questions[qcm_indices[i]];
-            fprintf(f, "Question %d (%.1f point%s) :\n", question_num++, points_per_qcm, points_per_qcm > 1 ? "s" : "");
-            fprintf(f, "%s\n\n", q.enonce);
-            for (int j = 0; j < q.nbChoix; j++) {
-                fprintf(f, "   %c) %s\n", 'A' + j, q.choix[j]);
+    // Une seule sélection alimente tous les rendus demandés
+    void* states[GENERATOR_MAX_OUTPUTS];
+    int ok[GENERATOR_MAX_OUTPUTS];
+    if (nb_outputs > GENERATOR_MAX_OUTPUTS) nb_outputs = GENERATOR_MAX_OUTPUTS;
+    span = trace_begin();
+    perf = perf_begin();
+    for (int k = 0; k < nb_outputs; k++) {
+        states[k] = outputs[k].renderer->begin_document(outputs[k].sink, &info);
+        ok[k] = (states[k] != NULL) && outputs[k].renderer->header(states[k]) == 0;
+    }
+    perf_end(&perf, "render_header");
+    trace_end(span, "render_header");
+
+    int total = nbQCM + nbExercice;
+    int cancelled = 0;
+    for (int i = 0; i < total && !cancelled; i++) {
+        int is_qcm = (i < nbQCM);
+        const Question* q = &db->questions[is_qcm ? qcm_indices[i] : exercice_indices[i - nbQCM]];
+        span = trace_begin();
+        perf = perf_begin();
+        for (int k = 0; k < nb_outputs; k++) {
+            if (!ok[k]) continue;
+            if (is_qcm) {
+                ok[k] = outputs[k].renderer->qcm(states[k], i + 1, q) == 0;
+            } else {
+                ok[k] = outputs[k].renderer->exercise(states[k], i - nbQCM + 1, q) == 0;
             }
-            fprintf(f, "\nReponse : _____\n\n");
-            fprintf(f, "---------------------------------------\n\n");
         }
+        perf_end(&perf, "render_question");
+        trace_end(span, "render_question");
+        if (request->progress && request->progress(request->progress_data, i + 1, total) != 0) {
+            cancelled = 1;
+        }
+    }
+
+    int result = GEN_OK;
+    span = trace_begin();
+    perf = perf_begin();
+    for (int k = 0; k < nb_outputs; k++) {
+        if (cancelled) ok[k] = 0;
+        if (states[k] && outputs[k].renderer->end_document(states[k], ok[k]) != 0) ok[k] = 0;
+        if (output_sink_close(outputs[k].sink) != 0) ok[k] = 0;
+        if (!ok[k]) result = GEN_ERROR_IO;
+    }
+    perf_end(&perf, "render_end");
+    trace_end(span, "render_end");
+    if (cancelled) {
+        report_error(request, "Generation annulee");
+        result = GENERATOR_CANCELLED;
+    } else if (result != GEN_OK) {
+        report_error(request, "Erreur d'ecriture du document");
+    }
+
+    mem_free(MEM_GENERATOR, qcm_indices);
+    return result;
+}
+
+int generate_exam_from_pool(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                            const ExamOutput* outputs, int nb_outputs) {
+    uint64_t span = trace_begin();
+    PerfSample perf = perf_begin();
+    int result = compose_exam(db, request, pool, outputs, nb_outputs);
+    perf_end(&perf, "generate_exam");
+    trace_end(span, "generate_exam");
+    return result;
+}
+
+// --- Génération en flux ---
+
+// Un candidat retenu par le parcours du fichier, avec sa priorité de tirage
+typedef struct {
+    uint64_t priority;
+    Question question;
+} StreamCandidate;
 
-        if (nbExercice > 0) {
-            fprintf(f, "\nPARTIE 2 : EXERCICE\n");
-            fprintf(f, "---------------------------------------\n");
-            fprintf(f, "(%d point%s)\n\n", points_per_exercice, points_per_exercice > 1 ? "s" : "");
-            
-            Question q = db->questions[exercice_indices[0]];
-            fprintf(f, "Exercice (%d points) :\n", points_per_exercice);
-            fprintf(f, "%s\n\n", q.enonce);
-            fprintf(f, "Reponse :\n");
-            fprintf(f, "____________________________________________________________\n\n");
-            fprintf(f, "____________________________________________________________\n\n");
-            fprintf(f, "____________________________________________________________\n\n");
-            fprintf(f, "____________________________________________________________\n\n");
-            fprintf(f, "____________________________________________________________\n\n");
+// Échantillon d'un type de questions : les capacity énoncés distincts de plus petite priorité.
+// La priorité est un hachage de l'énoncé mélangé à la graine : un énoncé répété garde la même
+// priorité et ne compte qu'une fois (comme dans partition_by_chapter), et l'échantillon est
+// uniforme parmi les énoncés distincts, quel que soit l'ordre des lignes.
+typedef struct {
+    StreamCandidate* items;  // Tas max sur la priorité : la racine est la première remplacée
+    int count;
+    int capacity;
+} Reservoir;
+
+static int reservoir_init(Reservoir* reservoir, int capacity) {
+    reservoir->count = 0;
+    reservoir->capacity = capacity;
+    reservoir->items = NULL;
+    if (capacity == 0) return GEN_OK;
+    reservoir->items = mem_alloc(MEM_GENERATOR, capacity * sizeof(StreamCandidate));
+    return reservoir->items ? GEN_OK : GEN_ERROR_NO_MEMORY;
+}
+
+static void reservoir_free(Reservoir* reservoir) {
+    for (int i = 0; i < reservoir->count; i++) {
+        free_question_content(&reservoir->items[i].question);
+    }
+    mem_free(MEM_GENERATOR, reservoir->items);
+    reservoir->items = NULL;
+    reservoir->count = 0;
+}
+
+static void reservoir_swap(Reservoir* reservoir, int a, int b) {
+    StreamCandidate tmp = reservoir->items[a];
+    reservoir->items[a] = reservoir->items[b];
+    reservoir->items[b] = tmp;
+}
+
+static void reservoir_sift_up(Reservoir* reservoir, int i) {
+    while (i > 0 && reservoir->items[(i - 1) / 2].priority < reservoir->items[i].priority) {
+        reservoir_swap(reservoir, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+}
+
+static void reservoir_sift_down(Reservoir* reservoir, int i) {
+    for (;;) {
+        int largest = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < reservoir->count && reservoir->items[left].priority > reservoir->items[largest].priority) largest = left;
+        if (right < reservoir->count && reservoir->items[right].priority > reservoir->items[largest].priority) largest = right;
+        if (largest == i) return;
+        reservoir_swap(reservoir, i, largest);
+        i = largest;
+    }
+}
+
+// Propose la ligne (énoncé enonce) : elle n'est analysée que si elle entre dans l'échantillon
+static int reservoir_offer(Reservoir* reservoir, uint64_t priority, const char* enonce, const char* line,
+                           DatabaseFormat format) {
+    if (reservoir->capacity == 0) return GEN_OK;
+    if (reservoir->count == reservoir->capacity && priority >= reservoir->items[0].priority) return GEN_OK;
+    for (int i = 0; i < reservoir->count; i++) {
+        const StreamCandidate* item = &reservoir->items[i];
+        if (item->priority == priority && strcmp(question_enonce(&item->question), enonce) == 0) return GEN_OK;
+    }
+
+    Question q;
+    int parsed = parse_question_line(line, format, &q);
+    if (parsed <= 0) return parsed; // 0 : ligne invalide, ignorée comme au chargement
+    if (reservoir->count < reservoir->capacity) {
+        reservoir->items[reservoir->count].priority = priority;
+        reservoir->items[reservoir->count].question = q;
+        reservoir_sift_up(reservoir, reservoir->count++);
+    } else {
+        free_question_content(&reservoir->items[0].question);
+        reservoir->items[0].priority = priority;
+        reservoir->items[0].question = q;
+        reservoir_sift_down(reservoir, 0);
+    }
+    return GEN_OK;
+}
+
+// Fichier à lire pour la matière : bank_path, ou le fichier de la matière dans une base
+// découpée (*path NULL si elle n'y figure pas ou si son fichier est absent). Retourne GEN_OK ou un code d'erreur.
+static int stream_source(const char* bank_path, const char* matiere, char** path) {
+    *path = NULL;
+    if (storage_find(bank_path) != &STORAGE_TEXT) return GEN_ERROR_UNKNOWN_FORMAT; // Lu par load_database
+    if (!bank_shards_is_directory(bank_path)) {
+        *path = mem_strdup(MEM_GENERATOR, bank_path);
+        return *path ? GEN_OK : GEN_ERROR_NO_MEMORY;
+    }
+    Database manifest = {0};
+    int status = bank_shards_open(&manifest, bank_path);
+    const BankShard* shard = (status == GEN_OK) ? bank_shards_find(&manifest, matiere) : NULL;
+    if (shard) {
+        size_t size = strlen(bank_path) + strlen(shard->file) + 2;
+        *path = mem_alloc(MEM_GENERATOR, size);
+        if (*path) snprintf(*path, size, "%s/%s", bank_path, shard->file);
+        else status = GEN_ERROR_NO_MEMORY;
+        struct stat st;
+        if (*path && stat(*path, &st) != 0 && errno == ENOENT) {
+            mem_free(MEM_GENERATOR, *path); // Fichier absent : matière vide, comme bank_shards_load
+            *path = NULL;
         }
+    }
+    free_database(&manifest);
+    return status;
+}
+
+// Un seul parcours du fichier, par morceaux de DATABASE_LINE_MAX comme load_database :
+// seules les lignes qui entrent dans un échantillon sont analysées
+static int stream_candidates(FILE* f, const ExamRequest* request, uint64_t key,
+                             Reservoir* qcm, Reservoir* exercices) {
+    char line[DATABASE_LINE_MAX];
+    char line_copy[DATABASE_LINE_MAX];
+    char* tokens[7];
+    int all_chapters = (request->chapitre == NULL || strcmp(request->chapitre, "") == 0);
+    int status = GEN_OK;
+    DatabaseFormat format = DATABASE_FORMAT_PLAIN;
+    for (int n = 0; status == GEN_OK && fgets(line, sizeof(line), f); n++) {
+        if (n == 0) format = database_file_format(line);
+        if (split_question_line(line, format, line_copy, tokens) < 6) continue;
+        if (strcmp(tokens[0], request->matiere) != 0) continue;
+        if (!all_chapters && strcmp(tokens[1], request->chapitre) != 0) continue;
 
-        fprintf(f, "\n========================================\n");
-        fprintf(f, "              FIN DE L'EPREUVE\n");
-        fprintf(f, "========================================\n");
+        Reservoir* reservoir = (strcmp(tokens[2], "QCM") == 0) ? qcm
+                             : (strcmp(tokens[2], "Exercice") == 0) ? exercices : NULL;
+        if (!reservoir) continue;
+        uint64_t priority = generator_mix_seed(hash_string(tokens[3]) ^ key);
+        status = reservoir_offer(reservoir, priority, tokens[3], line, format);
+    }
+    if (status == GEN_OK && ferror(f)) status = GEN_ERROR_IO;
+    return status;
+}
 
+static int compare_priority(const void* a, const void* b) {
+    uint64_t x = ((const StreamCandidate*)a)->priority, y = ((const StreamCandidate*)b)->priority;
+    return (x > y) - (x < y);
+}
+
+// Compose l'épreuve à partir des deux échantillons, rangés dans une petite base de passage
+static int compose_from_reservoirs(const ExamRequest* request, Reservoir* qcm, Reservoir* exercices,
+                                   const ExamOutput* outputs, int nb_outputs) {
+    int total = qcm->count + exercices->count;
+    Question* questions = mem_alloc(MEM_GENERATOR, (total + 1) * sizeof(Question));
+    int* indices = mem_alloc(MEM_GENERATOR, (total + 1) * sizeof(int));
+    if (!questions || !indices) {
+        mem_free(MEM_GENERATOR, questions);
+        mem_free(MEM_GENERATOR, indices);
+        report_error(request, "Memoire insuffisante");
+        return GEN_ERROR_NO_MEMORY;
+    }
+
+    // Rangés par priorité : le mélange qui suit ne dépend que de l'échantillon et de la graine
+    if (qcm->count > 0) qsort(qcm->items, qcm->count, sizeof(StreamCandidate), compare_priority);
+    if (exercices->count > 0) qsort(exercices->items, exercices->count, sizeof(StreamCandidate), compare_priority);
+    for (int i = 0; i < qcm->count; i++) questions[i] = qcm->items[i].question;
+    for (int i = 0; i < exercices->count; i++) questions[qcm->count + i] = exercices->items[i].question;
+    for (int i = 0; i < total; i++) indices[i] = i;
+
+    Database view = {0};
+    view.questions = questions;
+    view.count = view.capacity = total;
+    ChapterPool pool = { request->chapitre ? request->chapitre : "", indices, qcm->count,
+                         indices + qcm->count, exercices->count };
+    int result = compose_exam(&view, request, &pool, outputs, nb_outputs);
+    mem_free(MEM_GENERATOR, questions);
+    mem_free(MEM_GENERATOR, indices);
+    return result;
+}
+
+int generate_exam_stream(const char* bank_path, const ExamRequest* request,
+                         const ExamOutput* outputs, int nb_outputs) {
+    uint64_t span = trace_begin();
+    PerfSample perf = perf_begin();
+    int nbQCM, nbExercice, points_per_exercice;
+    double points_per_qcm;
+    exam_layout(request->exam_type, &nbQCM, &nbExercice, &points_per_qcm, &points_per_exercice);
+    int spare = request->avoid_near_duplicates ? STREAM_NEAR_DUPLICATE_SPARE : 1;
+
+    Reservoir qcm, exercices;
+    char* path = NULL;
+    int result = GEN_OK;
+    if (reservoir_init(&qcm, nbQCM * spare) != GEN_OK || reservoir_init(&exercices, nbExercice * spare) != GEN_OK) {
+        result = GEN_ERROR_NO_MEMORY;
+    }
+    if (result == GEN_OK) result = stream_source(bank_path, request->matiere, &path);
+
+    // Clé de tirage propre au parcours ; le mélange de compose_exam repart de la graine
+    uint64_t key = generator_mix_seed((request->seeded ? request->seed : fresh_seed()) ^ 0x5EEDULL);
+    FILE* f = path ? fopen(path, "r") : NULL;
+    if (result == GEN_OK && path && !f) result = GEN_ERROR_IO;
+    if (f) {
+        uint64_t scan = trace_begin();
+        result = stream_candidates(f, request, key, &qcm, &exercices);
+        trace_end(scan, "stream_candidates");
         fclose(f);
     }
 
-    free(qcm_indices);
-    free(exercice_indices);
-    
-    printf("\n=== EPREUVE GENEREE AVEC SUCCES ===\n");
-    printf("Fichier : %s\n", full_path);
-    printf("Format : %s\n", extension);
-    printf("Type : %s\n", exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement (20 questions)" : "Mixte (10 QCM + 1 Exercice)");
-    printf("===================================\n\n");
+    if (result == GEN_OK) {
+        result = compose_from_reservoirs(request, &qcm, &exercices, outputs, nb_outputs);
+    } else if (result == GEN_ERROR_IO) {
+        report_error(request, "Impossible de lire la base '%s'", bank_path);
+    } else if (result == GEN_ERROR_UNKNOWN_FORMAT) {
+        report_error(request, "La generation en flux ne lit que les bases texte ('%s')", bank_path);
+    } else {
+        report_error(request, "Memoire insuffisante");
+    }
+    reservoir_free(&qcm);
+    reservoir_free(&exercices);
+    mem_free(MEM_GENERATOR, path);
+    perf_end(&perf, "generate_exam_stream");
+    trace_end(span, "generate_exam_stream");
+    return result;
 }
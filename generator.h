@@ -2,9 +2,133 @@
 #ifndef GENERATOR_H
 #define GENERATOR_H
 
+#include <stdint.h>
 #include "structures.h"
+#include "gen_status.h"
+#include "output_sink.h"
+#include "renderer.h"
 
-void generate_exam(const Database* db, const char* matiere, const char* chapitre, 
-                   ExamType exam_type, const char* output_filename, const char* format);
+// Nombre maximal de formats produits en une seule passe
+#define GENERATOR_MAX_OUTPUTS 8
+
+// Code retourné quand la fonction de progression demande l'arrêt
+#define GENERATOR_CANCELLED GEN_CANCELLED
+
+// Longueur maximale d'un chemin de fichier produit, et dossier de sortie par défaut
+#define GENERATOR_MAX_PATH 512
+#define GENERATOR_OUTPUT_DIR "Epreuves_Generees"
+
+// Appelée après chaque question rendue ; retourner une valeur non nulle annule la génération
+typedef int (*GenerationProgressFunc)(void* user_data, int done, int total);
+
+// Compte rendu d'une génération, rempli quel que soit le résultat : la bibliothèque
+// n'affiche rien, c'est à l'appelant de présenter le succès ou l'erreur.
+typedef struct {
+    int nb_qcm_available;             // Candidats uniques trouvés (après filtrage des quasi-doublons
+    int nb_exercice_available;        // si demandé)
+    int nb_qcm_required;
+    int nb_exercice_required;
+    int nb_files;                     // Fichiers écrits (generate_exam_files*)
+    char files[GENERATOR_MAX_OUTPUTS][GENERATOR_MAX_PATH];
+    char message[256];                // Description de l'erreur, vide en cas de succès
+} GenerationReport;
+
+// Paramètres de sélection d'une épreuve.
+// Aucune fonction du générateur ne touche à un état global : plusieurs threads peuvent
+// produire des épreuves en même temps à partir de la même base (non modifiée entre-temps).
+typedef struct {
+    const char* matiere;
+    const char* chapitre;    // NULL ou "" pour tous les chapitres
+    ExamType exam_type;
+    GenerationProgressFunc progress;  // Optionnel
+    void* progress_data;
+    int avoid_near_duplicates;        // Non nul : pas deux énoncés quasi identiques (minhash.h) dans l'épreuve
+    int seeded;                       // Non nul : tirage reproductible à partir de seed,
+    uint64_t seed;                    // sinon graine nouvelle à chaque épreuve
+    const char* output_dir;           // NULL : GENERATOR_OUTPUT_DIR (generate_exam_files*)
+    GenerationReport* report;         // Optionnel
+} ExamRequest;
+
+// Un format de sortie et sa destination
+typedef struct {
+    const Renderer* renderer;
+    OutputSink* sink;
+} ExamOutput;
+
+// Mélange les bits d'une graine (finaliseur de splitmix64) : deux valeurs voisines donnent
+// des graines sans rapport, pour dériver la graine de chaque épreuve d'une graine commune.
+uint64_t generator_mix_seed(uint64_t value);
+
+// Génère l'épreuve dans Epreuves_Generees/<nom>_<horodatage>.<ext>.
+// format peut lister plusieurs formats ("PDF,HTML") : un fichier par format, une seule sélection.
+// Retourne GEN_OK ou un code d'erreur GenStatus.
+int generate_exam(const Database* db, const char* matiere, const char* chapitre, 
+                  ExamType exam_type, const char* output_filename, const char* format);
+
+// Variante de generate_exam() qui accepte une requête complète (progression, annulation,
+// compte rendu). Retourne GEN_OK, GENERATOR_CANCELLED ou un code d'erreur ; les fichiers
+// incomplets sont supprimés.
+int generate_exam_files(const Database* db, const ExamRequest* request,
+                        const char* output_filename, const char* format);
+
+// Génère l'épreuve vers une destination quelconque (fichier, mémoire, descripteur, callback).
+// Retourne GEN_OK ou un code d'erreur GenStatus.
+int generate_exam_to_sink(const Database* db, const char* matiere, const char* chapitre,
+                          ExamType exam_type, const char* format, OutputSink* sink);
+
+// Sélectionne les questions une seule fois et alimente chaque rendu de la liste.
+// Retourne GEN_OK si toutes les sorties ont été produites, GENERATOR_CANCELLED si annulé,
+// GEN_ERROR_NOT_ENOUGH_QUESTIONS si la base ne suffit pas, un autre code d'erreur sinon.
+int generate_exam_outputs(const Database* db, const ExamRequest* request,
+                          const ExamOutput* outputs, int nb_outputs);
+
+// Candidats d'une matière pour un chapitre : indices des QCM et exercices uniques (par énoncé)
+typedef struct {
+    const char* chapitre;    // "" pour la partition "tous les chapitres"
+    int* qcm_indices;
+    int nb_qcm;
+    int* exercice_indices;
+    int nb_exercice;
+} ChapterPool;
+
+typedef struct {
+    ChapterPool* pools;      // Une partition par chapitre demandé, dans l'ordre donné
+    int count;
+} ChapterPartition;
+
+// Répartit les questions de la matière entre les chapitres en un seul parcours de la base.
+// Avec nb_chapters == 0, une seule partition regroupe tous les chapitres.
+// Les chaînes de chapters doivent rester valides tant que la partition est utilisée.
+// Retourne GEN_OK ou GEN_ERROR_NO_MEMORY.
+int partition_by_chapter(const Database* db, const char* matiere,
+                         const char* const* chapters, int nb_chapters, ChapterPartition* out);
+void free_chapter_partition(ChapterPartition* partition);
+
+// Produit une épreuve à partir d'une partition déjà calculée (réutilisable pour
+// plusieurs chapitres et variantes). request->chapitre est ignoré.
+int generate_exam_from_pool(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                            const ExamOutput* outputs, int nb_outputs);
+int generate_exam_files_from_pool(const Database* db, const ExamRequest* request, const ChapterPool* pool,
+                                  const char* output_filename, const char* format);
+
+// Génération en flux, sans charger la base : bank_path (fichier de questions ou base
+// découpée, dont seul le fichier de la matière est lu) est parcouru une seule fois et seuls
+// les candidats tirés au sort sont gardés en mémoire, quelques dizaines au plus quelle que
+// soit la taille de la base. Le tirage est uniforme parmi les énoncés distincts et
+// reproductible avec request->seeded (mais différent de celui de generate_exam_outputs).
+// Dans le compte rendu, les questions disponibles sont bornées par la taille de l'échantillon.
+// Retourne GEN_OK, GEN_ERROR_IO (base illisible), GEN_ERROR_UNKNOWN_FORMAT (base SQLite, à
+// charger avec load_database) ou un code d'erreur comme generate_exam_outputs.
+int generate_exam_stream(const char* bank_path, const ExamRequest* request,
+                         const ExamOutput* outputs, int nb_outputs);
+int generate_exam_files_stream(const char* bank_path, const ExamRequest* request,
+                               const char* output_filename, const char* format);
+
+// Une épreuve par chapitre, nommée <nom>_<chapitre>, avec un seul parcours de la base.
+// Retourne le nombre d'épreuves qui n'ont pas pu être produites (0 si tout a réussi) ;
+// request->report décrit la dernière épreuve tentée.
+int generate_exams_by_chapter(const Database* db, const ExamRequest* request,
+                              const char* const* chapters, int nb_chapters,
+                              const char* output_filename, const char* format);
 
 #endif
@@ -1,15 +1,38 @@
 // gui_main.c - Modern GTK4 Interface for Exam Generator
 #include <gtk/gtk.h>
+#include <glib-unix.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include "structures.h"
 #include "database.h"
+#include "bank_watch.h"
+#include "bank_shards.h"
 #include "generator.h"
+#include "renderer.h"
+#include "question_model.h"
+#include "search_index.h"
+#include "snapshot.h"
+#include "mem_track.h"
+#include "perf_counters.h"
+#include "trace.h"
 
 #define DB_FILE "questions.txt"
+#define DB_SHARDS_DIR "questions"      // Base découpée par matière (bank_shards.h), utilisée si elle existe
+#define DB_SQLITE_FILE "questions.db"  // Base SQLite (storage.h), utilisée si elle existe et si SQLite est compilé
 #define PASSWORD "12345"
+#define LOAD_BATCH_SIZE 512
+
+// Formats proposés dans la boîte de génération (même ordre que la liste déroulante)
+static const char* OUTPUT_FORMAT_LABELS[] = {
+    "Fichier Texte (.txt)",
+    "Document PDF (.pdf)",
+    "Page Web (.html)",
+    "Markdown (.md)",
+    "PDF pour impression + HTML pour la plateforme",
+    NULL
+};
+static const char* OUTPUT_FORMAT_CODES[] = { "TXT", "PDF", "HTML", "MD", "PDF,HTML" };
 
 static const char* COMPUTER_ENGINEERING_SUBJECTS[] = {
     "Programmation",
@@ -29,14 +52,47 @@ static const char* COMPUTER_ENGINEERING_SUBJECTS[] = {
     NULL
 };
 
+// Chargement de la base en arrière-plan : le thread analyse le fichier par lots,
+// le thread GTK ajoute les lots à la base à chaque tick.
+typedef struct {
+    GThread *thread;
+    GMutex lock;
+    Question *pending;        // Questions analysées pas encore ajoutées (protégé par lock)
+    int nb_pending;
+    int pending_capacity;
+    gint64 bytes_read;        // Avancement dans le fichier (protégé par lock)
+    gint64 file_size;
+    gint finished;            // Atomiques
+    gint cancelled;
+    guint tick_source;
+} BankLoader;
+
 typedef struct {
     Database db;
+    const char *db_path;           // DB_SHARDS_DIR ou DB_FILE
+    SnapshotPublisher snapshots;   // Versions figées de db pour les threads de génération
+    BankLoader loader;
+    gboolean loading;              // Ajout, modification, suppression et génération bloqués jusqu'à la fin
+    BankWatch watch;               // Modifications de DB_FILE par un autre programme, après le chargement
+    gboolean watching;
+    guint watch_source;
+    guint reload_source;           // Relecture différée de BANK_WATCH_DELAY_MS après le dernier événement
     GtkWidget *main_window;
     GtkWidget *stack;
     GtkWidget *list_view;
+    QuestionListModel *question_model;
+    GtkSingleSelection *selection_model;
     GtkWidget *status_label;
     GtkWidget *count_label;
-    int selected_question_index;
+    GtkWidget *load_progress;
+    GtkWidget *login_progress;
+    GtkWidget *add_btn;
+    GtkWidget *edit_btn;
+    GtkWidget *delete_btn;
+    GtkWidget *generate_btn;
+    GtkWidget *search_entry;
+    SearchIndex search_index;      // Construit à la première recherche, puis tenu à jour par la base
+    gboolean search_index_ready;
     GtkWidget *login_window;
     GtkApplication *gtk_app;
 } AppData;
@@ -47,8 +103,32 @@ typedef struct {
     int count;
 } ChapterSelection;
 
+// Lot d'épreuves généré hors du thread GTK, sur un instantané de la base : les
+// modifications faites pendant l'exécution ne le concernent pas (snapshot.h).
+typedef struct {
+    AppData *app;
+    GtkWidget *dialog;
+    GtkWidget *progress_bar;
+    GtkWidget *generate_btn;
+    GtkWidget *cancel_btn;
+    GCancellable *cancellable;
+    guint progress_source;
+    char *subject;
+    char **chapters;          // Terminé par NULL ; "" = tous les chapitres
+    ExamType exam_type;
+    char *format;
+    char *base_filename;      // Sans extension
+    const char *extension;
+    int variants;
+    gboolean avoid_near_duplicates;
+    int total;                // Nombre d'épreuves à produire
+    gint done;                // Compteurs mis à jour par le thread de génération
+    gint failed;
+    gint exam_permille;       // Avancement de l'épreuve en cours (0-1000)
+    char last_error[256];     // Compte rendu du dernier échec, lu une fois le lot terminé
+} GenerationJob;
+
 static void show_notification(AppData *app, const char *message, const char *type);
-static void refresh_question_list(AppData *app);
 static void switch_to_view(AppData *app, const char *view_name);
 static void on_add_question_clicked(GtkWidget *button, gpointer user_data);
 static void on_delete_question_clicked(GtkWidget *button, gpointer user_data);
@@ -58,13 +138,27 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data);
 static void on_login_clicked(GtkWidget *button, gpointer user_data);
 static void show_login_window(GtkApplication *gtk_app, gpointer user_data);
 
-static char* my_strdup(const char* s) {
-    if (s == NULL) return NULL;
-    size_t len = strlen(s) + 1;
-    char* new_str = malloc(len);
-    if (new_str == NULL) return NULL;
-    memcpy(new_str, s, len);
-    return new_str;
+// Construit la question saisie dans le formulaire (choix séparés par '|'), notée sur 1 point
+static int question_from_form(Question *q, const char *subject, const char *chapter, const char *type,
+                              const char *question, const char *choices, const char *answer_str) {
+    const char *choice_list[QUESTION_MAX_CHOICES];
+    int nb_choices = 0;
+    int bonne_reponse = -1;
+    char *choices_copy = NULL;
+
+    if (strcmp(type, "QCM") == 0 && strlen(choices) > 0) {
+        choices_copy = g_strdup(choices);
+        char *token = strtok(choices_copy, "|");
+        while (token && nb_choices < QUESTION_MAX_CHOICES) {
+            choice_list[nb_choices++] = token;
+            token = strtok(NULL, "|");
+        }
+        bonne_reponse = atoi(answer_str) - 1;
+    }
+
+    int status = question_init(q, subject, chapter, type, question, choice_list, nb_choices, bonne_reponse, 1);
+    g_free(choices_copy);
+    return status;
 }
 
 static void show_notification(AppData *app, const char *message, const char *type) {
@@ -81,6 +175,21 @@ static void show_notification(AppData *app, const char *message, const char *typ
     }
 }
 
+// Enregistre la base après une modification réussie (status) et affiche le résultat
+static void save_and_notify(AppData *app, int status, const char *success_message) {
+    if (status == GEN_OK) status = save_database(&app->db, app->db_path);
+    if (status == GEN_OK && app->watching) bank_watch_rebase(&app->watch, &app->db); // Pas un changement extérieur
+    if (status == GEN_OK) {
+        show_notification(app, success_message, "success");
+    } else if (status == GEN_ERROR_IO) {
+        char message[256];
+        snprintf(message, sizeof(message), "Impossible d'enregistrer la base de questions dans '%s'", app->db_path);
+        show_notification(app, message, "error");
+    } else {
+        show_notification(app, gen_status_message(status), "error");
+    }
+}
+
 static void on_save_question_clicked(GtkWidget *btn, gpointer data) {
     gpointer *params = (gpointer *)data;
     AppData *app = (AppData *)params[0];
@@ -113,32 +222,12 @@ static void on_save_question_clicked(GtkWidget *btn, gpointer data) {
         return;
     }
 
-    Question q = {0};
-    q.matiere = my_strdup(subject);
-    q.chapitre = my_strdup(chapter);
-    q.type = my_strdup(type);
-    q.enonce = my_strdup(question);
-    q.points = 1; 
-
-    if (strcmp(type, "QCM") == 0 && strlen(choices) > 0) {
-        char *choices_copy = my_strdup(choices);
-        char *token = strtok(choices_copy, "|");
-        while (token) {
-            q.choix = realloc(q.choix, sizeof(char*) * (q.nbChoix + 1));
-            q.choix[q.nbChoix++] = my_strdup(token);
-            token = strtok(NULL, "|");
-        }
-        free(choices_copy);
-        q.bonneReponse = atoi(answer_str) - 1;
-    } else {
-        q.bonneReponse = -1;
-    }
-
-    add_question_to_db(&app->db, q);
-    save_database(&app->db, DB_FILE);
+    Question q;
+    int status = question_from_form(&q, subject, chapter, type, question, choices, answer_str);
 
-    show_notification(app, "Question ajoutée avec succès", "success");
-    refresh_question_list(app);
+    if (status == GEN_OK) status = add_question_to_db(&app->db, q);
+    if (status != GEN_OK) free_question_content(&q);
+    save_and_notify(app, status, "Question ajoutée avec succès");
 
     if (app->count_label) {
         char count_text[100];
@@ -255,16 +344,20 @@ static void on_add_question_clicked(GtkWidget *button, gpointer user_data) {
     gtk_window_present(GTK_WINDOW(dialog));
 }
 
+// Index dans la base de la question sélectionnée (la liste peut être filtrée), ou -1
+static int get_selected_question_index(AppData *app) {
+    guint position = gtk_single_selection_get_selected(app->selection_model);
+    if (position == GTK_INVALID_LIST_POSITION) return -1;
+    return question_list_model_get_index(app->question_model, position);
+}
+
 static void on_delete_response(GtkAlertDialog *dialog, GAsyncResult *result, gpointer data) {
     AppData *app = (AppData *)data;
     int response = gtk_alert_dialog_choose_finish(dialog, result, NULL);
+    int index = get_selected_question_index(app);
 
-    if (response == 0) {
-        delete_question_from_db(&app->db, app->selected_question_index);
-        save_database(&app->db, DB_FILE);
-        app->selected_question_index = -1;
-        show_notification(app, "Question supprimée avec succès", "success");
-        refresh_question_list(app);
+    if (response == 0 && index >= 0) {
+        save_and_notify(app, delete_question_from_db(&app->db, index), "Question supprimée avec succès");
 
         if (app->count_label) {
             char count_text[100];
@@ -277,7 +370,7 @@ static void on_delete_response(GtkAlertDialog *dialog, GAsyncResult *result, gpo
 static void on_delete_question_clicked(GtkWidget *button, gpointer user_data) {
     AppData *app = (AppData *)user_data;
 
-    if (app->selected_question_index < 0 || app->selected_question_index >= app->db.count) {
+    if (get_selected_question_index(app) < 0) {
         show_notification(app, "Veuillez sélectionner une question à supprimer", "error");
         return;
     }
@@ -295,12 +388,13 @@ static void on_delete_question_clicked(GtkWidget *button, gpointer user_data) {
 static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     AppData *app = (AppData *)user_data;
 
-    if (app->selected_question_index < 0 || app->selected_question_index >= app->db.count) {
+    int selected_index = get_selected_question_index(app);
+    if (selected_index < 0) {
         show_notification(app, "Veuillez sélectionner une question à modifier", "error");
         return;
     }
 
-    Question q = app->db.questions[app->selected_question_index];
+    Question q = app->db.questions[selected_index];
 
     GtkWidget *dialog = gtk_window_new();
     gtk_window_set_title(GTK_WINDOW(dialog), "Modifier la Question");
@@ -328,7 +422,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     
     // Find and set current subject
     for (int i = 0; COMPUTER_ENGINEERING_SUBJECTS[i] != NULL; i++) {
-        if (strcmp(COMPUTER_ENGINEERING_SUBJECTS[i], q.matiere) == 0) {
+        if (strcmp(COMPUTER_ENGINEERING_SUBJECTS[i], question_matiere(&app->db, &q)) == 0) {
             gtk_drop_down_set_selected(GTK_DROP_DOWN(subject_dropdown), i);
             break;
         }
@@ -343,7 +437,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     GtkWidget *chapter_label = gtk_label_new("Chapitre");
     gtk_widget_set_halign(chapter_label, GTK_ALIGN_START);
     GtkWidget *chapter_entry = gtk_entry_new();
-    gtk_editable_set_text(GTK_EDITABLE(chapter_entry), q.chapitre);
+    gtk_editable_set_text(GTK_EDITABLE(chapter_entry), question_chapitre(&app->db, &q));
     gtk_box_append(GTK_BOX(chapter_box), chapter_label);
     gtk_box_append(GTK_BOX(chapter_box), chapter_entry);
     gtk_box_append(GTK_BOX(box), chapter_box);
@@ -353,7 +447,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     GtkWidget *type_label = gtk_label_new("Type de Question");
     gtk_widget_set_halign(type_label, GTK_ALIGN_START);
     GtkWidget *type_dropdown = gtk_drop_down_new_from_strings((const char *[]){"QCM", "Exercice", NULL});
-    gtk_drop_down_set_selected(GTK_DROP_DOWN(type_dropdown), strcmp(q.type, "QCM") == 0 ? 0 : 1);
+    gtk_drop_down_set_selected(GTK_DROP_DOWN(type_dropdown), strcmp(question_type(&app->db, &q), "QCM") == 0 ? 0 : 1);
     gtk_box_append(GTK_BOX(type_box), type_label);
     gtk_box_append(GTK_BOX(type_box), type_dropdown);
     gtk_box_append(GTK_BOX(box), type_box);
@@ -365,7 +459,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     GtkWidget *question_text = gtk_text_view_new();
     gtk_text_view_set_wrap_mode(GTK_TEXT_VIEW(question_text), GTK_WRAP_WORD);
     GtkTextBuffer *buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(question_text));
-    gtk_text_buffer_set_text(buffer, q.enonce, -1);
+    gtk_text_buffer_set_text(buffer, question_enonce(&q), -1);
     GtkWidget *question_scroll = gtk_scrolled_window_new();
     gtk_scrolled_window_set_min_content_height(GTK_SCROLLED_WINDOW(question_scroll), 100);
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(question_scroll), question_text);
@@ -383,7 +477,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     if (q.nbChoix > 0) {
         char choices_str[1024] = "";
         for (int i = 0; i < q.nbChoix; i++) {
-            strcat(choices_str, q.choix[i]);
+            strcat(choices_str, question_choice(&q, i));
             if (i < q.nbChoix - 1) strcat(choices_str, "|");
         }
         gtk_editable_set_text(GTK_EDITABLE(choices_entry), choices_str);
@@ -429,7 +523,7 @@ static void on_edit_question_clicked(GtkWidget *button, gpointer user_data) {
     params[5] = question_text;
     params[6] = choices_entry;
     params[7] = answer_entry;
-    params[8] = GINT_TO_POINTER(app->selected_question_index);
+    params[8] = GINT_TO_POINTER(q.id); // L'indice peut changer si le fichier est rechargé entre-temps
 
     g_signal_connect_swapped(cancel_btn, "clicked", G_CALLBACK(gtk_window_destroy), dialog);
     g_signal_connect(save_btn, "clicked", G_CALLBACK(on_update_question_clicked), params);
@@ -448,7 +542,7 @@ static void on_update_question_clicked(GtkWidget *btn, gpointer data) {
     GtkWidget *question_text = (GtkWidget *)params[5];
     GtkWidget *choices_entry = (GtkWidget *)params[6];
     GtkWidget *answer_entry = (GtkWidget *)params[7];
-    int index = GPOINTER_TO_INT(params[8]);
+    int index = database_find_by_id(&app->db, GPOINTER_TO_INT(params[8])); // -1 : supprimée entre-temps
 
     guint subject_idx = gtk_drop_down_get_selected(GTK_DROP_DOWN(subject_dropdown));
     const char *subject = COMPUTER_ENGINEERING_SUBJECTS[subject_idx];
@@ -471,111 +565,137 @@ static void on_update_question_clicked(GtkWidget *btn, gpointer data) {
         return;
     }
 
-    Question q = {0};
-    q.matiere = my_strdup(subject);
-    q.chapitre = my_strdup(chapter);
-    q.type = my_strdup(type);
-    q.enonce = my_strdup(question);
-    q.points = 1;
+    Question q;
+    int status = question_from_form(&q, subject, chapter, type, question, choices, answer_str);
 
-    if (strcmp(type, "QCM") == 0 && strlen(choices) > 0) {
-        char *choices_copy = my_strdup(choices);
-        char *token = strtok(choices_copy, "|");
-        while (token) {
-            q.choix = realloc(q.choix, sizeof(char*) * (q.nbChoix + 1));
-            q.choix[q.nbChoix++] = my_strdup(token);
-            token = strtok(NULL, "|");
-        }
-        free(choices_copy);
-        q.bonneReponse = atoi(answer_str) - 1;
-    } else {
-        q.bonneReponse = -1;
-    }
-
-    update_question_in_db(&app->db, index, q);
-    save_database(&app->db, DB_FILE);
-
-    show_notification(app, "Question modifiée avec succès", "success");
-    refresh_question_list(app);
+    if (status == GEN_OK) status = update_question_in_db(&app->db, index, q);
+    save_and_notify(app, status, "Question modifiée avec succès");
 
     g_free(question);
     gtk_window_destroy(GTK_WINDOW(dialog));
 }
 
-static void on_question_item_clicked(GtkGestureClick *gesture, int n_press, double x, double y, gpointer data) {
-    gpointer *params = (gpointer *)data;
-    AppData *app = (AppData *)params[0];
-    int index = GPOINTER_TO_INT(params[1]);
+static void on_search_changed(GtkSearchEntry *entry, gpointer data) {
+    AppData *app = (AppData *)data;
+    const char *text = gtk_editable_get_text(GTK_EDITABLE(entry));
+    char count_text[100];
 
-    GtkWidget *child = gtk_widget_get_first_child(app->list_view);
-    while (child) {
-        gtk_widget_remove_css_class(child, "selected");
-        child = gtk_widget_get_next_sibling(child);
+    if (text[0] == 0) {
+        question_list_model_set_filter(app->question_model, NULL, -1);
+        snprintf(count_text, sizeof(count_text), "%d questions dans la base", app->db.count);
+        gtk_label_set_text(GTK_LABEL(app->count_label), count_text);
+        return;
     }
 
-    GtkWidget *clicked_item = gtk_event_controller_get_widget(GTK_EVENT_CONTROLLER(gesture));
-    gtk_widget_add_css_class(clicked_item, "selected");
+    if (!app->search_index_ready) {
+        int status = database_require_all(&app->db); // Base découpée : la recherche porte sur toutes les matières
+        if (status != GEN_OK) show_notification(app, gen_status_message(status), "error");
+        if (search_index_init(&app->search_index) != 0) {
+            show_notification(app, "Mémoire insuffisante pour la recherche", "error");
+            return;
+        }
+        if (search_index_build(&app->search_index, &app->db) != 0 ||
+            search_index_attach(&app->search_index, &app->db) != GEN_OK) {
+            search_index_free(&app->search_index);
+            show_notification(app, "Mémoire insuffisante pour la recherche", "error");
+            return;
+        }
+        app->search_index_ready = TRUE;
+    }
 
-    app->selected_question_index = index;
-}
+    int *ids = NULL;
+    int count = search_index_query(&app->search_index, &app->db, text, &ids);
+    question_list_model_set_filter(app->question_model, ids, count);
 
-static void refresh_question_list(AppData *app) {
-    GtkWidget *child = gtk_widget_get_first_child(app->list_view);
-    while (child) {
-        GtkWidget *next = gtk_widget_get_next_sibling(child);
-        gtk_box_remove(GTK_BOX(app->list_view), child);
-        child = next;
+    if (count < 0) {
+        snprintf(count_text, sizeof(count_text), "%d questions dans la base (3 lettres minimum pour filtrer)", app->db.count);
+    } else {
+        snprintf(count_text, sizeof(count_text), "%d résultat(s) sur %d questions", count, app->db.count);
     }
+    gtk_label_set_text(GTK_LABEL(app->count_label), count_text);
+}
 
-    for (int i = 0; i < app->db.count; i++) {
-        Question q = app->db.questions[i];
+static void on_question_row_position_changed(GtkListItem *list_item, GParamSpec *pspec, gpointer data) {
+    GtkWidget *item = gtk_list_item_get_child(list_item);
+    guint position = gtk_list_item_get_position(list_item);
+    if (!item || position == GTK_INVALID_LIST_POSITION) return;
 
-        GtkWidget *item = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
-        gtk_widget_set_margin_start(item, 15);
-        gtk_widget_set_margin_end(item, 15);
-        gtk_widget_set_margin_top(item, 10);
-        gtk_widget_set_margin_bottom(item, 10);
-        gtk_widget_add_css_class(item, "question-item");
+    char number_text[32];
+    snprintf(number_text, sizeof(number_text), "<span weight='bold' size='large'>%u.</span>", position + 1);
+    gtk_label_set_markup(GTK_LABEL(g_object_get_data(G_OBJECT(item), "number")), number_text);
+}
 
-        GtkWidget *header = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+// Construit une fois les widgets d'une ligne ; GtkListView les recycle ensuite
+static void on_question_row_setup(GtkSignalListItemFactory *factory, GtkListItem *list_item, gpointer data) {
+    GtkWidget *item = gtk_box_new(GTK_ORIENTATION_VERTICAL, 8);
+    gtk_widget_set_margin_start(item, 15);
+    gtk_widget_set_margin_end(item, 15);
+    gtk_widget_set_margin_top(item, 10);
+    gtk_widget_set_margin_bottom(item, 10);
+    gtk_widget_add_css_class(item, "question-item");
 
-        char markup[512];
-        snprintf(markup, sizeof(markup), "<span weight='bold' size='large'>%d.</span> <span weight='bold'>%s - %s</span>",
-                 i + 1, q.matiere, q.chapitre);
-        GtkWidget *title = gtk_label_new(NULL);
-        gtk_label_set_markup(GTK_LABEL(title), markup);
-        gtk_widget_set_halign(title, GTK_ALIGN_START);
-        gtk_widget_set_hexpand(title, TRUE);
-
-        GtkWidget *type_badge = gtk_label_new(q.type);
-        gtk_widget_add_css_class(type_badge, "badge");
-        if (strcmp(q.type, "QCM") == 0) {
-            gtk_widget_add_css_class(type_badge, "badge-qcm");
-        } else {
-            gtk_widget_add_css_class(type_badge, "badge-exercice");
-        }
+    GtkWidget *header = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
+
+    GtkWidget *number = gtk_label_new(NULL);
+
+    GtkWidget *title = gtk_label_new(NULL);
+    gtk_widget_set_halign(title, GTK_ALIGN_START);
+    gtk_widget_set_hexpand(title, TRUE);
 
-        gtk_box_append(GTK_BOX(header), title);
-        gtk_box_append(GTK_BOX(header), type_badge);
+    GtkWidget *type_badge = gtk_label_new(NULL);
+    gtk_widget_add_css_class(type_badge, "badge");
 
-        GtkWidget *question_label = gtk_label_new(q.enonce);
-        gtk_label_set_wrap(GTK_LABEL(question_label), TRUE);
-        gtk_label_set_xalign(GTK_LABEL(question_label), 0);
-        gtk_widget_set_margin_top(question_label, 5);
+    gtk_box_append(GTK_BOX(header), number);
+    gtk_box_append(GTK_BOX(header), title);
+    gtk_box_append(GTK_BOX(header), type_badge);
 
-        gtk_box_append(GTK_BOX(item), header);
-        gtk_box_append(GTK_BOX(item), question_label);
+    GtkWidget *question_label = gtk_label_new(NULL);
+    gtk_label_set_wrap(GTK_LABEL(question_label), TRUE);
+    gtk_label_set_xalign(GTK_LABEL(question_label), 0);
+    gtk_widget_set_margin_top(question_label, 5);
 
-        GtkGesture *click = gtk_gesture_click_new();
-        gpointer *click_params = g_new(gpointer, 2);
-        click_params[0] = app;
-        click_params[1] = GINT_TO_POINTER(i);
-        g_signal_connect(click, "pressed", G_CALLBACK(on_question_item_clicked), click_params);
-        g_signal_connect_swapped(item, "destroy", G_CALLBACK(g_free), click_params);
-        gtk_widget_add_controller(item, GTK_EVENT_CONTROLLER(click));
+    gtk_box_append(GTK_BOX(item), header);
+    gtk_box_append(GTK_BOX(item), question_label);
 
-        gtk_box_append(GTK_BOX(app->list_view), item);
+    g_object_set_data(G_OBJECT(item), "number", number);
+    g_object_set_data(G_OBJECT(item), "title", title);
+    g_object_set_data(G_OBJECT(item), "badge", type_badge);
+    g_object_set_data(G_OBJECT(item), "question", question_label);
+    gtk_list_item_set_child(list_item, item);
+
+    // Les lignes déjà affichées se décalent sans être reliées : seul leur numéro change
+    g_signal_connect(list_item, "notify::position", G_CALLBACK(on_question_row_position_changed), NULL);
+}
+
+static void on_question_row_bind(GtkSignalListItemFactory *factory, GtkListItem *list_item, gpointer data) {
+    AppData *app = (AppData *)data;
+    GtkWidget *item = gtk_list_item_get_child(list_item);
+    QuestionItem *question_item = QUESTION_ITEM(gtk_list_item_get_item(list_item));
+    int i = database_find_by_id(&app->db, question_item_get_id(question_item));
+    if (i < 0) return;
+    Question q = app->db.questions[i];
+
+    GtkWidget *title = g_object_get_data(G_OBJECT(item), "title");
+    GtkWidget *type_badge = g_object_get_data(G_OBJECT(item), "badge");
+    GtkWidget *question_label = g_object_get_data(G_OBJECT(item), "question");
+
+    on_question_row_position_changed(list_item, NULL, NULL);
+
+    char *markup = g_markup_printf_escaped("<span weight='bold'>%s - %s</span>", question_matiere(&app->db, &q),
+                                           question_chapitre(&app->db, &q));
+    gtk_label_set_markup(GTK_LABEL(title), markup);
+    g_free(markup);
+
+    gtk_label_set_text(GTK_LABEL(type_badge), question_type(&app->db, &q));
+    gtk_widget_remove_css_class(type_badge, "badge-qcm");
+    gtk_widget_remove_css_class(type_badge, "badge-exercice");
+    if (strcmp(question_type(&app->db, &q), "QCM") == 0) {
+        gtk_widget_add_css_class(type_badge, "badge-qcm");
+    } else {
+        gtk_widget_add_css_class(type_badge, "badge-exercice");
     }
+
+    gtk_label_set_text(GTK_LABEL(question_label), question_enonce(&q));
 }
 
 static void on_chapter_checkbox_toggled(GtkCheckButton *checkbox, gpointer data) {
@@ -626,14 +746,17 @@ static void on_subject_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointe
     
     if (selection->chapters) {
         free_string_array(selection->chapters, selection->count);
-        free(selection->selected);
+        mem_free(MEM_GUI, selection->selected);
     }
     
     guint subject_idx = gtk_drop_down_get_selected(dropdown);
     const char *subject = COMPUTER_ENGINEERING_SUBJECTS[subject_idx];
-    
+
+    // Base découpée : la matière choisie est chargée ici, avant toute génération
+    int status = database_require_subject(&app->db, subject);
+    if (status != GEN_OK) show_notification(app, gen_status_message(status), "error");
     selection->chapters = get_unique_chapters(&app->db, subject, &selection->count);
-    selection->selected = calloc(selection->count, sizeof(int));
+    selection->selected = mem_calloc(MEM_GUI, selection->count, sizeof(int));
     
     GtkWidget *all_checkbox = gtk_check_button_new_with_label("Tous les chapitres");
     gtk_check_button_set_active(GTK_CHECK_BUTTON(all_checkbox), TRUE);
@@ -649,6 +772,158 @@ static void on_subject_changed(GtkDropDown *dropdown, GParamSpec *pspec, gpointe
     }
 }
 
+static void generation_job_free(GenerationJob *job) {
+    g_clear_object(&job->cancellable);
+    g_free(job->subject);
+    g_strfreev(job->chapters);
+    g_free(job->format);
+    g_free(job->base_filename);
+    g_free(job);
+}
+
+// Appelée par le générateur (thread de travail) après chaque question
+static int on_exam_progress(void *user_data, int done, int total) {
+    GenerationJob *job = (GenerationJob *)user_data;
+    g_atomic_int_set(&job->exam_permille, total > 0 ? done * 1000 / total : 1000);
+    return g_cancellable_is_cancelled(job->cancellable);
+}
+
+static void generation_worker(GTask *task, gpointer source_object, gpointer task_data,
+                              GCancellable *cancellable) {
+    GenerationJob *job = (GenerationJob *)task_data;
+    trace_set_thread_name("generation");
+
+    // Version publiée par le thread GTK au lancement ; lue sans verrou jusqu'à la fin du lot
+    SnapshotReader reader;
+    const Database *db = snapshot_acquire(&job->app->snapshots, &reader);
+
+    // Un seul parcours de la base pour tous les chapitres cochés ; chaque variante
+    // tire ensuite ses questions dans la partition de son chapitre.
+    int nb_chapters = (int)g_strv_length(job->chapters);
+    int all_chapters = (nb_chapters == 1 && job->chapters[0][0] == '\0');
+    ChapterPartition partition;
+    if (!db || partition_by_chapter(db, job->subject, (const char *const *)job->chapters,
+                                    all_chapters ? 0 : nb_chapters, &partition) != GEN_OK) {
+        snapshot_release(&reader);
+        g_atomic_int_set(&job->failed, job->total);
+        g_atomic_int_set(&job->done, job->total);
+        g_task_return_boolean(task, TRUE);
+        return;
+    }
+
+    for (int c = 0; c < partition.count; c++) {
+        const char *chapter = partition.pools[c].chapitre;
+
+        char chapter_part[120] = "";
+        if (chapter[0] != '\0') {
+            char safe_chapter_name[100];
+            strncpy(safe_chapter_name, chapter, sizeof(safe_chapter_name) - 1);
+            safe_chapter_name[sizeof(safe_chapter_name) - 1] = '\0';
+            for (char *p = safe_chapter_name; *p; ++p) {
+                if (*p == ' ') *p = '_';
+            }
+            snprintf(chapter_part, sizeof(chapter_part), "_%s", safe_chapter_name);
+        }
+
+        for (int v = 1; v <= job->variants; v++) {
+            if (g_cancellable_is_cancelled(cancellable)) break;
+
+            char filename[400];
+            if (job->variants > 1) {
+                snprintf(filename, sizeof(filename), "%s%s_v%03d.%s",
+                         job->base_filename, chapter_part, v, job->extension);
+            } else {
+                snprintf(filename, sizeof(filename), "%s%s.%s",
+                         job->base_filename, chapter_part, job->extension);
+            }
+
+            GenerationReport report;
+            ExamRequest request = {0};
+            request.matiere = job->subject;
+            request.chapitre = chapter;
+            request.exam_type = job->exam_type;
+            request.progress = on_exam_progress;
+            request.progress_data = job;
+            request.avoid_near_duplicates = job->avoid_near_duplicates;
+            request.report = &report;
+
+            g_atomic_int_set(&job->exam_permille, 0);
+            int result = generate_exam_files_from_pool(db, &request, &partition.pools[c],
+                                                       filename, job->format);
+            if (result == GENERATOR_CANCELLED) break;
+            if (result != GEN_OK) {
+                g_strlcpy(job->last_error, report.message[0] ? report.message : gen_status_message(result),
+                          sizeof(job->last_error));
+                g_atomic_int_inc(&job->failed);
+            }
+            g_atomic_int_inc(&job->done);
+        }
+    }
+
+    free_chapter_partition(&partition);
+    snapshot_release(&reader);
+    g_task_return_boolean(task, !g_cancellable_is_cancelled(cancellable));
+}
+
+// Rafraîchit la barre de progression depuis la boucle principale (~20 fois par seconde)
+static gboolean on_generation_progress_tick(gpointer data) {
+    GenerationJob *job = (GenerationJob *)data;
+    int done = g_atomic_int_get(&job->done);
+    double current = g_atomic_int_get(&job->exam_permille) / 1000.0;
+    double fraction = (done < job->total) ? (done + current) / job->total : 1.0;
+
+    char text[100];
+    snprintf(text, sizeof(text), "%d / %d épreuve(s)", done, job->total);
+    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(job->progress_bar), fraction);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job->progress_bar), text);
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_generation_finished(GObject *source_object, GAsyncResult *result, gpointer data) {
+    GenerationJob *job = (GenerationJob *)data;
+    AppData *app = job->app;
+    gboolean completed = g_task_propagate_boolean(G_TASK(result), NULL);
+
+    g_source_remove(job->progress_source);
+    snapshot_reclaim(&app->snapshots); // La version lue par le lot peut être libérée
+
+    int done = g_atomic_int_get(&job->done);
+    int failed = g_atomic_int_get(&job->failed);
+    char notification[256];
+    if (!completed) {
+        snprintf(notification, sizeof(notification),
+                 "Génération annulée après %d épreuve(s)", done - failed);
+        show_notification(app, notification, "info");
+    } else if (failed > 0) {
+        gchar *reason = g_markup_escape_text(job->last_error[0] ? job->last_error : "mémoire insuffisante", -1);
+        snprintf(notification, sizeof(notification),
+                 "%d épreuve(s) sur %d n'ont pas pu être générées : %s", failed, done, reason);
+        g_free(reason);
+        show_notification(app, notification, "error");
+    } else {
+        snprintf(notification, sizeof(notification),
+                 "%d épreuve(s) générée(s) dans 'Epreuves_Generees'", done);
+        show_notification(app, notification, "success");
+    }
+
+    gtk_window_destroy(GTK_WINDOW(job->dialog));
+    generation_job_free(job);
+}
+
+static void on_generation_cancel_clicked(GtkWidget *btn, gpointer data) {
+    GenerationJob *job = (GenerationJob *)data;
+    g_cancellable_cancel(job->cancellable);
+    gtk_widget_set_sensitive(btn, FALSE);
+    gtk_progress_bar_set_text(GTK_PROGRESS_BAR(job->progress_bar), "Annulation...");
+}
+
+// Bloque la fermeture de la boîte tant que le lot tourne : elle annule à la place
+static gboolean on_generation_close_request(GtkWindow *window, gpointer data) {
+    GenerationJob *job = (GenerationJob *)data;
+    on_generation_cancel_clicked(job->cancel_btn, job);
+    return TRUE;
+}
+
 static void on_generate_exam_execute_new(GtkWidget *btn, gpointer data) {
     gpointer *params = (gpointer *)data;
     AppData *app = (AppData *)params[0];
@@ -659,6 +934,10 @@ static void on_generate_exam_execute_new(GtkWidget *btn, gpointer data) {
     GtkWidget *file_entry = (GtkWidget *)params[5];
     GtkWidget *format_dropdown = (GtkWidget *)params[6];
     GtkWidget *all_chapters_checkbox = (GtkWidget *)params[7];
+    GtkWidget *variants_spin = (GtkWidget *)params[8];
+    GtkWidget *progress_bar = (GtkWidget *)params[9];
+    GtkWidget *cancel_btn = (GtkWidget *)params[10];
+    GtkWidget *distinct_checkbox = (GtkWidget *)params[11];
 
     guint subject_idx = gtk_drop_down_get_selected(GTK_DROP_DOWN(subject_dropdown));
     const char *subject = COMPUTER_ENGINEERING_SUBJECTS[subject_idx];
@@ -666,13 +945,12 @@ static void on_generate_exam_execute_new(GtkWidget *btn, gpointer data) {
     gboolean all_chapters = gtk_check_button_get_active(GTK_CHECK_BUTTON(all_chapters_checkbox));
     
     guint exam_type_idx = gtk_drop_down_get_selected(GTK_DROP_DOWN(exam_type_dropdown));
-    typedef enum { EXAM_TYPE_QCM_ONLY, EXAM_TYPE_MIXED } ExamType;
     ExamType exam_type = (exam_type_idx == 0) ? EXAM_TYPE_QCM_ONLY : EXAM_TYPE_MIXED;
     
     const char *base_filename = gtk_editable_get_text(GTK_EDITABLE(file_entry));
     
     guint format_idx = gtk_drop_down_get_selected(GTK_DROP_DOWN(format_dropdown));
-    const char *format = (format_idx == 0) ? "TXT" : "PDF";
+    const char *format = OUTPUT_FORMAT_CODES[format_idx];
 
     if (strlen(subject) == 0) {
         show_notification(app, "Veuillez spécifier une matière", "error");
@@ -684,56 +962,62 @@ static void on_generate_exam_execute_new(GtkWidget *btn, gpointer data) {
     clean_filename[sizeof(clean_filename) - 1] = '\0';
     
     char *dot = strrchr(clean_filename, '.');
-    if (dot != NULL) {
-        if (strcmp(dot, ".txt") == 0 || strcmp(dot, ".pdf") == 0) {
-            *dot = '\0';
-        }
-    }
-    
-    char final_filename[300];
-    if (format_idx == 0) {
-        snprintf(final_filename, sizeof(final_filename), "%s.txt", clean_filename);
-    } else {
-        snprintf(final_filename, sizeof(final_filename), "%s.pdf", clean_filename);
+    if (dot != NULL && renderer_find(dot + 1) != NULL) {
+        *dot = '\0';
     }
 
+    GPtrArray *chapters = g_ptr_array_new();
     if (all_chapters) {
-        generate_exam(&app->db, subject, "", exam_type, final_filename, format);
+        g_ptr_array_add(chapters, g_strdup(""));
     } else {
-        int generated_count = 0;
         for (int i = 0; i < selection->count; i++) {
             if (selection->selected[i]) {
-                char chapter_filename[300];
-                char safe_chapter_name[100];
-                strncpy(safe_chapter_name, selection->chapters[i], sizeof(safe_chapter_name) - 1);
-                safe_chapter_name[sizeof(safe_chapter_name) - 1] = '\0';
-                for (char *p = safe_chapter_name; *p; ++p) {
-                    if (*p == ' ') *p = '_';
-                }
-
-                snprintf(chapter_filename, sizeof(chapter_filename), "%s_%s", clean_filename, safe_chapter_name);
-                if (format_idx == 0) {
-                    strcat(chapter_filename, ".txt");
-                } else {
-                    strcat(chapter_filename, ".pdf");
-                }
-                generate_exam(&app->db, subject, selection->chapters[i], exam_type, chapter_filename, format);
-                generated_count++;
+                g_ptr_array_add(chapters, g_strdup(selection->chapters[i]));
             }
         }
-        
-        if (generated_count == 0) {
-            show_notification(app, "Veuillez sélectionner au moins un chapitre ou cocher 'Tous les chapitres'", "error");
-            return;
-        }
     }
-    
-    char notification[256];
-    snprintf(notification, sizeof(notification), 
-             "Épreuve(s) générée(s) dans 'Epreuves_Generees'");
-    show_notification(app, notification, "success");
+    if (chapters->len == 0) {
+        g_ptr_array_free(chapters, TRUE);
+        show_notification(app, "Veuillez sélectionner au moins un chapitre ou cocher 'Tous les chapitres'", "error");
+        return;
+    }
 
-    gtk_window_destroy(GTK_WINDOW(dialog));
+    GenerationJob *job = g_new0(GenerationJob, 1);
+    job->app = app;
+    job->dialog = dialog;
+    job->progress_bar = progress_bar;
+    job->generate_btn = btn;
+    job->cancel_btn = cancel_btn;
+    job->cancellable = g_cancellable_new();
+    job->subject = g_strdup(subject);
+    job->total = (int)chapters->len;
+    g_ptr_array_add(chapters, NULL);
+    job->chapters = (char **)g_ptr_array_free(chapters, FALSE);
+    job->exam_type = exam_type;
+    job->format = g_strdup(format);
+    job->base_filename = g_strdup(clean_filename);
+    // Extension du premier format ; le générateur la remplace pour chaque fichier produit
+    job->extension = renderer_find_n(format, strcspn(format, ","))->extension;
+    job->variants = gtk_spin_button_get_value_as_int(GTK_SPIN_BUTTON(variants_spin));
+    job->total *= job->variants;
+    job->avoid_near_duplicates = gtk_check_button_get_active(GTK_CHECK_BUTTON(distinct_checkbox));
+
+    // Pendant le lot, seuls la progression et l'annulation restent actives
+    gtk_widget_set_sensitive(btn, FALSE);
+    gtk_widget_set_visible(progress_bar, TRUE);
+    g_signal_handlers_disconnect_matched(cancel_btn, G_SIGNAL_MATCH_DATA, 0, 0, NULL, NULL, dialog);
+    g_signal_connect(cancel_btn, "clicked", G_CALLBACK(on_generation_cancel_clicked), job);
+    g_signal_connect(dialog, "close-request", G_CALLBACK(on_generation_close_request), job);
+    job->progress_source = g_timeout_add(50, on_generation_progress_tick, job);
+    show_notification(app, "Génération en cours...", "info");
+
+    if (snapshot_publish(&app->snapshots) != 0) {
+        show_notification(app, "Mémoire insuffisante : génération sur la version précédente de la base", "error");
+    }
+    GTask *task = g_task_new(NULL, job->cancellable, on_generation_finished, job);
+    g_task_set_task_data(task, job, NULL);
+    g_task_run_in_thread(task, generation_worker);
+    g_object_unref(task);
 }
 
 static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
@@ -820,8 +1104,7 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
     gtk_label_set_markup(GTK_LABEL(format_label), "<span weight='bold'>Format de Sortie</span>");
     gtk_widget_set_halign(format_label, GTK_ALIGN_START);
     
-    const char *formats[] = {"Fichier Texte (.txt)", "Document PDF (.pdf)", NULL};
-    GtkWidget *format_dropdown = gtk_drop_down_new_from_strings(formats);
+    GtkWidget *format_dropdown = gtk_drop_down_new_from_strings(OUTPUT_FORMAT_LABELS);
     gtk_drop_down_set_selected(GTK_DROP_DOWN(format_dropdown), 1);
     gtk_box_append(GTK_BOX(format_box), format_label);
     gtk_box_append(GTK_BOX(format_box), format_dropdown);
@@ -846,6 +1129,17 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
     gtk_widget_set_halign(save_info_label, GTK_ALIGN_START);
     gtk_box_append(GTK_BOX(box), save_info_label);
 
+    GtkWidget *variants_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+    GtkWidget *variants_label = gtk_label_new("Nombre de variantes par épreuve");
+    gtk_widget_set_halign(variants_label, GTK_ALIGN_START);
+    GtkWidget *variants_spin = gtk_spin_button_new_with_range(1, 500, 1);
+    gtk_box_append(GTK_BOX(variants_box), variants_label);
+    gtk_box_append(GTK_BOX(variants_box), variants_spin);
+    gtk_box_append(GTK_BOX(box), variants_box);
+
+    GtkWidget *distinct_checkbox = gtk_check_button_new_with_label("Éviter les questions quasi identiques dans une même épreuve");
+    gtk_box_append(GTK_BOX(box), distinct_checkbox);
+
     GtkWidget *file_box = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
     GtkWidget *file_label = gtk_label_new("Nom du Fichier (sans extension)");
     gtk_widget_set_halign(file_label, GTK_ALIGN_START);
@@ -856,6 +1150,11 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
     gtk_box_append(GTK_BOX(file_box), file_entry);
     gtk_box_append(GTK_BOX(box), file_box);
 
+    GtkWidget *progress_bar = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(progress_bar), TRUE);
+    gtk_widget_set_visible(progress_bar, FALSE);
+    gtk_box_append(GTK_BOX(box), progress_bar);
+
     GtkWidget *button_box = gtk_box_new(GTK_ORIENTATION_HORIZONTAL, 10);
     gtk_widget_set_halign(button_box, GTK_ALIGN_END);
     gtk_widget_set_margin_top(button_box, 10);
@@ -869,7 +1168,7 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
     gtk_box_append(GTK_BOX(button_box), generate_btn);
     gtk_box_append(GTK_BOX(box), button_box);
 
-    gpointer *params = g_new(gpointer, 8);
+    gpointer *params = g_new(gpointer, 12);
     params[0] = app;
     params[1] = dialog;
     params[2] = subject_dropdown;
@@ -878,6 +1177,10 @@ static void on_generate_exam_clicked(GtkWidget *button, gpointer user_data) {
     params[5] = file_entry;
     params[6] = format_dropdown;
     params[7] = all_chapters_checkbox;
+    params[8] = variants_spin;
+    params[9] = progress_bar;
+    params[10] = cancel_btn;
+    params[11] = distinct_checkbox;
 
     g_signal_connect_swapped(cancel_btn, "clicked", G_CALLBACK(gtk_window_destroy), dialog);
     g_signal_connect(generate_btn, "clicked", G_CALLBACK(on_generate_exam_execute_new), params);
@@ -893,10 +1196,286 @@ static void switch_to_view(AppData *app, const char *view_name) {
     gtk_stack_set_visible_child_name(GTK_STACK(app->stack), view_name);
 }
 
+static void bank_loader_push(BankLoader *loader, Question *batch, int count, gint64 bytes_read) {
+    g_mutex_lock(&loader->lock);
+    if (count > 0 && loader->nb_pending + count > loader->pending_capacity) {
+        int new_capacity = loader->pending_capacity ? loader->pending_capacity * 2 : LOAD_BATCH_SIZE * 4;
+        while (new_capacity < loader->nb_pending + count) new_capacity *= 2;
+        Question *pending = mem_realloc(MEM_GUI, loader->pending, sizeof(Question) * new_capacity);
+        if (pending) {
+            loader->pending = pending;
+            loader->pending_capacity = new_capacity;
+        } else { // Mémoire insuffisante : le lot est abandonné
+            for (int i = 0; i < count; i++) free_question_content(&batch[i]);
+            count = 0;
+        }
+    }
+    if (count > 0) {
+        memcpy(loader->pending + loader->nb_pending, batch, sizeof(Question) * count);
+        loader->nb_pending += count;
+    }
+    loader->bytes_read = bytes_read;
+    g_mutex_unlock(&loader->lock);
+}
+
+// Thread de chargement : n'accède jamais à la base, seulement à la file des questions analysées
+static gpointer bank_loader_thread(gpointer data) {
+    BankLoader *loader = (BankLoader *)data;
+    FILE *f = fopen(DB_FILE, "r");
+    if (!f) {
+        printf("AVERTISSEMENT: Fichier '%s' non trouve. Une base de donnees vide sera utilisee.\n", DB_FILE);
+        g_atomic_int_set(&loader->finished, 1);
+        return NULL;
+    }
+
+    fseek(f, 0, SEEK_END);
+    g_mutex_lock(&loader->lock);
+    loader->file_size = ftell(f);
+    g_mutex_unlock(&loader->lock);
+    rewind(f);
+
+    trace_set_thread_name("bank-loader");
+    Question batch[LOAD_BATCH_SIZE];
+    int count = 0;
+    char line[DATABASE_LINE_MAX];
+    DatabaseFormat format = DATABASE_FORMAT_PLAIN;
+    for (int n = 0; !g_atomic_int_get(&loader->cancelled) && fgets(line, sizeof(line), f); n++) {
+        if (n == 0) format = database_file_format(line);
+        if (parse_question_line(line, format, &batch[count]) > 0) count++;
+        if (count == LOAD_BATCH_SIZE) {
+            bank_loader_push(loader, batch, count, ftell(f));
+            count = 0;
+        }
+    }
+    bank_loader_push(loader, batch, count, ftell(f));
+    fclose(f);
+
+    g_atomic_int_set(&loader->finished, 1);
+    return NULL;
+}
+
+static void update_loading_widgets(AppData *app, double fraction) {
+    char text[100];
+    if (app->loading) {
+        snprintf(text, sizeof(text), "Chargement de la base... %d questions", app->db.count);
+    } else {
+        // Base découpée : les matières pas encore chargées comptent aussi
+        snprintf(text, sizeof(text), "%d questions dans la base", database_total_count(&app->db));
+    }
+
+    if (app->count_label) gtk_label_set_text(GTK_LABEL(app->count_label), text);
+    if (app->load_progress) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(app->load_progress), fraction);
+        gtk_widget_set_visible(app->load_progress, app->loading);
+    }
+    if (app->login_progress) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(app->login_progress), fraction);
+        gtk_progress_bar_set_text(GTK_PROGRESS_BAR(app->login_progress), text);
+        gtk_widget_set_visible(app->login_progress, app->loading);
+    }
+
+    GtkWidget *edit_actions[] = { app->add_btn, app->edit_btn, app->delete_btn, app->generate_btn };
+    for (size_t i = 0; i < G_N_ELEMENTS(edit_actions); i++) {
+        if (edit_actions[i]) gtk_widget_set_sensitive(edit_actions[i], !app->loading);
+    }
+}
+
+// Range un lot analysé dans la base ; si la mémoire manque, le lot est abandonné
+static void add_loaded_questions(Database *db, Question *batch, int count) {
+    if (add_questions_to_db(db, batch, count) == GEN_OK) return;
+    for (int i = 0; i < count; i++) {
+        free_question_content(&batch[i]);
+    }
+}
+
+// --- Rechargement à chaud ---
+
+// Applique les changements du fichier ; le modèle de liste, l'index de recherche et les
+// instantanés suivent par leurs écouteurs
+static gboolean on_bank_reload_timeout(gpointer data) {
+    AppData *app = (AppData *)data;
+    app->reload_source = 0;
+    BankReloadStats stats;
+    int status = bank_watch_reload(&app->watch, &app->db, &stats);
+    if (status != GEN_OK) {
+        show_notification(app, gen_status_message(status), "error");
+    } else if (stats.added + stats.updated + stats.removed > 0) {
+        char message[200];
+        snprintf(message, sizeof(message), "Fichier modifié : %d question(s) ajoutée(s), %d modifiée(s), %d supprimée(s)",
+                 stats.added, stats.updated, stats.removed);
+        show_notification(app, message, "info");
+        update_loading_widgets(app, 1.0);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+static gboolean on_bank_file_event(gint fd, GIOCondition condition, gpointer data) {
+    AppData *app = (AppData *)data;
+    if (bank_watch_poll(&app->watch)) {
+        if (app->reload_source) g_source_remove(app->reload_source);
+        app->reload_source = g_timeout_add(BANK_WATCH_DELAY_MS, on_bank_reload_timeout, app);
+    }
+    return G_SOURCE_CONTINUE;
+}
+
+// Surveille DB_FILE une fois la base chargée (sans surveillance, l'application fonctionne normalement)
+static void start_file_watch(AppData *app) {
+    if (bank_watch_init(&app->watch, &app->db, DB_FILE) != GEN_OK) return;
+    app->watching = TRUE;
+    if (bank_watch_fd(&app->watch) >= 0) {
+        app->watch_source = g_unix_fd_add(bank_watch_fd(&app->watch), G_IO_IN, on_bank_file_event, app);
+    }
+}
+
+static void stop_file_watch(AppData *app) {
+    if (app->watch_source) g_source_remove(app->watch_source);
+    if (app->reload_source) g_source_remove(app->reload_source);
+    app->watch_source = app->reload_source = 0;
+    if (app->watching) bank_watch_free(&app->watch);
+    app->watching = FALSE;
+}
+
+// Tick du thread GTK : les questions prêtes rejoignent la base en un seul lot
+static gboolean on_bank_load_tick(gpointer data) {
+    AppData *app = (AppData *)data;
+    BankLoader *loader = &app->loader;
+
+    // Lu avant de vider la file : si le thread avait fini, tout son travail est dans la file
+    gboolean finished = g_atomic_int_get(&loader->finished);
+
+    g_mutex_lock(&loader->lock);
+    Question *batch = loader->pending;
+    int count = loader->nb_pending;
+    double fraction = (loader->file_size > 0) ? (double)loader->bytes_read / (double)loader->file_size : 0.0;
+    loader->pending = NULL;
+    loader->nb_pending = 0;
+    loader->pending_capacity = 0;
+    g_mutex_unlock(&loader->lock);
+
+    add_loaded_questions(&app->db, batch, count);
+    mem_free(MEM_GUI, batch);
+
+    if (finished) {
+        g_thread_join(loader->thread);
+        loader->thread = NULL;
+        loader->tick_source = 0;
+        app->loading = FALSE;
+        update_loading_widgets(app, 1.0);
+        start_file_watch(app);
+        if (app->main_window) show_notification(app, "Base de questions chargée", "success");
+        return G_SOURCE_REMOVE;
+    }
+
+    update_loading_widgets(app, fraction);
+    return G_SOURCE_CONTINUE;
+}
+
+static void bank_loader_start(AppData *app) {
+    BankLoader *loader = &app->loader;
+    g_mutex_init(&loader->lock);
+    app->loading = TRUE;
+    loader->thread = g_thread_new("bank-loader", bank_loader_thread, loader);
+    loader->tick_source = g_timeout_add(50, on_bank_load_tick, app);
+}
+
+// Base découpée : seul le manifeste est lu au démarrage, chaque matière arrive à sa première
+// utilisation (pas de chargement en arrière-plan ni de surveillance). Base SQLite : chargée
+// d'un coup, chaque modification y est reportée en place (pas de surveillance non plus).
+// Sinon, DB_FILE.
+static void open_database(AppData *app) {
+    if (bank_shards_is_directory(DB_SHARDS_DIR) && load_database(&app->db, DB_SHARDS_DIR) == GEN_OK) {
+        app->db_path = DB_SHARDS_DIR;
+        g_mutex_init(&app->loader.lock); // Libéré par bank_loader_stop
+        return;
+    }
+#ifdef GEN_WITH_SQLITE
+    if (g_file_test(DB_SQLITE_FILE, G_FILE_TEST_EXISTS)) {
+        // Chargée en partie, elle reste juste : les modifications ne touchent que leurs lignes
+        int status = load_database(&app->db, DB_SQLITE_FILE);
+        if (status != GEN_OK) {
+            printf("AVERTISSEMENT: Chargement de '%s' interrompu : %s\n", DB_SQLITE_FILE, gen_status_message(status));
+        }
+        app->db_path = DB_SQLITE_FILE;
+        g_mutex_init(&app->loader.lock);
+        return;
+    }
+#endif
+    app->db_path = DB_FILE;
+    bank_loader_start(app);
+}
+
+// Arrêt pendant le chargement : on attend le thread puis on range ce qu'il a déjà analysé
+static void bank_loader_stop(AppData *app) {
+    BankLoader *loader = &app->loader;
+    if (loader->tick_source) g_source_remove(loader->tick_source);
+    loader->tick_source = 0;
+    if (loader->thread) {
+        g_atomic_int_set(&loader->cancelled, 1);
+        g_thread_join(loader->thread);
+        loader->thread = NULL;
+    }
+    add_loaded_questions(&app->db, loader->pending, loader->nb_pending);
+    mem_free(MEM_GUI, loader->pending);
+    loader->pending = NULL;
+    loader->nb_pending = 0;
+    g_mutex_clear(&loader->lock);
+}
+
+// Fenêtre de diagnostic : allocations par sous-système (mem_track.h), actualisée chaque seconde
+static gboolean on_memory_panel_tick(gpointer data) {
+    GtkWidget *label = GTK_WIDGET(data);
+    AppData *app = g_object_get_data(G_OBJECT(label), "app");
+    char report[1024];
+    mem_track_format(report, sizeof(report), app->db.count);
+    gtk_label_set_text(GTK_LABEL(label), report);
+    return G_SOURCE_CONTINUE;
+}
+
+static void on_memory_panel_destroy(GtkWidget *dialog, gpointer data) {
+    g_source_remove(GPOINTER_TO_UINT(data));
+}
+
+static void on_memory_panel_clicked(GtkWidget *button, gpointer user_data) {
+    AppData *app = (AppData *)user_data;
+
+    GtkWidget *dialog = gtk_window_new();
+    gtk_window_set_title(GTK_WINDOW(dialog), "Mémoire utilisée");
+    gtk_window_set_transient_for(GTK_WINDOW(dialog), GTK_WINDOW(app->main_window));
+
+    GtkWidget *label = gtk_label_new(NULL);
+    gtk_widget_add_css_class(label, "monospace");
+    gtk_label_set_selectable(GTK_LABEL(label), TRUE);
+    gtk_label_set_xalign(GTK_LABEL(label), 0.0);
+    gtk_widget_set_margin_start(label, 20);
+    gtk_widget_set_margin_end(label, 20);
+    gtk_widget_set_margin_top(label, 20);
+    gtk_widget_set_margin_bottom(label, 20);
+    gtk_window_set_child(GTK_WINDOW(dialog), label);
+
+    g_object_set_data(G_OBJECT(label), "app", app);
+    on_memory_panel_tick(label);
+    guint source = g_timeout_add_seconds(1, on_memory_panel_tick, label);
+    g_signal_connect(dialog, "destroy", G_CALLBACK(on_memory_panel_destroy), GUINT_TO_POINTER(source));
+
+    gtk_window_present(GTK_WINDOW(dialog));
+}
+
+// Le chargement peut encore tourner quand la fenêtre se ferme : il ne doit plus toucher ses widgets
+static void on_main_window_destroy(AppData *app) {
+    app->main_window = NULL;
+    app->count_label = NULL;
+    app->load_progress = NULL;
+    app->add_btn = NULL;
+    app->edit_btn = NULL;
+    app->delete_btn = NULL;
+    app->generate_btn = NULL;
+}
+
 static void activate(GtkApplication *gtk_app, gpointer user_data) {
     AppData *app = (AppData *)user_data;
 
     app->main_window = gtk_application_window_new(gtk_app);
+    g_signal_connect_swapped(app->main_window, "destroy", G_CALLBACK(on_main_window_destroy), app);
     gtk_window_set_title(GTK_WINDOW(app->main_window), "Générateur d'Épreuves - Ingénierie Informatique");
     gtk_window_set_default_size(GTK_WINDOW(app->main_window), 1100, 750);
 
@@ -909,34 +1488,62 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
         "<span weight='bold' size='large'>Générateur d'Épreuves</span>");
     gtk_header_bar_set_title_widget(GTK_HEADER_BAR(header), header_title);
 
-    GtkWidget *add_btn = gtk_button_new_from_icon_name("list-add-symbolic");
+    GtkWidget *add_btn = app->add_btn = gtk_button_new_from_icon_name("list-add-symbolic");
     gtk_widget_set_tooltip_text(add_btn, "Ajouter une question");
     gtk_widget_add_css_class(add_btn, "circular");
     gtk_header_bar_pack_start(GTK_HEADER_BAR(header), add_btn);
     g_signal_connect(add_btn, "clicked", G_CALLBACK(on_add_question_clicked), app);
 
-    GtkWidget *edit_btn = gtk_button_new_from_icon_name("document-edit-symbolic");
+    GtkWidget *edit_btn = app->edit_btn = gtk_button_new_from_icon_name("document-edit-symbolic");
     gtk_widget_set_tooltip_text(edit_btn, "Modifier la question sélectionnée");
     gtk_widget_add_css_class(edit_btn, "circular");
     gtk_header_bar_pack_start(GTK_HEADER_BAR(header), edit_btn);
     g_signal_connect(edit_btn, "clicked", G_CALLBACK(on_edit_question_clicked), app);
 
-    GtkWidget *delete_btn = gtk_button_new_from_icon_name("user-trash-symbolic");
+    GtkWidget *delete_btn = app->delete_btn = gtk_button_new_from_icon_name("user-trash-symbolic");
     gtk_widget_set_tooltip_text(delete_btn, "Supprimer la question sélectionnée");
     gtk_widget_add_css_class(delete_btn, "circular");
     gtk_header_bar_pack_start(GTK_HEADER_BAR(header), delete_btn);
     g_signal_connect(delete_btn, "clicked", G_CALLBACK(on_delete_question_clicked), app);
 
-    GtkWidget *generate_btn = gtk_button_new_with_label("Générer Épreuve");
+    GtkWidget *generate_btn = app->generate_btn = gtk_button_new_with_label("Générer Épreuve");
     gtk_widget_add_css_class(generate_btn, "suggested-action");
     gtk_widget_add_css_class(generate_btn, "pill");
     gtk_header_bar_pack_end(GTK_HEADER_BAR(header), generate_btn);
     g_signal_connect(generate_btn, "clicked", G_CALLBACK(on_generate_exam_clicked), app);
 
+    GtkWidget *memory_btn = gtk_button_new_from_icon_name("utilities-system-monitor-symbolic");
+    gtk_widget_set_tooltip_text(memory_btn, "Mémoire utilisée par sous-système");
+    gtk_widget_add_css_class(memory_btn, "circular");
+    gtk_header_bar_pack_end(GTK_HEADER_BAR(header), memory_btn);
+    g_signal_connect(memory_btn, "clicked", G_CALLBACK(on_memory_panel_clicked), app);
+
     gtk_box_append(GTK_BOX(main_box), header);
 
+    // Seules les lignes visibles ont des widgets : le coût ne dépend pas de la taille de la base
+    app->question_model = question_list_model_new(&app->db);
+    app->selection_model = gtk_single_selection_new(G_LIST_MODEL(app->question_model));
+    gtk_single_selection_set_autoselect(app->selection_model, FALSE);
+    gtk_single_selection_set_can_unselect(app->selection_model, TRUE);
+    gtk_single_selection_set_selected(app->selection_model, GTK_INVALID_LIST_POSITION);
+
+    GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
+    g_signal_connect(factory, "setup", G_CALLBACK(on_question_row_setup), app);
+    g_signal_connect(factory, "bind", G_CALLBACK(on_question_row_bind), app);
+
+    // Filtre au fil de la frappe sur l'énoncé, les choix, la matière et le chapitre
+    app->search_entry = gtk_search_entry_new();
+    gtk_search_entry_set_placeholder_text(GTK_SEARCH_ENTRY(app->search_entry), "Rechercher une question (énoncé, choix, matière, chapitre)...");
+    gtk_widget_set_margin_start(app->search_entry, 15);
+    gtk_widget_set_margin_end(app->search_entry, 15);
+    gtk_widget_set_margin_top(app->search_entry, 10);
+    gtk_widget_set_margin_bottom(app->search_entry, 5);
+    gtk_box_append(GTK_BOX(main_box), app->search_entry);
+    g_signal_connect(app->search_entry, "search-changed", G_CALLBACK(on_search_changed), app);
+
     GtkWidget *list_scroll = gtk_scrolled_window_new();
-    app->list_view = gtk_box_new(GTK_ORIENTATION_VERTICAL, 0);
+    app->list_view = gtk_list_view_new(GTK_SELECTION_MODEL(app->selection_model), factory);
+    gtk_widget_add_css_class(app->list_view, "question-list");
     gtk_scrolled_window_set_child(GTK_SCROLLED_WINDOW(list_scroll), app->list_view);
     gtk_box_append(GTK_BOX(main_box), list_scroll);
     gtk_widget_set_vexpand(list_scroll, TRUE);
@@ -952,13 +1559,18 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
     gtk_widget_set_halign(app->status_label, GTK_ALIGN_START);
     gtk_box_append(GTK_BOX(status_bar), app->status_label);
 
-    char count_text[100];
-    snprintf(count_text, sizeof(count_text), "%d questions dans la base", app->db.count);
-    app->count_label = gtk_label_new(count_text);
+    app->count_label = gtk_label_new(NULL);
     gtk_widget_set_halign(app->count_label, GTK_ALIGN_END);
     gtk_widget_set_hexpand(app->count_label, TRUE);
     gtk_box_append(GTK_BOX(status_bar), app->count_label);
 
+    // Les lignes déjà analysées sont affichées ; la barre disparaît à la fin du chargement
+    app->load_progress = gtk_progress_bar_new();
+    gtk_widget_set_valign(app->load_progress, GTK_ALIGN_CENTER);
+    gtk_widget_set_size_request(app->load_progress, 150, -1);
+    gtk_box_append(GTK_BOX(status_bar), app->load_progress);
+    update_loading_widgets(app, 0.0);
+
     gtk_box_append(GTK_BOX(main_box), status_bar);
 
     GtkCssProvider *provider = gtk_css_provider_new();
@@ -978,7 +1590,14 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
         "  border-color: #cbd5e1; "
         "  box-shadow: 0 2px 8px rgba(0, 0, 0, 0.05); "
         "}"
-        ".question-item.selected { "
+        ".question-list { "
+        "  background: transparent; "
+        "}"
+        ".question-list > row { "
+        "  padding: 0; "
+        "  background: transparent; "
+        "}"
+        ".question-list > row:selected .question-item { "
         "  background: #e0f2fe; "
         "  border-color: #0ea5e9; "
         "  box-shadow: 0 2px 12px rgba(14, 165, 233, 0.15); "
@@ -1019,7 +1638,6 @@ static void activate(GtkApplication *gtk_app, gpointer user_data) {
                                                 GTK_STYLE_PROVIDER(provider),
                                                 GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
 
-    refresh_question_list(app);
     show_notification(app, "Application prête - Ingénierie Informatique", "info");
 
     gtk_window_present(GTK_WINDOW(app->main_window));
@@ -1103,6 +1721,16 @@ static void show_login_window(GtkApplication *gtk_app, gpointer user_data) {
     gtk_box_append(GTK_BOX(form_box), login_button);
     
     gtk_box_append(GTK_BOX(main_box), form_box);
+
+    // La base se charge pendant la saisie du mot de passe
+    app->login_progress = gtk_progress_bar_new();
+    gtk_progress_bar_set_show_text(GTK_PROGRESS_BAR(app->login_progress), TRUE);
+    gtk_widget_set_margin_start(app->login_progress, 40);
+    gtk_widget_set_margin_end(app->login_progress, 40);
+    gtk_widget_set_margin_bottom(app->login_progress, 10);
+    gtk_box_append(GTK_BOX(main_box), app->login_progress);
+    g_object_add_weak_pointer(G_OBJECT(app->login_progress), (gpointer *)&app->login_progress);
+    update_loading_widgets(app, 0.0);
     
     GtkWidget *info_label = gtk_label_new(NULL);
     gtk_label_set_markup(GTK_LABEL(info_label), 
@@ -1171,19 +1799,34 @@ static void show_login_window(GtkApplication *gtk_app, gpointer user_data) {
 }
 
 int main(int argc, char **argv) {
-    srand(time(NULL));
+    // GENERATEUR_TRACE=fichier.json : mesure des phases, écrite à la fermeture
+    trace_set_thread_name("gtk-main");
+    int tracing = trace_start_from_env();
+    int perf = perf_counters_start_from_env(); // GENERATEUR_PERF=1 : compteurs matériels par phase
 
     AppData app = {0};
-    app.selected_question_index = -1;
-    load_database(&app.db, DB_FILE);
+    if (snapshot_publisher_init(&app.snapshots, &app.db) != 0) return 1;
+    open_database(&app);
 
     GtkApplication *gtk_app = gtk_application_new("com.generateur.epreuve.informatique", G_APPLICATION_DEFAULT_FLAGS);
     g_signal_connect(gtk_app, "activate", G_CALLBACK(show_login_window), &app);
 
     int status = g_application_run(G_APPLICATION(gtk_app), argc, argv);
 
+    if (app.search_index_ready) search_index_free(&app.search_index);
+    stop_file_watch(&app);
+    bank_loader_stop(&app);
+    snapshot_publisher_free(&app.snapshots);
     free_database(&app.db);
     g_object_unref(gtk_app);
+    if (tracing && trace_stop() != GEN_OK) {
+        g_printerr("Impossible d'ecrire la trace dans '%s'\n", g_getenv(TRACE_ENV_VAR));
+    }
+    if (perf) {
+        char report[4096];
+        perf_counters_format(report, sizeof(report));
+        g_printerr("%s", report);
+    }
 
     return status;
 }
@@ -0,0 +1,353 @@
+// json.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "json.h"
+
+// Profondeur maximale d'imbrication acceptée (un manifeste n'en a besoin que de 3)
+#define JSON_MAX_DEPTH 64
+
+typedef struct {
+    const char* text;
+    const char* p;
+    char* error;
+    size_t error_size;
+    int failed;
+} JsonParser;
+
+static void parse_error(JsonParser* parser, const char* message) {
+    if (parser->failed) return;
+    parser->failed = 1;
+    int line = 1;
+    for (const char* c = parser->text; c < parser->p; c++) {
+        if (*c == '\n') line++;
+    }
+    if (parser->error && parser->error_size > 0) {
+        snprintf(parser->error, parser->error_size, "ligne %d : %s", line, message);
+    }
+}
+
+static void skip_spaces(JsonParser* parser) {
+    while (*parser->p == ' ' || *parser->p == '\t' || *parser->p == '\n' || *parser->p == '\r') {
+        parser->p++;
+    }
+}
+
+static JsonValue* new_value(JsonParser* parser, JsonType type) {
+    JsonValue* value = calloc(1, sizeof(JsonValue));
+    if (!value) parse_error(parser, "memoire insuffisante");
+    else value->type = type;
+    return value;
+}
+
+static int hex_digit(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static int read_hex4(const char* p) {
+    int code = 0;
+    for (int i = 0; i < 4; i++) {
+        int d = hex_digit(p[i]);
+        if (d < 0) return -1;
+        code = code * 16 + d;
+    }
+    return code;
+}
+
+// Encode un point de code en UTF-8 ; retourne le nombre d'octets écrits
+static int utf8_encode(unsigned int code, char* out) {
+    if (code < 0x80) {
+        out[0] = (char)code;
+        return 1;
+    }
+    if (code < 0x800) {
+        out[0] = (char)(0xC0 | (code >> 6));
+        out[1] = (char)(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000) {
+        out[0] = (char)(0xE0 | (code >> 12));
+        out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[2] = (char)(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = (char)(0xF0 | (code >> 18));
+    out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+    out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+    out[3] = (char)(0x80 | (code & 0x3F));
+    return 4;
+}
+
+// Lit une chaîne (parser->p sur le guillemet ouvrant) ; le texte décodé n'est jamais
+// plus long que sa forme échappée, ce qui borne l'allocation.
+static char* parse_string_literal(JsonParser* parser) {
+    const char* start = ++parser->p;
+    const char* end = start;
+    while (*end && *end != '"') {
+        if (*end == '\\' && end[1]) end++;
+        end++;
+    }
+    if (*end != '"') {
+        parse_error(parser, "chaine non terminee");
+        return NULL;
+    }
+
+    char* out = malloc((size_t)(end - start) + 1);
+    if (!out) {
+        parse_error(parser, "memoire insuffisante");
+        return NULL;
+    }
+    size_t len = 0;
+    const char* p = start;
+    while (p < end) {
+        if ((unsigned char)*p < 0x20) {
+            parser->p = p;
+            parse_error(parser, "caractere de controle dans une chaine");
+            free(out);
+            return NULL;
+        }
+        if (*p != '\\') {
+            out[len++] = *p++;
+            continue;
+        }
+        p++;
+        switch (*p) {
+            case '"': out[len++] = '"'; break;
+            case '\\': out[len++] = '\\'; break;
+            case '/': out[len++] = '/'; break;
+            case 'b': out[len++] = '\b'; break;
+            case 'f': out[len++] = '\f'; break;
+            case 'n': out[len++] = '\n'; break;
+            case 'r': out[len++] = '\r'; break;
+            case 't': out[len++] = '\t'; break;
+            case 'u': {
+                int code = (end - p > 4) ? read_hex4(p + 1) : -1;
+                if (code < 0) {
+                    parser->p = p;
+                    parse_error(parser, "sequence \\u invalide");
+                    free(out);
+                    return NULL;
+                }
+                p += 4;
+                unsigned int cp = (unsigned int)code;
+                // Paire de substitution UTF-16 (caractère hors du plan de base)
+                if (cp >= 0xD800 && cp <= 0xDBFF && end - p > 6 && p[1] == '\\' && p[2] == 'u') {
+                    int low = read_hex4(p + 3);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + ((unsigned int)low - 0xDC00);
+                        p += 6;
+                    }
+                }
+                if (cp >= 0xD800 && cp <= 0xDFFF) cp = 0xFFFD;
+                len += utf8_encode(cp, out + len);
+                break;
+            }
+            default:
+                parser->p = p;
+                parse_error(parser, "echappement inconnu");
+                free(out);
+                return NULL;
+        }
+        p++;
+    }
+    out[len] = 0;
+    parser->p = end + 1;
+    return out;
+}
+
+static JsonValue* parse_value(JsonParser* parser, int depth);
+
+static int append_item(JsonParser* parser, JsonValue* container, int* capacity, char* key, JsonValue* item) {
+    if (container->count >= *capacity) {
+        int new_capacity = *capacity ? *capacity * 2 : 8;
+        JsonValue** items = realloc(container->items, sizeof(JsonValue*) * new_capacity);
+        if (items) container->items = items;
+        if (items && container->type == JSON_OBJECT) {
+            char** keys = realloc(container->keys, sizeof(char*) * new_capacity);
+            if (keys) container->keys = keys;
+            else items = NULL;
+        }
+        if (!items) {
+            parse_error(parser, "memoire insuffisante");
+            free(key);
+            json_free(item);
+            return -1;
+        }
+        *capacity = new_capacity;
+    }
+    if (container->type == JSON_OBJECT) container->keys[container->count] = key;
+    container->items[container->count++] = item;
+    return 0;
+}
+
+static JsonValue* parse_container(JsonParser* parser, int depth, JsonType type) {
+    char close = (type == JSON_OBJECT) ? '}' : ']';
+    JsonValue* value = new_value(parser, type);
+    if (!value) return NULL;
+    int capacity = 0;
+
+    parser->p++;
+    skip_spaces(parser);
+    if (*parser->p == close) {
+        parser->p++;
+        return value;
+    }
+
+    while (!parser->failed) {
+        char* key = NULL;
+        skip_spaces(parser);
+        if (type == JSON_OBJECT) {
+            if (*parser->p != '"') {
+                parse_error(parser, "cle attendue");
+                break;
+            }
+            key = parse_string_literal(parser);
+            if (!key) break;
+            skip_spaces(parser);
+            if (*parser->p != ':') {
+                parse_error(parser, "':' attendu");
+                free(key);
+                break;
+            }
+            parser->p++;
+        }
+
+        JsonValue* item = parse_value(parser, depth + 1);
+        if (!item) {
+            free(key);
+            break;
+        }
+        if (append_item(parser, value, &capacity, key, item) != 0) break;
+
+        skip_spaces(parser);
+        if (*parser->p == ',') {
+            parser->p++;
+        } else if (*parser->p == close) {
+            parser->p++;
+            return value;
+        } else {
+            parse_error(parser, (type == JSON_OBJECT) ? "',' ou '}' attendu" : "',' ou ']' attendu");
+        }
+    }
+    json_free(value);
+    return NULL;
+}
+
+static JsonValue* parse_number(JsonParser* parser) {
+    char* end = NULL;
+    double number = strtod(parser->p, &end);
+    if (end == parser->p) {
+        parse_error(parser, "valeur attendue");
+        return NULL;
+    }
+    JsonValue* value = new_value(parser, JSON_NUMBER);
+    if (value) value->number = number;
+    parser->p = end;
+    return value;
+}
+
+static JsonValue* parse_value(JsonParser* parser, int depth) {
+    if (depth > JSON_MAX_DEPTH) {
+        parse_error(parser, "imbrication trop profonde");
+        return NULL;
+    }
+    skip_spaces(parser);
+    const char* p = parser->p;
+    JsonValue* value = NULL;
+
+    if (*p == '{') return parse_container(parser, depth, JSON_OBJECT);
+    if (*p == '[') return parse_container(parser, depth, JSON_ARRAY);
+    if (*p == '"') {
+        char* s = parse_string_literal(parser);
+        if (!s) return NULL;
+        value = new_value(parser, JSON_STRING);
+        if (value) value->string = s;
+        else free(s);
+        return value;
+    }
+    if (strncmp(p, "true", 4) == 0 || strncmp(p, "false", 5) == 0) {
+        value = new_value(parser, JSON_BOOL);
+        if (value) value->boolean = (*p == 't');
+        parser->p += (*p == 't') ? 4 : 5;
+        return value;
+    }
+    if (strncmp(p, "null", 4) == 0) {
+        parser->p += 4;
+        return new_value(parser, JSON_NULL);
+    }
+    if (*p == '-' || (*p >= '0' && *p <= '9')) return parse_number(parser);
+
+    parse_error(parser, "valeur attendue");
+    return NULL;
+}
+
+JsonValue* json_parse(const char* text, char* error, size_t error_size) {
+    JsonParser parser = { text, text, error, error_size, 0 };
+    if (error && error_size > 0) error[0] = 0;
+
+    JsonValue* value = parse_value(&parser, 0);
+    if (value) {
+        skip_spaces(&parser);
+        if (*parser.p) {
+            parse_error(&parser, "texte inattendu apres la fin du document");
+            json_free(value);
+            value = NULL;
+        }
+    }
+    return value;
+}
+
+void json_free(JsonValue* value) {
+    if (!value) return;
+    for (int i = 0; i < value->count; i++) {
+        json_free(value->items[i]);
+        if (value->keys) free(value->keys[i]);
+    }
+    free(value->items);
+    free(value->keys);
+    free(value->string);
+    free(value);
+}
+
+const JsonValue* json_get(const JsonValue* object, const char* key) {
+    if (!object || object->type != JSON_OBJECT) return NULL;
+    for (int i = 0; i < object->count; i++) {
+        if (strcmp(object->keys[i], key) == 0) return object->items[i];
+    }
+    return NULL;
+}
+
+const char* json_get_string(const JsonValue* object, const char* key, const char* fallback) {
+    const JsonValue* value = json_get(object, key);
+    return (value && value->type == JSON_STRING) ? value->string : fallback;
+}
+
+double json_get_number(const JsonValue* object, const char* key, double fallback) {
+    const JsonValue* value = json_get(object, key);
+    return (value && value->type == JSON_NUMBER) ? value->number : fallback;
+}
+
+int json_get_bool(const JsonValue* object, const char* key, int fallback) {
+    const JsonValue* value = json_get(object, key);
+    return (value && value->type == JSON_BOOL) ? value->boolean : fallback;
+}
+
+void json_write_string(FILE* f, const char* s) {
+    fputc('"', f);
+    for (const unsigned char* p = (const unsigned char*)(s ? s : ""); *p; p++) {
+        switch (*p) {
+            case '"': fputs("\\\"", f); break;
+            case '\\': fputs("\\\\", f); break;
+            case '\n': fputs("\\n", f); break;
+            case '\r': fputs("\\r", f); break;
+            case '\t': fputs("\\t", f); break;
+            default:
+                if (*p < 0x20) fprintf(f, "\\u%04x", *p);
+                else fputc(*p, f);
+        }
+    }
+    fputc('"', f);
+}
@@ -0,0 +1,43 @@
+// json.h - Lecture minimale de JSON (manifestes de travaux)
+#ifndef JSON_H
+#define JSON_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef enum {
+    JSON_NULL,
+    JSON_BOOL,
+    JSON_NUMBER,
+    JSON_STRING,
+    JSON_ARRAY,
+    JSON_OBJECT
+} JsonType;
+
+typedef struct JsonValue {
+    JsonType type;
+    int boolean;
+    double number;
+    char* string;                // JSON_STRING (UTF-8, échappements décodés)
+    struct JsonValue** items;    // JSON_ARRAY : éléments ; JSON_OBJECT : valeurs
+    char** keys;                 // JSON_OBJECT : clés, dans l'ordre du document
+    int count;
+} JsonValue;
+
+// Analyse un document complet. Retourne NULL en cas d'erreur et décrit la première
+// erreur rencontrée (avec sa ligne) dans error.
+JsonValue* json_parse(const char* text, char* error, size_t error_size);
+void json_free(JsonValue* value);
+
+// Valeur associée à key dans un objet, ou NULL
+const JsonValue* json_get(const JsonValue* object, const char* key);
+
+// Accès typés avec valeur par défaut si la clé est absente ou d'un autre type
+const char* json_get_string(const JsonValue* object, const char* key, const char* fallback);
+double json_get_number(const JsonValue* object, const char* key, double fallback);
+int json_get_bool(const JsonValue* object, const char* key, int fallback);
+
+// Écrit s entre guillemets en échappant les caractères spéciaux
+void json_write_string(FILE* f, const char* s);
+
+#endif
@@ -0,0 +1,43 @@
+// label_table.c
+#include <string.h>
+#include "label_table.h"
+#include "gen_status.h"
+#include "mem_track.h"
+
+void label_table_init(LabelTable* table) {
+    memset(table, 0, sizeof(*table));
+    string_map_init(&table->index);
+}
+
+void label_table_free(LabelTable* table) {
+    for (int i = 0; i < table->count; i++) {
+        mem_free(MEM_LOADER, table->pages[i / LABEL_TABLE_PAGE_SIZE][i % LABEL_TABLE_PAGE_SIZE]);
+    }
+    for (int p = 0; p < LABEL_TABLE_PAGES; p++) {
+        mem_free(MEM_LOADER, table->pages[p]);
+    }
+    string_map_free(&table->index);
+    memset(table, 0, sizeof(*table));
+}
+
+int label_table_intern(LabelTable* table, const char* label) {
+    int id;
+    if (string_map_get(&table->index, label, &id)) return id;
+    if (table->count >= LABEL_TABLE_MAX) return GEN_ERROR_INVALID_ARGUMENT;
+
+    id = table->count;
+    char*** page = &table->pages[id / LABEL_TABLE_PAGE_SIZE];
+    if (!*page && !(*page = mem_calloc(MEM_LOADER, LABEL_TABLE_PAGE_SIZE, sizeof(char*)))) {
+        return GEN_ERROR_NO_MEMORY;
+    }
+    char* copy = mem_strdup(MEM_LOADER, label);
+    if (!copy) return GEN_ERROR_NO_MEMORY;
+    if (string_map_put(&table->index, copy, id) < 0) {
+        mem_free(MEM_LOADER, copy);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    // Rangé avant d'être désigné par une question : un instantané ne voit que des libellés complets
+    (*page)[id % LABEL_TABLE_PAGE_SIZE] = copy;
+    table->count++;
+    return id;
+}
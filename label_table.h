@@ -0,0 +1,37 @@
+// label_table.h - Libellés (matière, chapitre, type) partagés par les questions d'une base
+#ifndef LABEL_TABLE_H
+#define LABEL_TABLE_H
+
+#include <stdint.h>
+#include "structures.h"
+#include "string_map.h"
+
+// Les indices tiennent sur 16 bits ; QUESTION_LABEL_INLINE (structures.h) est réservé
+#define LABEL_TABLE_MAX 65535
+#define LABEL_TABLE_PAGE_SIZE 256
+#define LABEL_TABLE_PAGES ((LABEL_TABLE_MAX + LABEL_TABLE_PAGE_SIZE - 1) / LABEL_TABLE_PAGE_SIZE)
+
+// Chaque texte n'est rangé qu'une fois, les questions le désignent par son indice.
+// Un libellé n'est ni déplacé ni retiré avant label_table_free (pages de taille fixe) :
+// les lecteurs d'un instantané (snapshot.h) lisent ceux de leurs questions pendant que la
+// base en ajoute. Seul le thread qui modifie la base ajoute ou cherche par le texte.
+struct LabelTable {
+    char** pages[LABEL_TABLE_PAGES];
+    int count;
+    StringMap index;    // Texte -> indice ; les clés sont les copies rangées dans pages
+};
+
+void label_table_init(LabelTable* table);
+void label_table_free(LabelTable* table);
+
+// Indice du libellé, ajouté s'il est nouveau. Retourne un indice (>= 0), GEN_ERROR_NO_MEMORY,
+// ou GEN_ERROR_INVALID_ARGUMENT si la table contient déjà LABEL_TABLE_MAX libellés (la
+// question garde alors le libellé dans son bloc).
+int label_table_intern(LabelTable* table, const char* label);
+
+// Texte du libellé d'indice id (id < table->count)
+static inline const char* label_table_get(const LabelTable* table, uint16_t id) {
+    return table->pages[id / LABEL_TABLE_PAGE_SIZE][id % LABEL_TABLE_PAGE_SIZE];
+}
+
+#endif
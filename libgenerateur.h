@@ -0,0 +1,37 @@
+// libgenerateur.h - En-tête unique de la bibliothèque de génération d'épreuves
+#ifndef LIBGENERATEUR_H
+#define LIBGENERATEUR_H
+
+// Version de l'interface : le majeur change quand une signature ou une structure publique change
+#define LIBGENERATEUR_VERSION_MAJOR 6
+#define LIBGENERATEUR_VERSION_MINOR 0
+
+// Règles communes à toutes les fonctions déclarées ici :
+//  - rien n'est affiché et le programme n'est jamais quitté : les erreurs sont rendues par
+//    des codes GenStatus (gen_status.h), détaillés pour la génération dans GenerationReport ;
+//  - aucun état global caché : tout passe par des objets explicites (Database, ExamRequest,
+//    SearchIndex, SnapshotPublisher...) que l'appelant crée et libère, la mesure des
+//    phases (trace.h), les compteurs d'allocations (mem_track.h) et les compteurs
+//    matériels (perf_counters.h) étant les seuls états communs à tout le processus ;
+//  - une Database non modifiée (ou un instantané snapshot_acquire) peut servir à plusieurs
+//    threads à la fois pour la génération, la recherche de doublons et le rendu ; ses
+//    modifications restent réservées à un seul thread.
+#include "gen_status.h"
+#include "structures.h"
+#include "arena.h"
+#include "label_table.h"
+#include "database.h"
+#include "bank_watch.h"
+#include "bank_shards.h"
+#include "storage.h"
+#include "output_sink.h"
+#include "renderer.h"
+#include "generator.h"
+#include "search_index.h"
+#include "minhash.h"
+#include "snapshot.h"
+#include "mem_track.h"
+#include "perf_counters.h"
+#include "trace.h"
+
+#endif
@@ -4,10 +4,18 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <time.h>
 #include "structures.h"
 #include "database.h"
+#include "bank_watch.h"
+#include "bank_shards.h"
 #include "generator.h"
+#include "search_index.h"
+#include "minhash.h"
+#include "batch.h"
+#include "server.h"
+#include "mem_track.h"
+#include "perf_counters.h"
+#include "trace.h"
 
 #define DB_FILE "questions.txt"
 
@@ -18,13 +26,45 @@ void clean_stdin() {
     while ((c = getchar()) != '\n' && c != EOF);
 }
 
+// Matière et chapitre saisis, copiés ensuite dans la question (comptés dans MEM_LOADER)
 char* my_strdup(const char* s) {
-    if (s == NULL) return NULL;
-    size_t len = strlen(s) + 1;
-    char* new_str = malloc(len);
-    if (new_str == NULL) return NULL;
-    memcpy(new_str, s, len);
-    return new_str;
+    return mem_strdup(MEM_LOADER, s);
+}
+
+// Affiche toutes les questions (pour le débogage/vérification)
+static void print_database(const Database* db) {
+    printf("\n--- Contenu de la base de donnees (%d questions) ---\n", db->count);
+    if(db->count == 0) {
+        printf("La base de donnees est vide.\n");
+    } else {
+        for (int i = 0; i < db->count; i++) {
+            const Question* q = &db->questions[i];
+            printf("%d. [%s - %s] (%s): %s\n", i + 1, question_matiere(db, q), question_chapitre(db, q), question_type(db, q), question_enonce(q));
+        }
+    }
+    printf("--------------------------------------------------\n");
+}
+
+// Compte rendu d'une génération, comme l'affichait le générateur
+static void print_generation_report(const ExamRequest* request, int result) {
+    const GenerationReport* report = request->report;
+    if (result == GEN_OK) {
+        printf("\n=== EPREUVE GENEREE AVEC SUCCES ===\n");
+        for (int i = 0; i < report->nb_files; i++) {
+            const char* extension = strrchr(report->files[i], '.');
+            printf("Fichier : %s\n", report->files[i]);
+            printf("Format : %s\n", extension ? extension + 1 : "");
+        }
+        printf("Type : %s\n", request->exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement (20 questions)" : "Mixte (10 QCM + 1 Exercice)");
+        printf("===================================\n\n");
+    } else if (result == GEN_ERROR_NOT_ENOUGH_QUESTIONS) {
+        printf("\n=== ERREUR DE GENERATION ===\n");
+        printf("%s.\n", report->message);
+        printf("\nVeuillez ajouter plus de questions uniques pour cette matiere dans la base de donnees.\n");
+        printf("============================\n\n");
+    } else {
+        printf("Erreur de generation : %s\n", report->message[0] ? report->message : gen_status_message(result));
+    }
 }
 
 char* select_or_create_string(char** existing_items, int count, const char* prompt) {
@@ -54,22 +94,184 @@ char* select_or_create_string(char** existing_items, int count, const char* prom
     }
 }
 
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage : %s [--db fichier] [--split dossier | --jobs manifeste.json | --serve socket] [--threads N] [--queue N]\n", program);
+    fprintf(stderr, "  --db fichier      Base de questions (defaut : %s), ou repertoire d'une base decoupee\n", DB_FILE);
+    fprintf(stderr, "  --split dossier   Ecrit la base dans dossier, un fichier par matiere avec un manifeste,\n");
+    fprintf(stderr, "                    puis quitte (a utiliser ensuite avec --db dossier)\n");
+    fprintf(stderr, "  --jobs fichier    Genere sans interaction les epreuves du manifeste JSON\n");
+    fprintf(stderr, "                    et affiche un resume JSON sur la sortie standard\n");
+    fprintf(stderr, "  --serve socket    Reste en memoire et genere a la demande sur une socket Unix\n");
+    fprintf(stderr, "  --threads N       Nombre de threads de generation (defaut : un par coeur)\n");
+    fprintf(stderr, "  --queue N         Connexions en attente avant de refuser d'accepter (defaut : 4 par thread)\n");
+    fprintf(stderr, "  --trace fichier   Mesure les phases et les ecrit au format Chrome trace (JSON) en sortant\n");
+    fprintf(stderr, "                    (ou variable d'environnement %s)\n", TRACE_ENV_VAR);
+    fprintf(stderr, "  --mem-report      Affiche les allocations par sous-systeme apres le chargement et en sortant\n");
+    fprintf(stderr, "  --perf-counters   Releve cycles, instructions, defauts de cache et de branche par phase\n");
+    fprintf(stderr, "                    (Linux, ou variable d'environnement %s)\n", PERF_ENV_VAR);
+}
+
+// Affiche l'occupation mémoire par sous-système (mem_track.h)
+// et, si db est fournie, le remplissage de l'arène de ses questions
+static void print_memory_report(FILE* f, const Database* db) {
+    char report[1024];
+    mem_track_format(report, sizeof(report), db ? db->count : 0);
+    fprintf(f, "\n--- Memoire ---\n%s", report);
+    if (db) {
+        fprintf(f, "Arene : %d regions, %zu Ko reserves, %zu Ko utilises, %zu Ko liberes\n",
+                db->arena.nb_chunks, db->arena.reserved_bytes / 1024, db->arena.used_bytes / 1024,
+                db->arena.free_bytes / 1024);
+    }
+}
+
+// Active les compteurs matériels demandés ; sans eux, le programme fonctionne normalement
+static int start_perf_counters(int requested) {
+    const char* env = getenv(PERF_ENV_VAR);
+    if (!requested && !(env && env[0])) return 0;
+    if (perf_counters_start() == GEN_OK) return 1;
+    fprintf(stderr, "AVERTISSEMENT: compteurs materiels indisponibles "
+                    "(perf_event_open refuse, voir /proc/sys/kernel/perf_event_paranoid)\n");
+    return 0;
+}
+
+// Affiche les compteurs matériels cumulés par phase (perf_counters.h)
+static void print_perf_report(FILE* f) {
+    char report[4096];
+    perf_counters_format(report, sizeof(report));
+    fprintf(f, "\n--- Compteurs materiels ---\n%s", report);
+}
+
+// Applique les modifications du fichier faites par un autre programme (bank_watch.h)
+static void apply_external_changes(BankWatch* watch, Database* db) {
+    if (!bank_watch_poll(watch)) return;
+    BankReloadStats stats;
+    int status = bank_watch_reload(watch, db, &stats);
+    if (status != GEN_OK) {
+        printf("\nAVERTISSEMENT: Rechargement de la base interrompu : %s\n", gen_status_message(status));
+    } else if (stats.added + stats.updated + stats.removed > 0) {
+        printf("\nFichier modifie : %d question(s) ajoutee(s), %d modifiee(s), %d supprimee(s).\n",
+               stats.added, stats.updated, stats.removed);
+    }
+}
+
+// Base découpée : les commandes qui parcourent toute la base chargent d'abord toutes les matières
+static void require_whole_database(Database* db) {
+    int status = database_require_all(db);
+    if (status != GEN_OK) printf("AVERTISSEMENT: Matieres non chargees : %s\n", gen_status_message(status));
+}
+
+// Découpe db_file en un fichier par matière dans directory (bank_shards.h)
+static int split_database(const char* db_file, const char* directory) {
+    Database db = {0};
+    int status = load_database(&db, db_file);
+    if (status == GEN_OK) status = database_require_all(&db);
+    if (status == GEN_OK) status = bank_shards_save(&db, directory);
+    if (status == GEN_OK) {
+        printf("Base '%s' decoupee dans '%s' : %d questions.\n", db_file, directory, db.count);
+    } else {
+        fprintf(stderr, "Erreur : decoupage de '%s' dans '%s' : %s\n", db_file, directory, gen_status_message(status));
+    }
+    free_database(&db);
+    return status == GEN_OK ? 0 : 1;
+}
+
+// Écrit la mesure des phases si elle a été demandée
+static void finish_trace(int tracing) {
+    if (!tracing) return;
+    int status = trace_stop();
+    if (status != GEN_OK) fprintf(stderr, "Erreur d'ecriture de la trace : %s\n", gen_status_message(status));
+}
+
 // --- Fonction Principale ---
 
-int main() {
-    srand(time(NULL));
+int main(int argc, char** argv) {
+    const char* db_file = DB_FILE;
+    const char* jobs_file = NULL;
+    const char* socket_path = NULL;
+    const char* split_directory = NULL;
+    int nb_threads = 0;
+    int queue_size = 0;
+    const char* trace_file = NULL;
+    int mem_report = 0;
+    int perf_requested = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--db") == 0 && i + 1 < argc) {
+            db_file = argv[++i];
+        } else if (strcmp(argv[i], "--jobs") == 0 && i + 1 < argc) {
+            jobs_file = argv[++i];
+        } else if (strcmp(argv[i], "--serve") == 0 && i + 1 < argc) {
+            socket_path = argv[++i];
+        } else if (strcmp(argv[i], "--split") == 0 && i + 1 < argc) {
+            split_directory = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            nb_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--queue") == 0 && i + 1 < argc) {
+            queue_size = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            trace_file = argv[++i];
+        } else if (strcmp(argv[i], "--mem-report") == 0) {
+            mem_report = 1;
+        } else if (strcmp(argv[i], "--perf-counters") == 0) {
+            perf_requested = 1;
+        } else {
+            print_usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((jobs_file != NULL) + (socket_path != NULL) + (split_directory != NULL) > 1) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    if (split_directory) return split_database(db_file, split_directory);
+
+    trace_set_thread_name("main");
+    int tracing = trace_file ? trace_start(trace_file) == GEN_OK : trace_start_from_env();
+    int perf = start_perf_counters(perf_requested);
+    if (jobs_file || socket_path) {
+        int code = jobs_file ? run_batch_jobs(db_file, jobs_file, nb_threads)
+                             : run_exam_server(db_file, socket_path, nb_threads, queue_size);
+        if (mem_report) print_memory_report(stderr, NULL); // Base déjà libérée : seuls les pics comptent
+        if (perf) print_perf_report(stderr);
+        finish_trace(tracing);
+        return code;
+    }
+
     Database db = {0};
-    load_database(&db, DB_FILE);
-    printf("Base de donnees '%s' chargee. %d questions trouvees.\n", DB_FILE, db.count);
+    SearchIndex search;
+    int search_ready = 0;
+    int status = load_database(&db, db_file);
+    if (status == GEN_ERROR_IO) {
+        printf("AVERTISSEMENT: Fichier '%s' non trouve. Une base de donnees vide sera utilisee.\n", db_file);
+    } else if (status != GEN_OK) {
+        printf("AVERTISSEMENT: Chargement de '%s' interrompu : %s\n", db_file, gen_status_message(status));
+    }
+    if (db.shards) {
+        printf("Base decoupee '%s' : %d questions, %d matieres chargees a la demande.\n", db_file,
+               database_total_count(&db), db.shards->count);
+    } else {
+        printf("Base de donnees '%s' chargee. %d questions trouvees.\n", db_file, db.count);
+    }
+    if (mem_report) print_memory_report(stdout, &db);
+
+    // Une base chargée en partie ne correspond pas au fichier : pas de rechargement à chaud.
+    // Une base découpée n'est pas surveillée non plus (un fichier par matière), ni une base
+    // SQLite (modifiée en place, storage.h).
+    BankWatch watch;
+    int watching = (status == GEN_OK || status == GEN_ERROR_IO) && !db.shards && !db.storage &&
+                   bank_watch_init(&watch, &db, db_file) == GEN_OK;
 
     int choix;
     do {
+        if (watching) apply_external_changes(&watch, &db);
         printf("\n GENERATEUR D'EPREUVES - MENU PRINCIPAL \n");
         printf("1. Ajouter une question\n");
         printf("2. Lister toutes les questions\n");
         printf("3. Supprimer une question\n");
         printf("4. Modifier une question\n");
         printf("5. Generer une epreuve\n");
+        printf("6. Rechercher des questions\n");
+        printf("7. Detecter les questions quasi identiques\n");
+        printf("8. Afficher l'occupation memoire\n");
         printf("\n");
         printf("9. Sauvegarder et Quitter\n");
         printf("0. Quitter sans sauvegarder\n");
@@ -81,42 +283,55 @@ int main() {
         switch(choix) {
             case 1: { // AJOUTER
                 // ... (Ce code est d�j� bon et ne change pas) ...
-                Question q = {0}; char buffer[1024];
+                Question q = {0}; char buffer[1024], type[100], choices_line[1024];
+                const char* choices[QUESTION_MAX_CHOICES]; int nb_choices = 0, bonne_reponse = -1;
                 int subject_count = 0; char** subjects = get_unique_subjects(&db, &subject_count);
-                q.matiere = select_or_create_string(subjects, subject_count, "Matiere");
+                char* matiere = select_or_create_string(subjects, subject_count, "Matiere");
                 free_string_array(subjects, subject_count);
-                if (!q.matiere) break;
-                int chapter_count = 0; char** chapters = get_unique_chapters(&db, q.matiere, &chapter_count);
-                q.chapitre = select_or_create_string(chapters, chapter_count, "Chapitre");
+                if (!matiere) break;
+                int chapter_count = 0; char** chapters = get_unique_chapters(&db, matiere, &chapter_count);
+                char* chapitre = select_or_create_string(chapters, chapter_count, "Chapitre");
                 free_string_array(chapters, chapter_count);
-                if (!q.chapitre) { free(q.matiere); break; }
-                printf("Type (QCM/Ouverte) : "); fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0; q.type = my_strdup(buffer);
-                printf("Enonce : "); fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0; q.enonce = my_strdup(buffer);
-                if (strcmp(q.type, "QCM") == 0) {
-                    printf("Choix (separes par |) : "); fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
-                    char* p_choix = strtok(buffer, "|");
-                    while(p_choix) {
-                        q.choix = realloc(q.choix, sizeof(char*) * (q.nbChoix + 1)); q.choix[q.nbChoix++] = my_strdup(p_choix); p_choix = strtok(NULL, "|");
+                if (!chapitre) { mem_free(MEM_LOADER, matiere); break; }
+                printf("Type (QCM/Ouverte) : "); fgets(type, sizeof(type), stdin); type[strcspn(type, "\n")] = 0;
+                printf("Enonce : "); fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
+                if (strcmp(type, "QCM") == 0) {
+                    printf("Choix (separes par |) : "); fgets(choices_line, sizeof(choices_line), stdin); choices_line[strcspn(choices_line, "\n")] = 0;
+                    char* p_choix = strtok(choices_line, "|");
+                    while(p_choix && nb_choices < QUESTION_MAX_CHOICES) {
+                        choices[nb_choices++] = p_choix; p_choix = strtok(NULL, "|");
                     }
-                    printf("Numero de la bonne reponse (commence a 1) : "); scanf("%d", &q.bonneReponse); q.bonneReponse--; clean_stdin();
-                } else { q.bonneReponse = -1; }
-                add_question_to_db(&db, q); printf("Question ajoutee avec succes !\n");
+                    printf("Numero de la bonne reponse (commence a 1) : "); scanf("%d", &bonne_reponse); bonne_reponse--; clean_stdin();
+                }
+                // La question est copiée dans un seul bloc : les saisies restent à libérer
+                int status = question_init(&q, matiere, chapitre, type, buffer, choices, nb_choices, bonne_reponse, 0);
+                mem_free(MEM_LOADER, matiere); mem_free(MEM_LOADER, chapitre);
+                if (status == GEN_OK) status = add_question_to_db(&db, q);
+                if (status == GEN_OK) { printf("Question ajoutee avec succes !\n"); }
+                else { printf("Erreur : memoire insuffisante.\n"); free_question_content(&q); }
                 break;
             }
             case 2: { // LISTER
+                require_whole_database(&db);
                 print_database(&db);
                 break;
             }
             case 3: { // SUPPRIMER
                  // ... (Ce code est d�j� bon et ne change pas) ...
+                require_whole_database(&db);
                 if (db.count == 0) { printf("La base de donnees est vide.\n"); break; }
                 print_database(&db); printf("Entrez le numero de la question a supprimer (1 a %d) : ", db.count);
                 int num_to_delete; scanf("%d", &num_to_delete); clean_stdin();
-                if (num_to_delete > 0 && num_to_delete <= db.count) { delete_question_from_db(&db, num_to_delete - 1); }
+                if (num_to_delete > 0 && num_to_delete <= db.count) {
+                    int status = delete_question_from_db(&db, num_to_delete - 1);
+                    if (status == GEN_OK) printf("Question supprimee avec succes.\n");
+                    else printf("Erreur : %s.\n", gen_status_message(status));
+                }
                 else { printf("Numero invalide.\n"); }
                 break;
             }
             case 4: { // MODIFIER (VERSION COMPL�TE)
+                require_whole_database(&db);
                 if (db.count == 0) { printf("La base de donnees est vide.\n"); break; }
                 print_database(&db);
                 printf("Entrez le numero de la question a modifier (1 a %d) : ", db.count);
@@ -127,105 +342,147 @@ int main() {
                     printf("Numero invalide.\n");
                     break;
                 }
-                Question* q_ptr = &db.questions[num_to_edit - 1];
-                Question old_q = *q_ptr; // On fait une copie de l'ancienne question
+                const Question* old_q = &db.questions[num_to_edit - 1];
+                Question new_q = {0};
 
                 printf("\n Modification de la question %d   \n", num_to_edit);
                 printf("Laissez une reponse vide pour conserver la valeur actuelle.\n\n");
 
-                char buffer[1024];
+                char enonce[1024], type[1024], buffer[1024];
+                const char* choices[QUESTION_MAX_CHOICES];
+                int nb_choices = 0;
+                int bonne_reponse = -1;
 
-                // --- Modification de l'�nonc� ---
-                printf("Nouvel enonce (actuel: %s) : ", old_q.enonce);
+                // --- Modification de l'énoncé ---
+                printf("Nouvel enonce (actuel: %s) : ", question_enonce(old_q));
                 fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
-                if (strlen(buffer) == 0) { // L'utilisateur n'a rien tap�
-                    strcpy(buffer, old_q.enonce); // On garde l'ancien
-                }
-                q_ptr->enonce = my_strdup(buffer);
+                snprintf(enonce, sizeof(enonce), "%s", strlen(buffer) == 0 ? question_enonce(old_q) : buffer);
 
                 // --- Modification du type ---
-                printf("Nouveau type (actuel: %s) [QCM/Ouverte] : ", old_q.type);
+                printf("Nouveau type (actuel: %s) [QCM/Ouverte] : ", question_type(&db, old_q));
                 fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
-                if (strlen(buffer) == 0) {
-                    strcpy(buffer, old_q.type);
-                }
-                q_ptr->type = my_strdup(buffer);
+                snprintf(type, sizeof(type), "%s", strlen(buffer) == 0 ? question_type(&db, old_q) : buffer);
 
-                // --- Modification des choix et de la r�ponse ---
-                if (strcmp(q_ptr->type, "QCM") == 0) {
+                // --- Modification des choix et de la réponse ---
+                if (strcmp(type, "QCM") == 0) {
                     printf("Nouveaux choix separes par | (laissez vide pour garder les anciens) : ");
                     fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
 
-                    // Lib�re les anciens choix s'il y en avait
-                    for(int i = 0; i < old_q.nbChoix; i++) free(old_q.choix[i]);
-                    free(old_q.choix);
-                    q_ptr->choix = NULL;
-                    q_ptr->nbChoix = 0;
-
-                    if (strlen(buffer) > 0) { // L'utilisateur a entr� de nouveaux choix
+                    if (strlen(buffer) > 0) { // L'utilisateur a entré de nouveaux choix
                         char* p_choix = strtok(buffer, "|");
-                        while(p_choix) {
-                           q_ptr->choix = realloc(q_ptr->choix, sizeof(char*) * (q_ptr->nbChoix + 1));
-                           q_ptr->choix[q_ptr->nbChoix++] = my_strdup(p_choix);
+                        while(p_choix && nb_choices < QUESTION_MAX_CHOICES) {
+                           choices[nb_choices++] = p_choix;
                            p_choix = strtok(NULL, "|");
                         }
                     } else { // Garder les anciens choix
-                        q_ptr->choix = old_q.choix;
-                        q_ptr->nbChoix = old_q.nbChoix;
-                        old_q.choix = NULL; // �vite la double lib�ration
+                        for (int i = 0; i < old_q->nbChoix; i++) {
+                           choices[nb_choices++] = question_choice(old_q, i);
+                        }
                     }
 
-                    printf("Nouvelle bonne reponse (actuel: %d) : ", old_q.bonneReponse + 1);
-                    fgets(buffer, sizeof(buffer), stdin); buffer[strcspn(buffer, "\n")] = 0;
-                    if (strlen(buffer) > 0) {
-                        q_ptr->bonneReponse = atoi(buffer) - 1;
-                    } else {
-                        q_ptr->bonneReponse = old_q.bonneReponse;
-                    }
+                    printf("Nouvelle bonne reponse (actuel: %d) : ", old_q->bonneReponse + 1);
+                    char answer[32];
+                    fgets(answer, sizeof(answer), stdin); answer[strcspn(answer, "\n")] = 0;
+                    bonne_reponse = (strlen(answer) > 0) ? atoi(answer) - 1 : old_q->bonneReponse;
+                }
 
-                } else { // C'est une question ouverte
-                    // Si c'�tait un QCM avant, on nettoie
-                    for(int i = 0; i < old_q.nbChoix; i++) free(old_q.choix[i]);
-                    free(old_q.choix);
-                    q_ptr->choix = NULL;
-                    q_ptr->nbChoix = 0;
-                    q_ptr->bonneReponse = -1;
+                // La matière, le chapitre et le barème sont conservés
+                if (question_init(&new_q, question_matiere(&db, old_q), question_chapitre(&db, old_q), type, enonce, choices, nb_choices,
+                                  bonne_reponse, old_q->points) != GEN_OK) {
+                    printf("Erreur : memoire insuffisante.\n");
+                    break;
                 }
 
-                // --- Lib�rer le reste de l'ancienne question ---
-                free(old_q.matiere);
-                free(old_q.chapitre);
-                free(old_q.type);
-                free(old_q.enonce);
-                // Si on a gard� les choix, old_q.choix a �t� mis � NULL
-                // sinon, on les a d�j� lib�r�s plus haut.
-                free(old_q.choix);
-
-                // Pour la mati�re et le chapitre, on garde simplement les anciens pour l'instant
-                // L'ajout d'un menu de s�lection ici est possible mais complexifierait davantage.
-                q_ptr->matiere = my_strdup(db.questions[num_to_edit - 1].matiere);
-                q_ptr->chapitre = my_strdup(db.questions[num_to_edit - 1].chapitre);
-
-                printf("Question modifiee avec succes.\n");
+                // Le remplacement passe par la base pour que l'index de recherche soit prévenu
+                int status = update_question_in_db(&db, num_to_edit - 1, new_q);
+                if (status == GEN_OK) printf("Question mise a jour avec succes.\n");
+                else printf("Erreur : %s.\n", gen_status_message(status));
                 break;
             }
             case 5: { // GENERER EPREUVE
-                // ... (Pas de changement) ...
-                char matiere[100], chapitre[100], filename[100]; int nbQCM, nbOuvertes;
+                char matiere[100], chapitre[100], filename[100], format[64]; int type;
                 printf("Matiere de l'epreuve : "); fgets(matiere, sizeof(matiere), stdin); matiere[strcspn(matiere, "\n")] = 0;
                 printf("Chapitre (laisser vide pour tous les chapitres) : "); fgets(chapitre, sizeof(chapitre), stdin); chapitre[strcspn(chapitre, "\n")] = 0;
-                printf("Nombre de QCM : "); scanf("%d", &nbQCM); clean_stdin();
-                printf("Nombre de questions ouvertes : "); scanf("%d", &nbOuvertes); clean_stdin();
-                printf("Nom du fichier de sortie (ex: epreuve_maths.txt) : "); fgets(filename, sizeof(filename), stdin); filename[strcspn(filename, "\n")] = 0;
-                generate_exam(&db, matiere, chapitre, nbQCM, nbOuvertes, filename);
+                printf("Type d'epreuve (1. QCM uniquement - 20 questions, 2. Mixte - 10 QCM + 1 exercice) : ");
+                if (scanf("%d", &type) != 1) { type = -1; }
+                clean_stdin();
+                if (type != 1 && type != 2) { printf("Type invalide.\n"); break; }
+                printf("Format (TXT, PDF, HTML, MD ; plusieurs separes par des virgules) : "); fgets(format, sizeof(format), stdin); format[strcspn(format, "\n")] = 0;
+                if (strlen(format) == 0) strcpy(format, "PDF");
+                printf("Nom du fichier de sortie (ex: epreuve_maths) : "); fgets(filename, sizeof(filename), stdin); filename[strcspn(filename, "\n")] = 0;
+                GenerationReport report;
+                ExamRequest request = {0};
+                request.matiere = matiere;
+                request.chapitre = chapitre;
+                request.exam_type = type == 1 ? EXAM_TYPE_QCM_ONLY : EXAM_TYPE_MIXED;
+                request.report = &report;
+                int loaded = database_require_subject(&db, matiere);
+                if (loaded != GEN_OK) printf("AVERTISSEMENT: Matiere non chargee : %s\n", gen_status_message(loaded));
+                print_generation_report(&request, generate_exam_files(&db, &request, filename, format));
+                break;
+            }
+            case 6: { // RECHERCHER
+                char query[256];
+                printf("Texte a rechercher (enonce, choix, matiere, chapitre) : ");
+                fgets(query, sizeof(query), stdin); query[strcspn(query, "\n")] = 0;
+
+                // L'index est construit à la première recherche, puis suit les modifications de la base
+                if (!search_ready) {
+                    require_whole_database(&db);
+                    if (search_index_init(&search) != 0) { printf("Memoire insuffisante pour la recherche.\n"); break; }
+                    if (search_index_build(&search, &db) != 0 || search_index_attach(&search, &db) != GEN_OK) {
+                        search_index_free(&search);
+                        printf("Memoire insuffisante pour la recherche.\n");
+                        break;
+                    }
+                    search_ready = 1;
+                }
+
+                int* ids = NULL;
+                int count = search_index_query(&search, &db, query, &ids);
+                if (count < 0) { printf("Entrez au moins un mot de 3 lettres.\n"); break; }
+                printf("\n--- %d question(s) trouvee(s) ---\n", count);
+                for (int i = 0; i < count; i++) {
+                    int index = database_find_by_id(&db, ids[i]);
+                    if (index < 0) continue; // Identifiant d'un index devenu incomplet
+                    const Question* q = &db.questions[index];
+                    printf("%d. [%s - %s] (%s): %s\n", index + 1, question_matiere(&db, q), question_chapitre(&db, q),
+                           question_type(&db, q), question_enonce(q));
+                }
+                printf("--------------------------------------------------\n");
+                free(ids);
+                break;
+            }
+            case 7: { // QUASI-DOUBLONS
+                require_whole_database(&db);
+                NearDuplicatePair* pairs = NULL;
+                int count = find_near_duplicates(&db, NEAR_DUPLICATE_MIN_MATCHES, &pairs);
+                if (count < 0) { printf("Erreur : %s.\n", gen_status_message(count)); break; }
+                printf("\n--- %d paire(s) de questions quasi identiques ---\n", count);
+                for (int i = 0; i < count; i++) {
+                    const Question* a = &db.questions[pairs[i].first];
+                    const Question* b = &db.questions[pairs[i].second];
+                    printf("[%d%%] %d. [%s - %s] %s\n", pairs[i].matches * 100 / MINHASH_SIZE,
+                           pairs[i].first + 1, question_matiere(&db, a), question_chapitre(&db, a), question_enonce(a));
+                    printf("       %d. [%s - %s] %s\n", pairs[i].second + 1, question_matiere(&db, b),
+                           question_chapitre(&db, b), question_enonce(b));
+                }
+                printf("--------------------------------------------------\n");
+                free(pairs);
                 break;
             }
             case 9: { // SAUVEGARDER ET QUITTER
-                save_database(&db, DB_FILE);
-                printf("Base de donnees sauvegardee dans '%s'.\n", DB_FILE);
+                if (save_database(&db, db_file) != GEN_OK) {
+                    printf("Erreur : impossible de sauvegarder la base dans '%s'.\n", db_file);
+                    break;
+                }
+                printf("Base de donnees sauvegardee dans '%s'.\n", db_file);
                 choix = 0;
                 break;
             }
+            case 8:
+                print_memory_report(stdout, &db);
+                break;
             case 0:
                 printf("Au revoir ! (Les modifications non sauvegardees seront perdues)\n");
                 break;
@@ -236,6 +493,11 @@ int main() {
 
     } while (choix != 0);
 
+    if (mem_report) print_memory_report(stdout, &db);
+    if (perf) print_perf_report(stdout);
+    if (search_ready) search_index_free(&search);
+    if (watching) bank_watch_free(&watch);
     free_database(&db);
+    finish_trace(tracing);
     return 0;
 }
@@ -0,0 +1,162 @@
+// mem_track.c
+#include <stdio.h>
+#include <stdatomic.h>
+#include "mem_track.h"
+
+#ifndef GEN_NO_MEM_TRACK
+
+#if defined(__GLIBC__)
+    #include <malloc.h>
+    #define BLOCK_SIZE(p) malloc_usable_size(p)
+#elif defined(_WIN32)
+    #include <malloc.h>
+    #define BLOCK_SIZE(p) _msize(p)
+#else
+    #include <malloc/malloc.h>
+    #define BLOCK_SIZE(p) malloc_size(p)
+#endif
+
+// Compteurs d'un sous-système, chacun sur sa ligne de cache : les threads de génération
+// n'écrivent pas sur les compteurs du chargement
+typedef struct {
+    _Alignas(64) atomic_llong allocations;
+    atomic_llong frees;
+    atomic_llong live_bytes;
+    atomic_llong peak_bytes;
+} MemCounters;
+
+static MemCounters counters[MEM_SUBSYSTEM_COUNT];
+static MemCounters total;
+
+static void raise_peak(atomic_llong* peak, long long live) {
+    long long current = atomic_load_explicit(peak, memory_order_relaxed);
+    while (live > current &&
+           !atomic_compare_exchange_weak_explicit(peak, &current, live, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void count_bytes(MemSubsystem s, long long delta) {
+    long long live = atomic_fetch_add_explicit(&counters[s].live_bytes, delta, memory_order_relaxed) + delta;
+    long long all = atomic_fetch_add_explicit(&total.live_bytes, delta, memory_order_relaxed) + delta;
+    if (delta > 0) {
+        raise_peak(&counters[s].peak_bytes, live);
+        raise_peak(&total.peak_bytes, all);
+    }
+}
+
+static void count_allocation(MemSubsystem s, void* p) {
+    atomic_fetch_add_explicit(&counters[s].allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&total.allocations, 1, memory_order_relaxed);
+    count_bytes(s, (long long)BLOCK_SIZE(p));
+}
+
+void* mem_alloc(MemSubsystem s, size_t size) {
+    void* p = malloc(size);
+    if (p) count_allocation(s, p);
+    return p;
+}
+
+void* mem_calloc(MemSubsystem s, size_t n, size_t size) {
+    void* p = calloc(n, size);
+    if (p) count_allocation(s, p);
+    return p;
+}
+
+void* mem_realloc(MemSubsystem s, void* p, size_t size) {
+    if (!p) return mem_alloc(s, size);
+    long long old_size = (long long)BLOCK_SIZE(p);
+    void* grown = realloc(p, size);
+    if (!grown) return NULL; // p reste alloué, rien ne change
+    if (grown != p) { // Bloc déplacé : une allocation et une libération
+        atomic_fetch_add_explicit(&counters[s].allocations, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&total.allocations, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&counters[s].frees, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&total.frees, 1, memory_order_relaxed);
+    }
+    count_bytes(s, (long long)BLOCK_SIZE(grown) - old_size);
+    return grown;
+}
+
+void mem_free(MemSubsystem s, void* p) {
+    if (!p) return;
+    atomic_fetch_add_explicit(&counters[s].frees, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&total.frees, 1, memory_order_relaxed);
+    count_bytes(s, -(long long)BLOCK_SIZE(p));
+    free(p);
+}
+
+int mem_track_enabled(void) {
+    return 1;
+}
+
+void mem_track_get(MemSubsystem s, MemStats* out) {
+    const MemCounters* c = (s == MEM_SUBSYSTEM_COUNT) ? &total : &counters[s];
+    out->allocations = atomic_load_explicit(&c->allocations, memory_order_relaxed);
+    out->frees = atomic_load_explicit(&c->frees, memory_order_relaxed);
+    out->live_bytes = atomic_load_explicit(&c->live_bytes, memory_order_relaxed);
+    out->peak_bytes = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+}
+
+#else
+
+int mem_track_enabled(void) {
+    return 0;
+}
+
+void mem_track_get(MemSubsystem s, MemStats* out) {
+    (void)s;
+    memset(out, 0, sizeof(*out));
+}
+
+#endif
+
+char* mem_strdup(MemSubsystem s, const char* str) {
+    if (str == NULL) return NULL;
+    size_t len = strlen(str) + 1;
+    char* copy = mem_alloc(s, len);
+    if (copy) memcpy(copy, str, len);
+    return copy;
+}
+
+const char* mem_subsystem_name(MemSubsystem s) {
+    switch (s) {
+        case MEM_LOADER: return "chargement";
+        case MEM_INDEX: return "index";
+        case MEM_GENERATOR: return "generation";
+        case MEM_GUI: return "interface";
+        default: return "total";
+    }
+}
+
+size_t mem_track_format(char* out, size_t size, int nb_questions) {
+    if (size == 0) return 0;
+    out[0] = 0;
+    if (!mem_track_enabled()) {
+        return (size_t)snprintf(out, size, "Comptage des allocations non disponible (GEN_NO_MEM_TRACK)\n");
+    }
+
+    size_t len = 0;
+#define APPEND(...) do { \
+        if (len < size) { \
+            int n = snprintf(out + len, size - len, __VA_ARGS__); \
+            if (n > 0) len += (size_t)n; \
+        } \
+    } while (0)
+
+    APPEND("%-12s %12s %12s %12s %12s\n", "Sous-systeme", "Allocations", "Liberations", "Vivant (Ko)", "Pic (Ko)");
+    for (int s = 0; s <= MEM_SUBSYSTEM_COUNT; s++) {
+        MemStats stats;
+        mem_track_get((MemSubsystem)s, &stats);
+        APPEND("%-12s %12lld %12lld %12.1f %12.1f\n", mem_subsystem_name((MemSubsystem)s), stats.allocations,
+               stats.frees, stats.live_bytes / 1024.0, stats.peak_bytes / 1024.0);
+    }
+    if (nb_questions > 0) {
+        MemStats loader, all;
+        mem_track_get(MEM_LOADER, &loader);
+        mem_track_get(MEM_SUBSYSTEM_COUNT, &all);
+        APPEND("Octets par question : %.1f (base), %.1f (total) pour %d questions\n",
+               (double)loader.live_bytes / nb_questions, (double)all.live_bytes / nb_questions, nb_questions);
+    }
+#undef APPEND
+    return len < size ? len : size - 1;
+}
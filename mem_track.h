@@ -0,0 +1,66 @@
+// mem_track.h - Comptage des allocations par sous-système
+#ifndef MEM_TRACK_H
+#define MEM_TRACK_H
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// La taille réelle d'un bloc est demandée à l'allocateur au moment de la libération
+// (malloc_usable_size, _msize, malloc_size) : aucun en-tête n'est ajouté aux blocs. Sans
+// cette fonction, ou avec -DGEN_NO_MEM_TRACK, les fonctions mem_* se réduisent à malloc/free.
+#if !defined(GEN_NO_MEM_TRACK) && !defined(__GLIBC__) && !defined(_WIN32) && !defined(__APPLE__)
+    #define GEN_NO_MEM_TRACK
+#endif
+
+// Un bloc doit être libéré avec le sous-système qui l'a alloué, et seuls les blocs obtenus
+// par mem_* passent par mem_free. Les résultats rendus à l'appelant pour qu'il les libère
+// avec free() (search_index_query, find_near_duplicates, output_sink_steal) ne sont pas comptés.
+typedef enum {
+    MEM_LOADER,       // Base : questions, chaînes, listes de matières et de chapitres
+    MEM_INDEX,        // Index de recherche et détection des quasi-doublons
+    MEM_GENERATOR,    // Partitions, sélections, états des rendus, StringMap et TextBuffer
+    MEM_GUI,          // File du chargement en arrière-plan, sélections de chapitres
+                      // (les allocations de GTK et GLib ne sont pas comptées)
+    MEM_SUBSYSTEM_COUNT
+} MemSubsystem;
+
+typedef struct {
+    long long allocations;   // Blocs alloués, y compris les déplacements de mem_realloc
+    long long frees;         // allocations - frees : blocs encore alloués
+    long long live_bytes;    // Octets utilisables des blocs encore alloués
+    long long peak_bytes;    // Maximum atteint par live_bytes
+} MemStats;
+
+#ifdef GEN_NO_MEM_TRACK
+
+static inline void* mem_alloc(MemSubsystem s, size_t size) { (void)s; return malloc(size); }
+static inline void* mem_calloc(MemSubsystem s, size_t n, size_t size) { (void)s; return calloc(n, size); }
+static inline void* mem_realloc(MemSubsystem s, void* p, size_t size) { (void)s; return realloc(p, size); }
+static inline void mem_free(MemSubsystem s, void* p) { (void)s; free(p); }
+
+#else
+
+void* mem_alloc(MemSubsystem s, size_t size);
+void* mem_calloc(MemSubsystem s, size_t n, size_t size);
+void* mem_realloc(MemSubsystem s, void* p, size_t size);
+void mem_free(MemSubsystem s, void* p);
+
+#endif
+
+// Copie d'une chaîne (NULL si str est NULL ou si la mémoire manque)
+char* mem_strdup(MemSubsystem s, const char* str);
+
+// Retourne 1 si le comptage est compilé, 0 sinon (les compteurs restent alors à zéro)
+int mem_track_enabled(void);
+
+// Compteurs d'un sous-système, ou de tous avec MEM_SUBSYSTEM_COUNT (pic global)
+void mem_track_get(MemSubsystem s, MemStats* out);
+
+const char* mem_subsystem_name(MemSubsystem s);
+
+// Tableau lisible des compteurs (une ligne par sous-système et le total), suivi des octets
+// par question si nb_questions > 0. Écrit au plus size - 1 octets ; retourne la longueur du texte.
+size_t mem_track_format(char* out, size_t size, int nb_questions);
+
+#endif
@@ -0,0 +1,164 @@
+// minhash.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "minhash.h"
+#include "search_index.h"
+#include "string_map.h"
+#include "mem_track.h"
+#include "trace.h"
+
+// Valeur de la fonction de hachage de la position i pour le hachage h d'un trigramme :
+// xor avec une graine puis multiplication
+static uint64_t position_hash(uint64_t h, int i) {
+    return (h ^ ((uint64_t)(i + 1) * 0xD1B54A32D192ED03ULL)) * 0x9E3779B97F4A7C15ULL;
+}
+
+void minhash_compute(const char* text, uint16_t* signature) {
+    uint64_t minimums[MINHASH_SIZE];
+    for (int i = 0; i < MINHASH_SIZE; i++) minimums[i] = UINT64_MAX;
+
+    char stack_buffer[1024];
+    if (!text) text = "";
+    size_t size = strlen(text) + 1;
+    char* folded = (size <= sizeof(stack_buffer)) ? stack_buffer : mem_alloc(MEM_INDEX, size);
+    size_t len = 0;
+    if (folded) {
+        search_fold(text, folded, size);
+
+        // Espaces consécutifs réduits à un seul : les trigrammes gardent l'ordre des mots
+        int previous_space = 1;
+        for (const char* p = folded; *p; p++) {
+            if (*p == ' ' && previous_space) continue;
+            previous_space = (*p == ' ');
+            folded[len++] = *p;
+        }
+        if (len > 0 && folded[len - 1] == ' ') len--;
+    }
+
+    if (!folded || len < MINHASH_MIN_TRIGRAMS + 2) {
+        // Énoncé court (ou mémoire insuffisante pour le replier) : le texte entier tient lieu
+        // d'unique trigramme. Deux textes différents n'ont alors en pratique aucune valeur commune.
+        uint64_t h = folded ? hash_bytes(folded, len) : hash_bytes(text, size - 1);
+        for (int i = 0; i < MINHASH_SIZE; i++) {
+            minimums[i] = position_hash(h, i);
+        }
+    } else {
+        for (size_t t = 0; t + 3 <= len; t++) {
+            uint64_t h = hash_bytes(folded + t, 3);
+            for (int i = 0; i < MINHASH_SIZE; i++) {
+                uint64_t v = position_hash(h, i);
+                if (v < minimums[i]) minimums[i] = v;
+            }
+        }
+    }
+    if (folded && folded != stack_buffer) mem_free(MEM_INDEX, folded);
+
+    // On ne garde que 16 bits de chaque minimum. Pas ceux de poids fort : un minimum
+    // est petit, ses bits de tête sont presque toujours nuls.
+    for (int i = 0; i < MINHASH_SIZE; i++) {
+        signature[i] = (uint16_t)(minimums[i] >> 32);
+    }
+}
+
+int minhash_matches(const uint16_t* a, const uint16_t* b) {
+    int matches = 0;
+    for (int i = 0; i < MINHASH_SIZE; i++) {
+        matches += (a[i] == b[i]);
+    }
+    return matches;
+}
+
+typedef struct {
+    uint64_t key;   // Valeurs de la bande concaténées
+    int index;
+} BandEntry;
+
+static uint64_t band_key(const uint16_t* signature, int band) {
+    uint64_t key = 0;
+    for (int r = 0; r < MINHASH_ROWS; r++) {
+        key = (key << 16) | signature[band * MINHASH_ROWS + r];
+    }
+    return key;
+}
+
+static int compare_band_entries(const void* a, const void* b) {
+    const BandEntry* x = a;
+    const BandEntry* y = b;
+    if (x->key != y->key) return (x->key > y->key) ? 1 : -1;
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+static int compare_pairs(const void* a, const void* b) {
+    const NearDuplicatePair* x = a;
+    const NearDuplicatePair* y = b;
+    if (x->first != y->first) return (x->first > y->first) - (x->first < y->first);
+    return (x->second > y->second) - (x->second < y->second);
+}
+
+int find_near_duplicates(const Database* db, int min_matches, NearDuplicatePair** pairs) {
+    *pairs = NULL;
+    if (db->count < 2) return 0;
+
+    BandEntry* entries = mem_alloc(MEM_INDEX, sizeof(BandEntry) * db->count);
+    if (!entries) return GEN_ERROR_NO_MEMORY;
+    uint64_t span = trace_begin();
+
+    NearDuplicatePair* result = NULL;
+    int count = 0, capacity = 0;
+
+    // Pour chaque bande, seules les questions de même clé sont comparées
+    for (int band = 0; band < MINHASH_BANDS; band++) {
+        for (int i = 0; i < db->count; i++) {
+            entries[i].key = band_key(db->questions[i].minhash, band);
+            entries[i].index = i;
+        }
+        qsort(entries, db->count, sizeof(BandEntry), compare_band_entries);
+
+        for (int start = 0; start < db->count; ) {
+            int end = start + 1;
+            while (end < db->count && entries[end].key == entries[start].key) end++;
+
+            for (int x = start; x < end; x++) {
+                for (int y = x + 1; y < end; y++) {
+                    const uint16_t* a = db->questions[entries[x].index].minhash;
+                    const uint16_t* b = db->questions[entries[y].index].minhash;
+
+                    // Paire déjà examinée si une bande précédente était identique
+                    int seen = 0;
+                    for (int previous = 0; previous < band && !seen; previous++) {
+                        seen = (band_key(a, previous) == band_key(b, previous));
+                    }
+                    if (seen) continue;
+
+                    int matches = minhash_matches(a, b);
+                    if (matches < min_matches) continue;
+
+                    if (count >= capacity) {
+                        int new_capacity = capacity ? capacity * 2 : 64;
+                        // Résultat rendu à l'appelant, libéré avec free() : non compté
+                        NearDuplicatePair* p = realloc(result, sizeof(NearDuplicatePair) * new_capacity);
+                        if (!p) {
+                            free(result);
+                            mem_free(MEM_INDEX, entries);
+                            return GEN_ERROR_NO_MEMORY;
+                        }
+                        result = p;
+                        capacity = new_capacity;
+                    }
+                    result[count].first = entries[x].index;
+                    result[count].second = entries[y].index;
+                    result[count].matches = matches;
+                    count++;
+                }
+            }
+            start = end;
+        }
+    }
+    mem_free(MEM_INDEX, entries);
+
+    if (count > 1) qsort(result, count, sizeof(NearDuplicatePair), compare_pairs);
+    trace_end(span, "find_near_duplicates");
+    *pairs = result;
+    return count;
+}
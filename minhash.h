@@ -0,0 +1,49 @@
+// minhash.h
+#ifndef MINHASH_H
+#define MINHASH_H
+
+#include <stdint.h>
+#include "structures.h"
+#include "gen_status.h"
+
+// La signature est découpée en MINHASH_BANDS bandes de MINHASH_SIZE / MINHASH_BANDS valeurs :
+// deux énoncés deviennent candidats dès qu'une bande est identique (LSH), ce qui évite
+// de comparer toutes les paires.
+#define MINHASH_BANDS 8
+#define MINHASH_ROWS (MINHASH_SIZE / MINHASH_BANDS)
+
+// Sur un énoncé court, la formule commune ("Qu'est-ce qu'un", "Quelle est la complexité de")
+// fait l'essentiel des trigrammes : "arbre AVL" et "arbre B" sembleraient identiques. En deçà
+// de MINHASH_MIN_TRIGRAMS trigrammes, la signature ne reconnaît donc que le même texte
+// (après repliement des accents, de la casse et de la ponctuation).
+#define MINHASH_MIN_TRIGRAMS 60
+
+// Version du calcul de la signature, à changer avec lui : les signatures enregistrées par
+// une autre version sont recalculées (storage_sqlite.c)
+#define MINHASH_VERSION 2
+
+// Seuil par défaut : au moins 28 valeurs sur 32 identiques, soit environ 87 % de trigrammes
+// communs. Calibré sur questions.txt : en dessous, "insertion" et "suppression dans une table
+// de hachage" passent pour des doublons.
+#define NEAR_DUPLICATE_MIN_MATCHES 28
+
+// Paire de questions quasi identiques (indices dans la base, first < second)
+typedef struct {
+    int first;
+    int second;
+    int matches;   // Valeurs identiques dans les signatures (sur MINHASH_SIZE)
+} NearDuplicatePair;
+
+// Calcule la signature d'un texte à partir de ses trigrammes de caractères, après
+// repliement des accents et de la casse (du texte entier s'il est court, voir
+// MINHASH_MIN_TRIGRAMS). La signature ne dépend que du texte.
+void minhash_compute(const char* text, uint16_t* signature);
+
+// Nombre de positions identiques entre deux signatures (estimation de la similarité x MINHASH_SIZE)
+int minhash_matches(const uint16_t* a, const uint16_t* b);
+
+// Liste les paires de questions dont les signatures ont au moins min_matches valeurs
+// communes. Remplit *pairs (à libérer par l'appelant) et retourne leur nombre, ou GEN_ERROR_NO_MEMORY.
+int find_near_duplicates(const Database* db, int min_matches, NearDuplicatePair** pairs);
+
+#endif
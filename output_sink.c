@@ -0,0 +1,175 @@
+// output_sink.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#ifdef _WIN32
+    #include <io.h>
+#else
+    #include <unistd.h>
+#endif
+#include "output_sink.h"
+#include "trace.h"
+
+static long sys_write(int fd, const void* data, size_t length) {
+#ifdef _WIN32
+    return _write(fd, data, (unsigned int)length);
+#else
+    return (long)write(fd, data, length);
+#endif
+}
+
+static void output_sink_reset(OutputSink* sink, OutputSinkType type) {
+    memset(sink, 0, sizeof(*sink));
+    sink->type = type;
+    sink->fd = -1;
+}
+
+void output_sink_init_file(OutputSink* sink, const char* path) {
+    output_sink_reset(sink, OUTPUT_SINK_FILE);
+    size_t len = strlen(path) + 1;
+    sink->path = malloc(len);
+    if (sink->path) {
+        memcpy(sink->path, path, len);
+    } else {
+        sink->error = 1;
+    }
+}
+
+void output_sink_init_memory(OutputSink* sink) {
+    output_sink_reset(sink, OUTPUT_SINK_MEMORY);
+}
+
+void output_sink_init_fd(OutputSink* sink, int fd) {
+    output_sink_reset(sink, OUTPUT_SINK_FD);
+    sink->fd = fd;
+}
+
+void output_sink_init_callback(OutputSink* sink, OutputWriteFunc write_func, void* user_data) {
+    output_sink_reset(sink, OUTPUT_SINK_CALLBACK);
+    sink->write = write_func;
+    sink->user_data = user_data;
+}
+
+int output_sink_open(OutputSink* sink) {
+    if (sink->error) return -1;
+    if (sink->type == OUTPUT_SINK_FILE && !sink->file) {
+        sink->file = fopen(sink->path, "wb");
+        if (!sink->file) {
+            sink->error = 1;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int memory_reserve(OutputSink* sink, size_t extra) {
+    if (sink->size + extra <= sink->capacity) return 0;
+    size_t new_capacity = (sink->capacity == 0) ? 4096 : sink->capacity;
+    while (new_capacity < sink->size + extra) new_capacity *= 2;
+    unsigned char* new_data = realloc(sink->data, new_capacity);
+    if (!new_data) return -1;
+    sink->data = new_data;
+    sink->capacity = new_capacity;
+    return 0;
+}
+
+int output_sink_write(OutputSink* sink, const void* data, size_t length) {
+    if (sink->error) return -1;
+    if (length == 0) return 0;
+
+    switch (sink->type) {
+        case OUTPUT_SINK_FILE: {
+            if (!sink->file && output_sink_open(sink) != 0) return -1;
+            uint64_t span = trace_begin();
+            if (fwrite(data, 1, length, sink->file) != length) sink->error = 1;
+            trace_end(span, "file_write");
+            break;
+        }
+        case OUTPUT_SINK_MEMORY:
+            if (memory_reserve(sink, length) != 0) {
+                sink->error = 1;
+                break;
+            }
+            memcpy(sink->data + sink->size, data, length);
+            sink->size += length;
+            break;
+        case OUTPUT_SINK_FD: {
+            const char* p = data;
+            while (length > 0) {
+                long n = sys_write(sink->fd, p, length);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    sink->error = 1;
+                    break;
+                }
+                p += n;
+                length -= (size_t)n;
+            }
+            break;
+        }
+        case OUTPUT_SINK_CALLBACK:
+            if (!sink->write || sink->write(sink->user_data, data, length) != 0) sink->error = 1;
+            break;
+    }
+    return sink->error ? -1 : 0;
+}
+
+int output_sink_printf(OutputSink* sink, const char* format, ...) {
+    char stack_buffer[1024];
+    va_list args;
+
+    va_start(args, format);
+    int len = vsnprintf(stack_buffer, sizeof(stack_buffer), format, args);
+    va_end(args);
+    if (len < 0) {
+        sink->error = 1;
+        return -1;
+    }
+    if ((size_t)len < sizeof(stack_buffer)) {
+        return output_sink_write(sink, stack_buffer, (size_t)len);
+    }
+
+    // Texte long (énoncé d'exercice, par exemple) : tampon temporaire à la bonne taille
+    char* heap_buffer = malloc((size_t)len + 1);
+    if (!heap_buffer) {
+        sink->error = 1;
+        return -1;
+    }
+    va_start(args, format);
+    vsnprintf(heap_buffer, (size_t)len + 1, format, args);
+    va_end(args);
+    int result = output_sink_write(sink, heap_buffer, (size_t)len);
+    free(heap_buffer);
+    return result;
+}
+
+int output_sink_close(OutputSink* sink) {
+    if (sink->type == OUTPUT_SINK_FILE && sink->file) {
+        uint64_t span = trace_begin();
+        if (fclose(sink->file) != 0) sink->error = 1;
+        trace_end(span, "file_close");
+        sink->file = NULL;
+    }
+    return sink->error ? -1 : 0;
+}
+
+unsigned char* output_sink_steal(OutputSink* sink, size_t* size) {
+    unsigned char* data = sink->data;
+    if (size) *size = sink->size;
+    sink->data = NULL;
+    sink->size = 0;
+    sink->capacity = 0;
+    return data;
+}
+
+void output_sink_free(OutputSink* sink) {
+    output_sink_close(sink);
+    free(sink->path);
+    free(sink->data);
+    sink->path = NULL;
+    sink->data = NULL;
+    sink->size = 0;
+    sink->capacity = 0;
+}
@@ -0,0 +1,55 @@
+// output_sink.h
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+// Destination d'une épreuve générée
+typedef enum {
+    OUTPUT_SINK_FILE,      // Fichier sur disque (ouvert à la première écriture)
+    OUTPUT_SINK_MEMORY,    // Tampon mémoire extensible
+    OUTPUT_SINK_FD,        // Descripteur déjà ouvert (ex: 1 pour stdout, un pipe, une socket)
+    OUTPUT_SINK_CALLBACK   // Fonction fournie par l'appelant
+} OutputSinkType;
+
+// Retourne 0 si les données ont été acceptées, une autre valeur en cas d'erreur
+typedef int (*OutputWriteFunc)(void* user_data, const unsigned char* data, size_t length);
+
+typedef struct {
+    OutputSinkType type;
+    char* path;              // OUTPUT_SINK_FILE : chemin (copie possédée par le sink)
+    FILE* file;              // OUTPUT_SINK_FILE : flux ouvert par output_sink_open()
+    int fd;                  // OUTPUT_SINK_FD
+    OutputWriteFunc write;   // OUTPUT_SINK_CALLBACK
+    void* user_data;
+    unsigned char* data;     // OUTPUT_SINK_MEMORY : contenu produit
+    size_t size;
+    size_t capacity;
+    int error;               // Mis à 1 dès qu'une écriture échoue
+} OutputSink;
+
+void output_sink_init_file(OutputSink* sink, const char* path);
+void output_sink_init_memory(OutputSink* sink);
+void output_sink_init_fd(OutputSink* sink, int fd);
+void output_sink_init_callback(OutputSink* sink, OutputWriteFunc write, void* user_data);
+
+// Prépare le sink avant la première écriture (crée le fichier pour OUTPUT_SINK_FILE)
+int output_sink_open(OutputSink* sink);
+
+// Écrit un bloc d'octets ; retourne 0 en cas de succès, -1 sinon
+int output_sink_write(OutputSink* sink, const void* data, size_t length);
+
+// Écrit une chaîne formatée à la manière de fprintf
+int output_sink_printf(OutputSink* sink, const char* format, ...);
+
+// Termine l'écriture (ferme le fichier) ; retourne -1 si une écriture a échoué
+int output_sink_close(OutputSink* sink);
+
+// Récupère le tampon d'un sink mémoire ; l'appelant devient responsable du free()
+unsigned char* output_sink_steal(OutputSink* sink, size_t* size);
+
+// Libère les ressources possédées par le sink (chemin, tampon mémoire)
+void output_sink_free(OutputSink* sink);
+
+#endif
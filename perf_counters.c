@@ -0,0 +1,265 @@
+// perf_counters.c
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "perf_counters.h"
+#include "gen_status.h"
+
+#ifndef GEN_NO_PERF_COUNTERS
+    #include <unistd.h>
+    #include <sys/syscall.h>
+    #include <linux/perf_event.h>
+#endif
+
+// Cumul d'une phase ; measured[c] vaut 1 dès qu'un thread a pu lire le compteur c
+typedef struct {
+    const char* name;
+    long long calls;
+    double sums[PERF_COUNTER_COUNT];
+    int measured[PERF_COUNTER_COUNT];
+} PhaseEntry;
+
+atomic_int perf_active;
+
+static pthread_mutex_t phases_lock = PTHREAD_MUTEX_INITIALIZER;
+static PhaseEntry phases[PERF_MAX_PHASES];
+static int nb_phases;
+
+static const char* const counter_names[PERF_COUNTER_COUNT] = {
+    "cycles", "instructions", "cache_misses", "branch_misses"
+};
+
+#ifndef GEN_NO_PERF_COUNTERS
+
+// Compteurs d'un thread, ouverts en un groupe pour être lus ensemble par un seul read()
+typedef struct {
+    int fds[PERF_COUNTER_COUNT];   // fds[PERF_CYCLES] est le meneur du groupe
+    int slot[PERF_COUNTER_COUNT];  // Position dans la lecture du groupe, -1 si non ouvert
+} ThreadCounters;
+
+// Format de lecture PERF_FORMAT_GROUP | TOTAL_TIME_ENABLED | TOTAL_TIME_RUNNING
+typedef struct {
+    uint64_t nr;
+    uint64_t time_enabled;
+    uint64_t time_running;
+    uint64_t values[PERF_COUNTER_COUNT];
+} GroupRead;
+
+static const uint64_t counter_configs[PERF_COUNTER_COUNT] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES
+};
+
+static pthread_once_t key_once = PTHREAD_ONCE_INIT;
+static pthread_key_t counters_key;
+static _Thread_local ThreadCounters* local_counters;
+static _Thread_local int local_unavailable;
+
+// Ferme les compteurs d'un thread qui se termine
+static void close_thread_counters(void* data) {
+    ThreadCounters* tc = data;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        if (tc->fds[c] >= 0) close(tc->fds[c]);
+    }
+    free(tc);
+}
+
+static void create_key(void) {
+    pthread_key_create(&counters_key, close_thread_counters);
+}
+
+static int open_counter(uint64_t config, int group_fd) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// Compteurs du thread appelant, ouverts au premier appel ; NULL si le noyau les refuse
+static ThreadCounters* thread_counters(void) {
+    if (local_counters || local_unavailable) return local_counters;
+
+    ThreadCounters* tc = malloc(sizeof(ThreadCounters));
+    int leader = open_counter(counter_configs[PERF_CYCLES], -1);
+    if (!tc || leader < 0) {
+        if (leader >= 0) close(leader);
+        free(tc);
+        local_unavailable = 1;
+        return NULL;
+    }
+    int nb_open = 0;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        tc->fds[c] = (c == PERF_CYCLES) ? leader : open_counter(counter_configs[c], leader);
+        tc->slot[c] = (tc->fds[c] >= 0) ? nb_open++ : -1; // Un processeur peut ne pas fournir un événement
+    }
+    pthread_once(&key_once, create_key);
+    pthread_setspecific(counters_key, tc);
+    local_counters = tc;
+    return tc;
+}
+
+void perf_read_sample(PerfSample* sample) {
+    sample->active = 0;
+    ThreadCounters* tc = thread_counters();
+    if (!tc) return;
+
+    GroupRead group;
+    if (read(tc->fds[PERF_CYCLES], &group, sizeof(group)) < (ssize_t)(3 * sizeof(uint64_t))) return;
+    sample->enabled_ns = group.time_enabled;
+    sample->running_ns = group.time_running;
+    for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+        sample->values[c] = (tc->slot[c] >= 0) ? group.values[tc->slot[c]] : 0;
+    }
+    sample->active = 1;
+}
+
+static PhaseEntry* find_phase(const char* name) {
+    for (int i = 0; i < nb_phases; i++) {
+        if (phases[i].name == name || strcmp(phases[i].name, name) == 0) return &phases[i];
+    }
+    if (nb_phases == PERF_MAX_PHASES) return NULL;
+    PhaseEntry* phase = &phases[nb_phases++];
+    memset(phase, 0, sizeof(*phase));
+    phase->name = name;
+    return phase;
+}
+
+void perf_record(const PerfSample* start, const char* name) {
+    PerfSample end;
+    perf_read_sample(&end);
+    if (!end.active) return;
+    uint64_t running = end.running_ns - start->running_ns;
+    if (running == 0) return; // Groupe jamais placé sur les compteurs pendant la phase
+    double scale = (double)(end.enabled_ns - start->enabled_ns) / running;
+
+    const ThreadCounters* tc = local_counters;
+    pthread_mutex_lock(&phases_lock);
+    PhaseEntry* phase = find_phase(name);
+    if (phase) {
+        phase->calls++;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            if (tc->slot[c] < 0) continue;
+            phase->sums[c] += (double)(end.values[c] - start->values[c]) * scale;
+            phase->measured[c] = 1;
+        }
+    }
+    pthread_mutex_unlock(&phases_lock);
+}
+
+int perf_counters_start(void) {
+    if (!thread_counters()) return GEN_ERROR_IO;
+    atomic_store(&perf_active, 1);
+    return GEN_OK;
+}
+
+#else
+
+int perf_counters_start(void) {
+    return GEN_ERROR_IO;
+}
+
+#endif
+
+int perf_counters_start_from_env(void) {
+    const char* value = getenv(PERF_ENV_VAR);
+    if (!value || value[0] == 0) return 0;
+    return perf_counters_start() == GEN_OK;
+}
+
+void perf_counters_stop(void) {
+    atomic_store(&perf_active, 0);
+}
+
+int perf_counters_enabled(void) {
+    return atomic_load(&perf_active);
+}
+
+void perf_counters_reset(void) {
+    pthread_mutex_lock(&phases_lock);
+    nb_phases = 0;
+    pthread_mutex_unlock(&phases_lock);
+}
+
+int perf_counters_get(PerfPhaseStats* out, int max) {
+    pthread_mutex_lock(&phases_lock);
+    int count = (nb_phases < max) ? nb_phases : max;
+    for (int i = 0; i < count; i++) {
+        out[i].name = phases[i].name;
+        out[i].calls = phases[i].calls;
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            out[i].values[c] = phases[i].measured[c] ? phases[i].sums[c] : -1;
+        }
+    }
+    pthread_mutex_unlock(&phases_lock);
+    return count;
+}
+
+double perf_phase_ipc(const PerfPhaseStats* phase) {
+    double cycles = phase->values[PERF_CYCLES], instructions = phase->values[PERF_INSTRUCTIONS];
+    return (cycles > 0 && instructions >= 0) ? instructions / cycles : -1;
+}
+
+double perf_phase_per_kilo_instructions(const PerfPhaseStats* phase, PerfCounter counter) {
+    double instructions = phase->values[PERF_INSTRUCTIONS], events = phase->values[counter];
+    return (instructions > 0 && events >= 0) ? events * 1000 / instructions : -1;
+}
+
+size_t perf_counters_format(char* out, size_t size) {
+    if (size == 0) return 0;
+    out[0] = 0;
+    PerfPhaseStats stats[PERF_MAX_PHASES];
+    int count = perf_counters_get(stats, PERF_MAX_PHASES);
+    if (count == 0) return (size_t)snprintf(out, size, "Aucune phase mesuree par les compteurs materiels\n");
+
+    size_t len = 0;
+#define APPEND(...) do { \
+        if (len < size) { \
+            int n = snprintf(out + len, size - len, __VA_ARGS__); \
+            if (n > 0) len += (size_t)n; \
+        } \
+    } while (0)
+
+    // Défauts de cache et de prédiction rapportés à mille instructions (MPKI)
+    APPEND("%-22s %9s %12s %12s %6s %10s %10s\n", "Phase", "Appels", "Cycles (M)", "Instr. (M)", "IPC",
+           "Cache/1ki", "Branch/1ki");
+    for (int i = 0; i < count; i++) {
+        const PerfPhaseStats* p = &stats[i];
+        APPEND("%-22s %9lld %12.2f %12.2f %6.2f %10.2f %10.2f\n", p->name, p->calls,
+               p->values[PERF_CYCLES] / 1e6, p->values[PERF_INSTRUCTIONS] / 1e6, perf_phase_ipc(p),
+               perf_phase_per_kilo_instructions(p, PERF_CACHE_MISSES),
+               perf_phase_per_kilo_instructions(p, PERF_BRANCH_MISSES));
+    }
+#undef APPEND
+    return len < size ? len : size - 1;
+}
+
+static void write_number(FILE* out, double value, const char* format) {
+    if (value < 0) fprintf(out, "null");
+    else fprintf(out, format, value);
+}
+
+void perf_counters_write_json(FILE* out) {
+    PerfPhaseStats stats[PERF_MAX_PHASES];
+    int count = perf_counters_get(stats, PERF_MAX_PHASES);
+    fprintf(out, "[");
+    for (int i = 0; i < count; i++) {
+        const PerfPhaseStats* p = &stats[i];
+        fprintf(out, "%s{\"phase\": \"%s\", \"calls\": %lld", i ? ", " : "", p->name, p->calls);
+        for (int c = 0; c < PERF_COUNTER_COUNT; c++) {
+            fprintf(out, ", \"%s\": ", counter_names[c]);
+            write_number(out, p->values[c], "%.0f");
+        }
+        fprintf(out, ", \"ipc\": ");
+        write_number(out, perf_phase_ipc(p), "%.3f");
+        fprintf(out, ", \"cache_misses_per_kilo_instr\": ");
+        write_number(out, perf_phase_per_kilo_instructions(p, PERF_CACHE_MISSES), "%.3f");
+        fprintf(out, ", \"branch_misses_per_kilo_instr\": ");
+        write_number(out, perf_phase_per_kilo_instructions(p, PERF_BRANCH_MISSES), "%.3f");
+        fprintf(out, "}");
+    }
+    fprintf(out, "]");
+}
@@ -0,0 +1,108 @@
+// perf_counters.h - Compteurs matériels (cycles, instructions, défauts de cache et de
+// prédiction de branche) relevés autour des phases du chargement et de la génération
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Variable d'environnement qui active les compteurs dans tous les modes (valeur non vide)
+#define PERF_ENV_VAR "GENERATEUR_PERF"
+
+// Nombre maximal de phases distinctes cumulées (les suivantes sont ignorées)
+#define PERF_MAX_PHASES 32
+
+// Les compteurs passent par perf_event_open (Linux) : ailleurs, ou avec -DGEN_NO_PERF_COUNTERS,
+// perf_counters_start() échoue et perf_begin() se réduit à une affectation.
+#if !defined(GEN_NO_PERF_COUNTERS) && !defined(__linux__)
+    #define GEN_NO_PERF_COUNTERS
+#endif
+
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_CACHE_MISSES,       // Accès au dernier niveau de cache manqués
+    PERF_BRANCH_MISSES,      // Branches mal prédites
+    PERF_COUNTER_COUNT
+} PerfCounter;
+
+// Relevé pris au début d'une phase ; active vaut 0 si les compteurs sont arrêtés
+typedef struct {
+    int active;
+    uint64_t enabled_ns;
+    uint64_t running_ns;
+    uint64_t values[PERF_COUNTER_COUNT];
+} PerfSample;
+
+// Cumul d'une phase sur tous les threads. Quand le noyau partage les compteurs entre plusieurs
+// groupes, les valeurs sont extrapolées au temps total de la phase. Un compteur que le
+// processeur ne fournit pas vaut -1.
+typedef struct {
+    const char* name;
+    long long calls;
+    double values[PERF_COUNTER_COUNT];
+} PerfPhaseStats;
+
+// Usage autour d'une phase, à côté de trace_begin()/trace_end() (name : chaîne constante) :
+//
+//   PerfSample perf = perf_begin();
+//   ...
+//   perf_end(&perf, "partition_by_chapter");
+//
+// Chaque relevé coûte un appel système par thread : on ne mesure que des phases entières,
+// pas chaque ligne ou chaque caractère. Les compteurs d'un thread sont ouverts à son premier
+// relevé et ne comptent que l'espace utilisateur (perf_event_paranoid <= 2 suffit).
+
+extern atomic_int perf_active;
+
+void perf_read_sample(PerfSample* sample);
+void perf_record(const PerfSample* start, const char* name);
+
+static inline PerfSample perf_begin(void) {
+    PerfSample sample;
+    sample.active = 0;
+#ifndef GEN_NO_PERF_COUNTERS
+    if (atomic_load_explicit(&perf_active, memory_order_relaxed)) perf_read_sample(&sample);
+#endif
+    return sample;
+}
+
+static inline void perf_end(const PerfSample* start, const char* name) {
+#ifndef GEN_NO_PERF_COUNTERS
+    if (start->active) perf_record(start, name);
+#endif
+}
+
+// Ouvre les compteurs du thread appelant pour vérifier qu'ils sont disponibles, puis active
+// les relevés. Retourne GEN_OK, ou GEN_ERROR_IO si le noyau les refuse (machine virtuelle sans
+// compteurs matériels, perf_event_paranoid trop élevé, système autre que Linux).
+int perf_counters_start(void);
+
+// Active les compteurs si GENERATEUR_PERF est définie et non vide ; retourne 1 si c'est le cas
+int perf_counters_start_from_env(void);
+
+// Désactive les relevés (les cumuls restent lisibles)
+void perf_counters_stop(void);
+
+int perf_counters_enabled(void);
+
+// Remet les cumuls de toutes les phases à zéro
+void perf_counters_reset(void);
+
+// Copie au plus max phases (dans l'ordre de leur première mesure) ; retourne leur nombre
+int perf_counters_get(PerfPhaseStats* out, int max);
+
+// Instructions par cycle, et événements pour mille instructions (-1 si non mesurables)
+double perf_phase_ipc(const PerfPhaseStats* phase);
+double perf_phase_per_kilo_instructions(const PerfPhaseStats* phase, PerfCounter counter);
+
+// Tableau lisible (une ligne par phase). Écrit au plus size - 1 octets ; retourne la longueur.
+size_t perf_counters_format(char* out, size_t size);
+
+// Tableau JSON des phases : [{"phase": ..., "calls": ..., "cycles": ..., "ipc": ...}, ...]
+// (null pour un compteur absent), sans retour à la ligne final
+void perf_counters_write_json(FILE* out);
+
+#endif
@@ -0,0 +1,156 @@
+// question_model.c
+#include <stdlib.h>
+#include <string.h>
+#include "question_model.h"
+#include "database.h"
+
+struct _QuestionItem {
+    GObject parent_instance;
+    int id;
+};
+
+G_DEFINE_FINAL_TYPE(QuestionItem, question_item, G_TYPE_OBJECT)
+
+static void question_item_class_init(QuestionItemClass *klass) {
+}
+
+static void question_item_init(QuestionItem *item) {
+    item->id = -1;
+}
+
+int question_item_get_id(QuestionItem *item) {
+    return item->id;
+}
+
+struct _QuestionListModel {
+    GObject parent_instance;
+    Database *db;
+    guint n_items;   // Taille annoncée aux vues lors du dernier items-changed
+    int *filter_ids; // Identifiants affichés quand une recherche est active (triés), sinon NULL
+    gboolean filtered;
+};
+
+// Position de l'identifiant dans le filtre, ou -1
+static int filter_find(QuestionListModel *model, int id) {
+    int low = 0, high = (int)model->n_items - 1;
+    while (low <= high) {
+        int mid = low + (high - low) / 2;
+        if (model->filter_ids[mid] == id) return mid;
+        if (model->filter_ids[mid] < id) low = mid + 1;
+        else high = mid - 1;
+    }
+    return -1;
+}
+
+static GType question_list_model_get_item_type(GListModel *list) {
+    return QUESTION_TYPE_ITEM;
+}
+
+static guint question_list_model_get_n_items(GListModel *list) {
+    return QUESTION_LIST_MODEL(list)->n_items;
+}
+
+static gpointer question_list_model_get_item(GListModel *list, guint position) {
+    QuestionListModel *model = QUESTION_LIST_MODEL(list);
+    if (position >= model->n_items) return NULL;
+
+    QuestionItem *item = g_object_new(QUESTION_TYPE_ITEM, NULL);
+    item->id = model->filtered ? model->filter_ids[position] : model->db->questions[position].id;
+    return item;
+}
+
+static void question_list_model_list_model_init(GListModelInterface *iface) {
+    iface->get_item_type = question_list_model_get_item_type;
+    iface->get_n_items = question_list_model_get_n_items;
+    iface->get_item = question_list_model_get_item;
+}
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(QuestionListModel, question_list_model, G_TYPE_OBJECT,
+                              G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL, question_list_model_list_model_init))
+
+static void on_database_changed(const Database *db, DatabaseChange change, int index, int count,
+                                const Question *old_question, void *user_data) {
+    QuestionListModel *model = user_data;
+    if (model->filtered) {
+        int id = (change == DB_CHANGE_CHANGED) ? db->questions[index].id
+               : (change == DB_CHANGE_REMOVED) ? old_question->id : -1;
+        int position = (id >= 0) ? filter_find(model, id) : -1;
+        if (position < 0) return;
+        if (change == DB_CHANGE_REMOVED) {
+            memmove(&model->filter_ids[position], &model->filter_ids[position + 1],
+                    sizeof(int) * (model->n_items - position - 1));
+            model->n_items--;
+            g_list_model_items_changed(G_LIST_MODEL(model), (guint)position, 1, 0);
+        } else {
+            g_list_model_items_changed(G_LIST_MODEL(model), (guint)position, 1, 1);
+        }
+        return;
+    }
+
+    switch (change) {
+        case DB_CHANGE_INSERTED:
+            model->n_items += (guint)count;
+            g_list_model_items_changed(G_LIST_MODEL(model), (guint)index, 0, (guint)count);
+            break;
+        case DB_CHANGE_REMOVED:
+            model->n_items--;
+            g_list_model_items_changed(G_LIST_MODEL(model), (guint)index, 1, 0);
+            break;
+        case DB_CHANGE_CHANGED:
+            g_list_model_items_changed(G_LIST_MODEL(model), (guint)index, 1, 1);
+            break;
+    }
+}
+
+static void question_list_model_finalize(GObject *object) {
+    QuestionListModel *model = QUESTION_LIST_MODEL(object);
+    database_remove_listener(model->db, on_database_changed, model);
+    free(model->filter_ids);
+    G_OBJECT_CLASS(question_list_model_parent_class)->finalize(object);
+}
+
+static void question_list_model_class_init(QuestionListModelClass *klass) {
+    G_OBJECT_CLASS(klass)->finalize = question_list_model_finalize;
+}
+
+static void question_list_model_init(QuestionListModel *model) {
+}
+
+QuestionListModel *question_list_model_new(Database *db) {
+    QuestionListModel *model = g_object_new(QUESTION_TYPE_LIST_MODEL, NULL);
+    model->db = db;
+    model->n_items = (guint)db->count;
+    database_add_listener(db, on_database_changed, model);
+    return model;
+}
+
+void question_list_model_reset(QuestionListModel *model) {
+    guint removed = model->n_items;
+    free(model->filter_ids);
+    model->filter_ids = NULL;
+    model->filtered = FALSE;
+    model->n_items = (guint)model->db->count;
+    g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, model->n_items);
+}
+
+void question_list_model_set_filter(QuestionListModel *model, int *ids, int count) {
+    guint removed = model->n_items;
+    free(model->filter_ids);
+    if (count < 0) {
+        free(ids);
+        model->filter_ids = NULL;
+        model->filtered = FALSE;
+        model->n_items = (guint)model->db->count;
+    } else {
+        model->filter_ids = ids;
+        model->filtered = TRUE;
+        model->n_items = (guint)count;
+    }
+    g_list_model_items_changed(G_LIST_MODEL(model), 0, removed, model->n_items);
+}
+
+int question_list_model_get_index(QuestionListModel *model, guint position) {
+    if (position >= model->n_items) return -1;
+    if (!model->filtered) return (int)position;
+    return database_find_by_id(model->db, model->filter_ids[position]);
+}
@@ -0,0 +1,37 @@
+// question_model.h - GListModel exposant la Database à un GtkListView
+#ifndef QUESTION_MODEL_H
+#define QUESTION_MODEL_H
+
+#include <gio/gio.h>
+#include "structures.h"
+
+G_BEGIN_DECLS
+
+// Élément léger créé à la demande pour une ligne visible : seulement l'identifiant stable
+// de la question, qui reste valable quand des lignes sont insérées ou supprimées avant elle
+#define QUESTION_TYPE_ITEM (question_item_get_type())
+G_DECLARE_FINAL_TYPE(QuestionItem, question_item, QUESTION, ITEM, GObject)
+
+int question_item_get_id(QuestionItem *item);
+
+#define QUESTION_TYPE_LIST_MODEL (question_list_model_get_type())
+G_DECLARE_FINAL_TYPE(QuestionListModel, question_list_model, QUESTION, LIST_MODEL, GObject)
+
+// Le modèle lit directement la base ; il ne copie aucune question. Il s'abonne aux
+// modifications de la base et les relaie en items-changed sur les seules lignes touchées.
+QuestionListModel *question_list_model_new(Database *db);
+
+// Signale aux vues que tout le contenu a pu changer (rechargement complet de la base)
+void question_list_model_reset(QuestionListModel *model);
+
+// Restreint la liste aux identifiants donnés, triés par ordre croissant (résultat de
+// search_index_query). Le modèle prend possession du tableau ; ids NULL et count < 0
+// retirent le filtre. Les questions ajoutées pendant un filtrage n'y apparaissent pas.
+void question_list_model_set_filter(QuestionListModel *model, int *ids, int count);
+
+// Index dans la base de la question affichée à cette position, ou -1
+int question_list_model_get_index(QuestionListModel *model, guint position);
+
+G_END_DECLS
+
+#endif
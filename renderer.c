@@ -0,0 +1,27 @@
+// renderer.c
+#include <string.h>
+#include <strings.h>
+#include "renderer.h"
+
+static const Renderer* const RENDERERS[] = {
+    &RENDERER_TXT,
+    &RENDERER_PDF,
+    &RENDERER_HTML,
+    &RENDERER_MARKDOWN,
+    NULL
+};
+
+const Renderer* renderer_find_n(const char* format, size_t length) {
+    for (int i = 0; RENDERERS[i] != NULL; i++) {
+        const Renderer* r = RENDERERS[i];
+        if ((strlen(r->name) == length && strncasecmp(r->name, format, length) == 0) ||
+            (strlen(r->extension) == length && strncasecmp(r->extension, format, length) == 0)) {
+            return r;
+        }
+    }
+    return NULL;
+}
+
+const Renderer* renderer_find(const char* format) {
+    return renderer_find_n(format, strlen(format));
+}
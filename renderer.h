@@ -0,0 +1,48 @@
+// renderer.h
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include <stddef.h>
+#include <time.h>
+#include "structures.h"
+#include "output_sink.h"
+
+// Informations d'en-tête communes à tous les formats de sortie
+typedef struct {
+    const char* matiere;
+    const char* chapitre;        // "Tous" si l'épreuve couvre tous les chapitres
+    ExamType exam_type;
+    int nbQCM;
+    int nbExercice;
+    double points_per_qcm;
+    int points_per_exercice;
+    struct tm date;              // Date de génération
+    size_t text_size;            // Octets d'énoncés et de choix sélectionnés (pour pré-dimensionner)
+} ExamInfo;
+
+// Un format de sortie. Chaque appel retourne 0 en cas de succès, -1 en cas d'erreur.
+// begin_document() retourne un état propre au rendu (NULL en cas d'échec) qui est
+// passé aux autres fonctions ; end_document() le libère toujours. Si complete vaut 0
+// (erreur ou annulation), le rendu abandonne le document sans l'écrire.
+typedef struct {
+    const char* name;            // "TXT", "PDF", "HTML", "MD"
+    const char* extension;       // Sans le point
+    void* (*begin_document)(OutputSink* sink, const ExamInfo* info);
+    int (*header)(void* state);
+    int (*qcm)(void* state, int number, const Question* q);
+    int (*exercise)(void* state, int number, const Question* q);
+    int (*end_document)(void* state, int complete);
+} Renderer;
+
+extern const Renderer RENDERER_TXT;
+extern const Renderer RENDERER_PDF;
+extern const Renderer RENDERER_HTML;
+extern const Renderer RENDERER_MARKDOWN;
+
+// Recherche un rendu par nom ou extension, sans tenir compte de la casse ("pdf", "md"...)
+const Renderer* renderer_find(const char* format);
+
+// Recherche un rendu à partir d'un nom de format de longueur donnée (liste "PDF,HTML")
+const Renderer* renderer_find_n(const char* format, size_t length);
+
+#endif
@@ -0,0 +1,176 @@
+// renderer_html.c
+// Page HTML autonome (CSS intégré) destinée à l'import dans la plateforme de cours.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "renderer.h"
+#include "text_buffer.h"
+#include "mem_track.h"
+
+static const char HTML_HEAD[] =
+    "<!DOCTYPE html>\n"
+    "<html lang=\"fr\">\n"
+    "<head>\n"
+    "<meta charset=\"utf-8\">\n"
+    "<title>Epreuve - ";
+static const char HTML_STYLE[] =
+    "</title>\n"
+    "<style>\n"
+    "body { font-family: sans-serif; max-width: 50em; margin: 2em auto; color: #0f172a; }\n"
+    "header { background: #1e40af; color: white; padding: 1em 1.5em; }\n"
+    "h2 { color: #1e40af; border-bottom: 1px solid #cbd5e1; }\n"
+    ".details { list-style: none; padding: 0; }\n"
+    ".question { margin: 1.5em 0; }\n"
+    ".choices { list-style: upper-alpha; }\n"
+    ".answer { color: #64748b; }\n"
+    "footer { background: #1e40af; color: white; text-align: center; padding: 0.5em; }\n"
+    "</style>\n"
+    "</head>\n"
+    "<body>\n"
+    "<header><h1>EPREUVE D'INGENIERIE INFORMATIQUE</h1></header>\n"
+    "<ul class=\"details\">\n"
+    "<li>Matiere : ";
+static const char HTML_ANSWER_LINES[] =
+    "<p class=\"answer\">Reponse :</p>\n"
+    "<hr><hr><hr><hr><hr>\n"
+    "</section>\n";
+static const char HTML_FOOTER[] =
+    "<footer>FIN DE L'EPREUVE</footer>\n"
+    "</body>\n"
+    "</html>\n";
+
+typedef struct {
+    OutputSink* sink;
+    ExamInfo info;
+    TextBuffer b;
+    char points_label[32];
+} HtmlState;
+
+static void append_escaped(TextBuffer* b, const char* s) {
+    const char* run = s;
+    for (; *s; s++) {
+        const char* entity = NULL;
+        switch (*s) {
+            case '&': entity = "&amp;"; break;
+            case '<': entity = "&lt;"; break;
+            case '>': entity = "&gt;"; break;
+            case '"': entity = "&quot;"; break;
+            case '\n': entity = "<br>\n"; break;
+            default: continue;
+        }
+        text_buffer_append(b, run, (size_t)(s - run));
+        text_buffer_append_str(b, entity);
+        run = s + 1;
+    }
+    text_buffer_append(b, run, (size_t)(s - run));
+}
+
+static void* html_begin(OutputSink* sink, const ExamInfo* info) {
+    HtmlState* st = mem_calloc(MEM_GENERATOR, 1, sizeof(HtmlState));
+    if (!st) return NULL;
+    st->sink = sink;
+    st->info = *info;
+
+    // L'échappement peut allonger le texte : marge d'un quart en plus
+    size_t estimate = sizeof(HTML_HEAD) + sizeof(HTML_STYLE) + 1024 + info->text_size + info->text_size / 4
+                      + (size_t)info->nbQCM * 256 + (size_t)info->nbExercice * 256;
+    if (text_buffer_init(&st->b, estimate) != 0) {
+        mem_free(MEM_GENERATOR, st);
+        return NULL;
+    }
+    snprintf(st->points_label, sizeof(st->points_label), "%.1f point%s",
+             info->points_per_qcm, info->points_per_qcm > 1 ? "s" : "");
+    return st;
+}
+
+static int html_header(void* state) {
+    HtmlState* st = state;
+    TextBuffer* b = &st->b;
+    const ExamInfo* info = &st->info;
+    char date[32];
+
+    snprintf(date, sizeof(date), "%02d/%02d/%04d",
+             info->date.tm_mday, info->date.tm_mon + 1, info->date.tm_year + 1900);
+
+    TEXT_BUFFER_APPEND_FIXED(b, HTML_HEAD);
+    append_escaped(b, info->matiere);
+    TEXT_BUFFER_APPEND_FIXED(b, HTML_STYLE);
+    append_escaped(b, info->matiere);
+    TEXT_BUFFER_APPEND_FIXED(b, "</li>\n<li>Chapitre : ");
+    append_escaped(b, info->chapitre);
+    TEXT_BUFFER_APPEND_FIXED(b, "</li>\n<li>Type d'epreuve : ");
+    text_buffer_append_str(b, info->exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
+    TEXT_BUFFER_APPEND_FIXED(b, "</li>\n<li>Note totale : 20 points</li>\n<li>Date : ");
+    text_buffer_append_str(b, date);
+    TEXT_BUFFER_APPEND_FIXED(b, "</li>\n</ul>\n<section>\n<h2>PARTIE 1 : QUESTIONS A CHOIX MULTIPLES</h2>\n<p>(");
+    text_buffer_append_int(b, info->nbQCM);
+    TEXT_BUFFER_APPEND_FIXED(b, " questions - ");
+    text_buffer_append_str(b, st->points_label);
+    TEXT_BUFFER_APPEND_FIXED(b, " chacune)</p>\n");
+    return b->error ? -1 : 0;
+}
+
+static int html_qcm(void* state, int number, const Question* q) {
+    HtmlState* st = state;
+    TextBuffer* b = &st->b;
+
+    TEXT_BUFFER_APPEND_FIXED(b, "<div class=\"question\">\n<h3>Question ");
+    text_buffer_append_int(b, number);
+    TEXT_BUFFER_APPEND_FIXED(b, " (");
+    text_buffer_append_str(b, st->points_label);
+    TEXT_BUFFER_APPEND_FIXED(b, ")</h3>\n<p>");
+    append_escaped(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "</p>\n<ol class=\"choices\">\n");
+    for (int j = 0; j < q->nbChoix; j++) {
+        TEXT_BUFFER_APPEND_FIXED(b, "<li>");
+        append_escaped(b, question_choice(q, j));
+        TEXT_BUFFER_APPEND_FIXED(b, "</li>\n");
+    }
+    TEXT_BUFFER_APPEND_FIXED(b, "</ol>\n<p class=\"answer\">Reponse : _____</p>\n</div>\n");
+    return b->error ? -1 : 0;
+}
+
+static int html_exercise(void* state, int number, const Question* q) {
+    HtmlState* st = state;
+    TextBuffer* b = &st->b;
+    int points = st->info.points_per_exercice;
+
+    if (number == 1) {
+        TEXT_BUFFER_APPEND_FIXED(b, "</section>\n<section>\n<h2>PARTIE 2 : EXERCICE</h2>\n<p>(");
+        text_buffer_append_int(b, points);
+        TEXT_BUFFER_APPEND_FIXED(b, " point");
+        if (points > 1) text_buffer_append_char(b, 's');
+        TEXT_BUFFER_APPEND_FIXED(b, ")</p>\n");
+    }
+    TEXT_BUFFER_APPEND_FIXED(b, "<div class=\"question\">\n<h3>Exercice (");
+    text_buffer_append_int(b, points);
+    TEXT_BUFFER_APPEND_FIXED(b, " points)</h3>\n<p>");
+    append_escaped(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "</p>\n</div>\n");
+    return b->error ? -1 : 0;
+}
+
+static int html_end(void* state, int complete) {
+    HtmlState* st = state;
+    int result = -1;
+
+    if (complete) {
+        if (st->info.nbExercice > 0) {
+            TEXT_BUFFER_APPEND_FIXED(&st->b, HTML_ANSWER_LINES);
+        } else {
+            TEXT_BUFFER_APPEND_FIXED(&st->b, "</section>\n");
+        }
+        TEXT_BUFFER_APPEND_FIXED(&st->b, HTML_FOOTER);
+        if (!st->b.error && output_sink_open(st->sink) == 0) {
+            result = output_sink_write(st->sink, st->b.data, st->b.len);
+        }
+    }
+    text_buffer_free(&st->b);
+    mem_free(MEM_GENERATOR, st);
+    return result;
+}
+
+const Renderer RENDERER_HTML = {
+    "HTML", "html",
+    html_begin, html_header, html_qcm, html_exercise, html_end
+};
@@ -0,0 +1,131 @@
+// renderer_markdown.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "renderer.h"
+#include "text_buffer.h"
+#include "mem_track.h"
+
+typedef struct {
+    OutputSink* sink;
+    ExamInfo info;
+    TextBuffer b;
+    char points_label[32];
+} MarkdownState;
+
+// Échappe les caractères qui déclencheraient une mise en forme Markdown
+static void append_escaped(TextBuffer* b, const char* s) {
+    const char* run = s;
+    for (; *s; s++) {
+        if (!strchr("\\`*_[]<>#|", *s)) continue;
+        text_buffer_append(b, run, (size_t)(s - run));
+        text_buffer_append_char(b, '\\');
+        text_buffer_append_char(b, *s);
+        run = s + 1;
+    }
+    text_buffer_append(b, run, (size_t)(s - run));
+}
+
+static void* markdown_begin(OutputSink* sink, const ExamInfo* info) {
+    MarkdownState* st = mem_calloc(MEM_GENERATOR, 1, sizeof(MarkdownState));
+    if (!st) return NULL;
+    st->sink = sink;
+    st->info = *info;
+
+    size_t estimate = 1024 + info->text_size + info->text_size / 8
+                      + (size_t)info->nbQCM * 96 + (size_t)info->nbExercice * 96;
+    if (text_buffer_init(&st->b, estimate) != 0) {
+        mem_free(MEM_GENERATOR, st);
+        return NULL;
+    }
+    snprintf(st->points_label, sizeof(st->points_label), "%.1f point%s",
+             info->points_per_qcm, info->points_per_qcm > 1 ? "s" : "");
+    return st;
+}
+
+static int markdown_header(void* state) {
+    MarkdownState* st = state;
+    TextBuffer* b = &st->b;
+    const ExamInfo* info = &st->info;
+    char date[32];
+
+    snprintf(date, sizeof(date), "%02d/%02d/%04d",
+             info->date.tm_mday, info->date.tm_mon + 1, info->date.tm_year + 1900);
+
+    TEXT_BUFFER_APPEND_FIXED(b, "# EPREUVE D'INGENIERIE INFORMATIQUE\n\n- **Matiere :** ");
+    append_escaped(b, info->matiere);
+    TEXT_BUFFER_APPEND_FIXED(b, "\n- **Chapitre :** ");
+    append_escaped(b, info->chapitre);
+    TEXT_BUFFER_APPEND_FIXED(b, "\n- **Type d'epreuve :** ");
+    text_buffer_append_str(b, info->exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
+    TEXT_BUFFER_APPEND_FIXED(b, "\n- **Note totale :** 20 points\n- **Date :** ");
+    text_buffer_append_str(b, date);
+    TEXT_BUFFER_APPEND_FIXED(b, "\n\n## PARTIE 1 : QUESTIONS A CHOIX MULTIPLES\n\n*(");
+    text_buffer_append_int(b, info->nbQCM);
+    TEXT_BUFFER_APPEND_FIXED(b, " questions - ");
+    text_buffer_append_str(b, st->points_label);
+    TEXT_BUFFER_APPEND_FIXED(b, " chacune)*\n\n");
+    return b->error ? -1 : 0;
+}
+
+static int markdown_qcm(void* state, int number, const Question* q) {
+    MarkdownState* st = state;
+    TextBuffer* b = &st->b;
+
+    TEXT_BUFFER_APPEND_FIXED(b, "### Question ");
+    text_buffer_append_int(b, number);
+    TEXT_BUFFER_APPEND_FIXED(b, " (");
+    text_buffer_append_str(b, st->points_label);
+    TEXT_BUFFER_APPEND_FIXED(b, ")\n\n");
+    append_escaped(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "\n\n");
+    for (int j = 0; j < q->nbChoix; j++) {
+        TEXT_BUFFER_APPEND_FIXED(b, "- ");
+        text_buffer_append_char(b, (char)('A' + j));
+        TEXT_BUFFER_APPEND_FIXED(b, ") ");
+        append_escaped(b, question_choice(q, j));
+        text_buffer_append_char(b, '\n');
+    }
+    TEXT_BUFFER_APPEND_FIXED(b, "\nReponse : \\_\\_\\_\\_\\_\n\n---\n\n");
+    return b->error ? -1 : 0;
+}
+
+static int markdown_exercise(void* state, int number, const Question* q) {
+    MarkdownState* st = state;
+    TextBuffer* b = &st->b;
+    int points = st->info.points_per_exercice;
+
+    if (number == 1) {
+        TEXT_BUFFER_APPEND_FIXED(b, "## PARTIE 2 : EXERCICE\n\n*(");
+        text_buffer_append_int(b, points);
+        TEXT_BUFFER_APPEND_FIXED(b, " point");
+        if (points > 1) text_buffer_append_char(b, 's');
+        TEXT_BUFFER_APPEND_FIXED(b, ")*\n\n");
+    }
+    TEXT_BUFFER_APPEND_FIXED(b, "### Exercice (");
+    text_buffer_append_int(b, points);
+    TEXT_BUFFER_APPEND_FIXED(b, " points)\n\n");
+    append_escaped(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "\n\n**Reponse :**\n\n");
+    return b->error ? -1 : 0;
+}
+
+static int markdown_end(void* state, int complete) {
+    MarkdownState* st = state;
+    int result = -1;
+
+    if (complete) {
+        TEXT_BUFFER_APPEND_FIXED(&st->b, "---\n\n**FIN DE L'EPREUVE**\n");
+        if (!st->b.error && output_sink_open(st->sink) == 0) {
+            result = output_sink_write(st->sink, st->b.data, st->b.len);
+        }
+    }
+    text_buffer_free(&st->b);
+    mem_free(MEM_GENERATOR, st);
+    return result;
+}
+
+const Renderer RENDERER_MARKDOWN = {
+    "MD", "md",
+    markdown_begin, markdown_header, markdown_qcm, markdown_exercise, markdown_end
+};
@@ -0,0 +1,383 @@
+// renderer_pdf.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cairo.h>
+#include <cairo-pdf.h>
+#include "renderer.h"
+#include "renderer_pdf.h"
+#include "mem_track.h"
+#include "trace.h"
+
+typedef struct {
+    OutputSink* sink;            // NULL pour une surface fournie par l'appelant
+    ExamInfo info;
+    cairo_surface_t* surface;
+    cairo_t* cr;
+    double margin;
+    double page_width;
+    double y;
+    PdfLayoutStats* stats;       // Optionnel
+} PdfState;
+
+// Dessine une ligne et la compte dans les statistiques
+static void show_line(cairo_t *cr, const char *line, double x, double y, PdfLayoutStats *stats) {
+    cairo_move_to(cr, x, y);
+    cairo_show_text(cr, line);
+    if (stats) {
+        stats->lines++;
+        for (const char *p = line; *p; p++) {
+            if (((unsigned char)*p & 0xC0) != 0x80) stats->glyphs++; // Premier octet d'un caractère UTF-8
+        }
+    }
+}
+
+double pdf_draw_wrapped_text(cairo_t *cr, const char *text, double x, double y, double max_width, double line_height,
+                             PdfLayoutStats *stats) {
+    if (!text || strlen(text) == 0) return y;
+    uint64_t span = trace_begin();
+    
+    char *text_copy = mem_strdup(MEM_GENERATOR, text);
+    char *line_start = text_copy;
+    char *current = text_copy;
+    double current_y = y;
+    int text_rendered = 0;
+    
+    while (*current) {
+        char *word_end = current;
+        while (*word_end && *word_end != ' ' && *word_end != '\n') word_end++;
+        
+        char saved = *word_end;
+        *word_end = '\0';
+        
+        cairo_text_extents_t extents;
+        cairo_text_extents(cr, line_start, &extents);
+        
+        if (extents.width > max_width && current != line_start) {
+            *(current - 1) = '\0';
+            show_line(cr, line_start, x, current_y, stats);
+            current_y += line_height;
+            line_start = current;
+            *word_end = saved;
+            text_rendered = 0;
+        } else {
+            *word_end = saved;
+            if (*word_end == '\n' || *word_end == '\0') {
+                show_line(cr, line_start, x, current_y, stats);
+                current_y += line_height;
+                text_rendered = 1;
+                if (*word_end == '\n') {
+                    current = word_end + 1;
+                    line_start = current;
+                    text_rendered = 0;
+                } else {
+                    break;
+                }
+            } else {
+                current = word_end + 1;
+                text_rendered = 0;
+            }
+        }
+    }
+    
+    if (!text_rendered && line_start < current && *line_start != '\0') {
+        show_line(cr, line_start, x, current_y, stats);
+        current_y += line_height;
+    }
+    
+    mem_free(MEM_GENERATOR, text_copy);
+    trace_end(span, "draw_wrapped_text");
+    return current_y;
+}
+
+// Relais entre cairo et le sink de sortie
+static cairo_status_t write_pdf_to_sink(void *closure, const unsigned char *data, unsigned int length) {
+    OutputSink *sink = (OutputSink *)closure;
+    return output_sink_write(sink, data, length) == 0 ? CAIRO_STATUS_SUCCESS : CAIRO_STATUS_WRITE_ERROR;
+}
+
+static double draw_wrapped_text(PdfState *st, const char *text, double x, double y, double max_width) {
+    return pdf_draw_wrapped_text(st->cr, text, x, y, max_width, 16, st->stats);
+}
+
+static void new_page(PdfState *st) {
+    cairo_show_page(st->cr);
+    if (st->stats) st->stats->pages++;
+}
+
+static PdfState* begin_on_surface(OutputSink* sink, cairo_surface_t* surface, const ExamInfo* info,
+                                  PdfLayoutStats* stats) {
+    PdfState* st = mem_calloc(MEM_GENERATOR, 1, sizeof(PdfState));
+    if (!st) {
+        cairo_surface_destroy(surface);
+        return NULL;
+    }
+    st->sink = sink;
+    st->info = *info;
+    st->surface = surface;
+    st->cr = cairo_create(st->surface);
+    st->margin = 50;
+    st->page_width = PAGE_WIDTH - 2 * st->margin;
+    st->y = st->margin;
+    st->stats = stats;
+    if (stats) stats->pages++;
+    return st;
+}
+
+static void* pdf_begin(OutputSink* sink, const ExamInfo* info) {
+    return begin_on_surface(sink, cairo_pdf_surface_create_for_stream(write_pdf_to_sink, sink, PAGE_WIDTH, PAGE_HEIGHT),
+                            info, NULL);
+}
+
+void* pdf_begin_on_surface(cairo_surface_t* surface, const ExamInfo* info, PdfLayoutStats* stats) {
+    return begin_on_surface(NULL, cairo_surface_reference(surface), info, stats);
+}
+
+static int pdf_header(void* state) {
+    PdfState* st = state;
+    cairo_t *cr = st->cr;
+    const ExamInfo* info = &st->info;
+    double margin = st->margin;
+    double y;
+
+    // Header with gradient effect
+    cairo_set_source_rgb(cr, 0.12, 0.25, 0.69); // Blue color
+    cairo_rectangle(cr, 0, 0, PAGE_WIDTH, 80);
+    cairo_fill(cr);
+    
+    cairo_set_source_rgb(cr, 1, 1, 1);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 20);
+    cairo_move_to(cr, margin, 35);
+    cairo_show_text(cr, "EPREUVE D'INGENIERIE INFORMATIQUE");
+    
+    y = 100;
+    
+    // Exam details
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_set_font_size(cr, 12);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "Matiere : %s", info->matiere);
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 20;
+    
+    snprintf(buffer, sizeof(buffer), "Chapitre : %s", info->chapitre);
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 20;
+    
+    snprintf(buffer, sizeof(buffer), "Type d'epreuve : %s", 
+             info->exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 20;
+    
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, "Note totale : 20 points");
+    y += 20;
+    
+    snprintf(buffer, sizeof(buffer), "Date : %02d/%02d/%04d", 
+             info->date.tm_mday, info->date.tm_mon + 1, info->date.tm_year + 1900);
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 30;
+    
+    // Separator line
+    cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
+    cairo_set_line_width(cr, 1);
+    cairo_move_to(cr, margin, y);
+    cairo_line_to(cr, PAGE_WIDTH - margin, y);
+    cairo_stroke(cr);
+    y += 25;
+    
+    // QCM Section
+    cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 14);
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, "PARTIE 1 : QUESTIONS A CHOIX MULTIPLES");
+    y += 20;
+    
+    cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
+    cairo_set_font_size(cr, 10);
+    snprintf(buffer, sizeof(buffer), "(%d questions - %.1f point%s chacune)", 
+             info->nbQCM, info->points_per_qcm, info->points_per_qcm > 1 ? "s" : "");
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 25;
+    
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    cairo_set_font_size(cr, 11);
+
+    st->y = y;
+    return cairo_status(cr) == CAIRO_STATUS_SUCCESS ? 0 : -1;
+}
+
+static int pdf_qcm(void* state, int number, const Question* q) {
+    PdfState* st = state;
+    cairo_t *cr = st->cr;
+    double margin = st->margin;
+    double page_width = st->page_width;
+    double points_per_qcm = st->info.points_per_qcm;
+    double y = st->y;
+    char buffer[256];
+
+    if (y > 750) { // New page if needed
+        new_page(st);
+        y = margin;
+    }
+    
+    // Question header
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    snprintf(buffer, sizeof(buffer), "Question %d (%.1f point%s) :", 
+             number, points_per_qcm, points_per_qcm > 1 ? "s" : "");
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 20;
+    
+    // Question text with proper wrapping
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    y = draw_wrapped_text(st, question_enonce(q), margin + 5, y, page_width - 10);
+    y += 10; // Space after question text
+    
+    // Choices
+    for (int j = 0; j < q->nbChoix; j++) {
+        if (y > 780) { // Check for page break
+            new_page(st);
+            y = margin;
+        }
+        snprintf(buffer, sizeof(buffer), "%c) %s", 'A' + j, question_choice(q, j));
+        y = draw_wrapped_text(st, buffer, margin + 15, y, page_width - 20);
+        y += 5; // Small space between choices
+    }
+    
+    // Answer line
+    cairo_set_source_rgb(cr, 0.6, 0.6, 0.6);
+    cairo_move_to(cr, margin + 15, y);
+    cairo_show_text(cr, "Reponse : _____");
+    y += 25;
+    
+    // Separator
+    cairo_set_source_rgb(cr, 0.9, 0.9, 0.9);
+    cairo_set_line_width(cr, 0.5);
+    cairo_move_to(cr, margin, y);
+    cairo_line_to(cr, PAGE_WIDTH - margin, y);
+    cairo_stroke(cr);
+    y += 20;
+
+    st->y = y;
+    return cairo_status(cr) == CAIRO_STATUS_SUCCESS ? 0 : -1;
+}
+
+static int pdf_exercise(void* state, int number, const Question* q) {
+    PdfState* st = state;
+    cairo_t *cr = st->cr;
+    double margin = st->margin;
+    double page_width = st->page_width;
+    int points_per_exercice = st->info.points_per_exercice;
+    double y = st->y;
+    char buffer[256];
+
+    if (number == 1) {
+        if (y > 600) { // Ensure enough space for exercise
+            new_page(st);
+            y = margin;
+        }
+        
+        y += 15;
+        cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
+        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, 14);
+        cairo_move_to(cr, margin, y);
+        cairo_show_text(cr, "PARTIE 2 : EXERCICE");
+        y += 20;
+        
+        cairo_set_source_rgb(cr, 0.4, 0.4, 0.4);
+        cairo_set_font_size(cr, 10);
+        snprintf(buffer, sizeof(buffer), "(%d point%s)", 
+                 points_per_exercice, points_per_exercice > 1 ? "s" : "");
+        cairo_move_to(cr, margin, y);
+        cairo_show_text(cr, buffer);
+        y += 25;
+    }
+    
+    cairo_set_source_rgb(cr, 0, 0, 0);
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+    cairo_set_font_size(cr, 11);
+    snprintf(buffer, sizeof(buffer), "Exercice (%d points) :", points_per_exercice);
+    cairo_move_to(cr, margin, y);
+    cairo_show_text(cr, buffer);
+    y += 20;
+    
+    cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_NORMAL);
+    y = draw_wrapped_text(st, question_enonce(q), margin + 5, y, page_width - 10);
+    y += 25;
+    
+    cairo_set_source_rgb(cr, 0.6, 0.6, 0.6);
+    cairo_move_to(cr, margin + 5, y);
+    cairo_show_text(cr, "Reponse :");
+    y += 20;
+    
+    // Answer lines
+    for (int i = 0; i < 5; i++) {
+        if (y > 800) {
+            new_page(st);
+            y = margin;
+        }
+        cairo_set_source_rgb(cr, 0.8, 0.8, 0.8);
+        cairo_set_line_width(cr, 0.5);
+        cairo_move_to(cr, margin + 5, y);
+        cairo_line_to(cr, PAGE_WIDTH - margin - 5, y);
+        cairo_stroke(cr);
+        y += 25;
+    }
+
+    st->y = y;
+    return cairo_status(cr) == CAIRO_STATUS_SUCCESS ? 0 : -1;
+}
+
+static int pdf_end(void* state, int complete) {
+    PdfState* st = state;
+    cairo_t *cr = st->cr;
+    int result = -1;
+
+    if (complete) {
+        // Footer
+        if (st->y > 750) {
+            new_page(st);
+        }
+        
+        double y = 800;
+        cairo_set_source_rgb(cr, 0.12, 0.25, 0.69);
+        cairo_rectangle(cr, 0, y, PAGE_WIDTH, 42);
+        cairo_fill(cr);
+        
+        cairo_set_source_rgb(cr, 1, 1, 1);
+        cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+        cairo_set_font_size(cr, 14);
+        cairo_move_to(cr, 200, y + 25);
+        cairo_show_text(cr, "FIN DE L'EPREUVE");
+
+        cairo_destroy(cr);
+        uint64_t span = trace_begin();
+        cairo_surface_finish(st->surface); // Mise en page finale et écriture du PDF
+        trace_end(span, "cairo_surface_finish");
+        result = (cairo_surface_status(st->surface) == CAIRO_STATUS_SUCCESS) ? 0 : -1;
+    } else {
+        // Document abandonné : on coupe le flux pour que cairo n'écrive plus rien
+        if (st->sink) st->sink->error = 1;
+        cairo_destroy(cr);
+    }
+    cairo_surface_destroy(st->surface);
+    mem_free(MEM_GENERATOR, st);
+    return result;
+}
+
+const Renderer RENDERER_PDF = {
+    "PDF", "pdf",
+    pdf_begin, pdf_header, pdf_qcm, pdf_exercise, pdf_end
+};
@@ -0,0 +1,29 @@
+// renderer_pdf.h - Mise en page PDF accessible en dehors du rendu (mesures de performance)
+#ifndef RENDERER_PDF_H
+#define RENDERER_PDF_H
+
+#include <cairo.h>
+#include "renderer.h"
+
+#define PAGE_WIDTH  595   // A4 en points
+#define PAGE_HEIGHT 842
+
+// Compteurs de mise en page, cumulés au fil des appels
+typedef struct {
+    long lines;      // Lignes dessinées par pdf_draw_wrapped_text
+    long glyphs;     // Caractères UTF-8 de ces lignes
+    int pages;       // Pages commencées
+} PdfLayoutStats;
+
+// Dessine text à partir de (x, y) en coupant les lignes aux espaces pour ne pas dépasser
+// max_width ; les '\n' forcent un retour à la ligne. Retourne l'ordonnée sous le texte.
+// stats est optionnel.
+double pdf_draw_wrapped_text(cairo_t *cr, const char *text, double x, double y, double max_width, double line_height,
+                             PdfLayoutStats *stats);
+
+// Comme RENDERER_PDF.begin_document, mais dessine sur une surface fournie par l'appelant
+// (par exemple une surface d'enregistrement, sans produire de PDF). Les autres fonctions de
+// RENDERER_PDF s'utilisent ensuite normalement ; l'appelant garde sa référence sur la surface.
+void* pdf_begin_on_surface(cairo_surface_t *surface, const ExamInfo *info, PdfLayoutStats *stats);
+
+#endif
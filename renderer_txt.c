@@ -0,0 +1,149 @@
+// renderer_txt.c
+// Le document entier est assemblé dans un seul tampon alloué d'avance, puis écrit
+// en une fois dans le sink : pas de fprintf ni d'analyse de format par question.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "renderer.h"
+#include "text_buffer.h"
+#include "mem_track.h"
+
+#define TXT_RULE       "========================================\n"
+#define TXT_DASHES     "---------------------------------------\n"
+#define TXT_ANSWER_BAR "____________________________________________________________\n\n"
+
+static const char TXT_TITLE[] =
+    TXT_RULE "       EPREUVE D'INGENIERIE INFORMATIQUE\n" TXT_RULE "\n" "Matiere : ";
+static const char TXT_CHAPTER[] = "\nChapitre : ";
+static const char TXT_TYPE[] = "\nType d'epreuve : ";
+static const char TXT_TOTAL[] = "\nNote totale : 20 points\nDate de generation : ";
+static const char TXT_PART1[] =
+    TXT_RULE "\n" "PARTIE 1 : QUESTIONS A CHOIX MULTIPLES\n" TXT_DASHES "(";
+static const char TXT_QUESTION[] = "Question ";
+static const char TXT_CHOICE[] = "   A) ";
+static const char TXT_QCM_END[] = "\nReponse : _____\n\n" TXT_DASHES "\n";
+static const char TXT_PART2[] = "\nPARTIE 2 : EXERCICE\n" TXT_DASHES "(";
+static const char TXT_EXERCISE[] = "Exercice (";
+static const char TXT_EXERCISE_END[] =
+    "Reponse :\n" TXT_ANSWER_BAR TXT_ANSWER_BAR TXT_ANSWER_BAR TXT_ANSWER_BAR TXT_ANSWER_BAR;
+static const char TXT_FOOTER[] = "\n" TXT_RULE "              FIN DE L'EPREUVE\n" TXT_RULE;
+
+typedef struct {
+    OutputSink* sink;
+    ExamInfo info;
+    TextBuffer b;
+    char points_label[32];   // "0.5 point", formaté une seule fois par document
+    int points_label_len;
+} TxtState;
+
+static void* txt_begin(OutputSink* sink, const ExamInfo* info) {
+    TxtState* st = mem_calloc(MEM_GENERATOR, 1, sizeof(TxtState));
+    if (!st) return NULL;
+    st->sink = sink;
+    st->info = *info;
+
+    // Texte des questions + gabarit fixe par question et par choix
+    size_t estimate = 2048 + strlen(info->matiere) + strlen(info->chapitre) + info->text_size
+                      + (size_t)info->nbQCM * (128 + 4 * sizeof(TXT_CHOICE))
+                      + (size_t)info->nbExercice * (128 + sizeof(TXT_EXERCISE_END));
+    if (text_buffer_init(&st->b, estimate) != 0) {
+        mem_free(MEM_GENERATOR, st);
+        return NULL;
+    }
+    st->points_label_len = snprintf(st->points_label, sizeof(st->points_label), "%.1f point%s",
+                                    info->points_per_qcm, info->points_per_qcm > 1 ? "s" : "");
+    return st;
+}
+
+static int txt_header(void* state) {
+    TxtState* st = state;
+    TextBuffer* b = &st->b;
+    const ExamInfo* info = &st->info;
+    const struct tm* t = &info->date;
+
+    char date[64];
+    int date_len = snprintf(date, sizeof(date), "%02d/%02d/%04d %02d:%02d:%02d\n",
+                            t->tm_mday, t->tm_mon + 1, t->tm_year + 1900,
+                            t->tm_hour, t->tm_min, t->tm_sec);
+
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_TITLE);
+    text_buffer_append_str(b, info->matiere);
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_CHAPTER);
+    text_buffer_append_str(b, info->chapitre);
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_TYPE);
+    text_buffer_append_str(b, info->exam_type == EXAM_TYPE_QCM_ONLY ? "QCM Uniquement" : "Mixte (QCM + Exercice)");
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_TOTAL);
+    text_buffer_append(b, date, (size_t)date_len);
+
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_PART1);
+    text_buffer_append_int(b, info->nbQCM);
+    TEXT_BUFFER_APPEND_FIXED(b, " questions - ");
+    text_buffer_append(b, st->points_label, (size_t)st->points_label_len);
+    TEXT_BUFFER_APPEND_FIXED(b, " chacune)\n\n");
+    return b->error ? -1 : 0;
+}
+
+static int txt_qcm(void* state, int number, const Question* q) {
+    TxtState* st = state;
+    TextBuffer* b = &st->b;
+
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_QUESTION);
+    text_buffer_append_int(b, number);
+    TEXT_BUFFER_APPEND_FIXED(b, " (");
+    text_buffer_append(b, st->points_label, (size_t)st->points_label_len);
+    TEXT_BUFFER_APPEND_FIXED(b, ") :\n");
+    text_buffer_append_str(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "\n\n");
+    for (int j = 0; j < q->nbChoix; j++) {
+        char choice_prefix[sizeof(TXT_CHOICE)];
+        memcpy(choice_prefix, TXT_CHOICE, sizeof(TXT_CHOICE));
+        choice_prefix[3] = (char)('A' + j);
+        text_buffer_append(b, choice_prefix, sizeof(TXT_CHOICE) - 1);
+        text_buffer_append(b, question_choice(q, j), q->choix[j].length);
+        text_buffer_append_char(b, '\n');
+    }
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_QCM_END);
+    return b->error ? -1 : 0;
+}
+
+static int txt_exercise(void* state, int number, const Question* q) {
+    TxtState* st = state;
+    TextBuffer* b = &st->b;
+    int points = st->info.points_per_exercice;
+
+    if (number == 1) {
+        TEXT_BUFFER_APPEND_FIXED(b, TXT_PART2);
+        text_buffer_append_int(b, points);
+        TEXT_BUFFER_APPEND_FIXED(b, " point");
+        if (points > 1) text_buffer_append_char(b, 's');
+        TEXT_BUFFER_APPEND_FIXED(b, ")\n\n");
+    }
+
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_EXERCISE);
+    text_buffer_append_int(b, points);
+    TEXT_BUFFER_APPEND_FIXED(b, " points) :\n");
+    text_buffer_append_str(b, question_enonce(q));
+    TEXT_BUFFER_APPEND_FIXED(b, "\n\n");
+    TEXT_BUFFER_APPEND_FIXED(b, TXT_EXERCISE_END);
+    return b->error ? -1 : 0;
+}
+
+static int txt_end(void* state, int complete) {
+    TxtState* st = state;
+    int result = -1;
+
+    if (complete) {
+        TEXT_BUFFER_APPEND_FIXED(&st->b, TXT_FOOTER);
+        if (!st->b.error && output_sink_open(st->sink) == 0) {
+            result = output_sink_write(st->sink, st->b.data, st->b.len);
+        }
+    }
+    text_buffer_free(&st->b);
+    mem_free(MEM_GENERATOR, st);
+    return result;
+}
+
+const Renderer RENDERER_TXT = {
+    "TXT", "txt",
+    txt_begin, txt_header, txt_qcm, txt_exercise, txt_end
+};
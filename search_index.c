@@ -0,0 +1,431 @@
+// search_index.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "search_index.h"
+#include "database.h"
+#include "mem_track.h"
+#include "trace.h"
+
+// --- Repliement des caractères ---
+
+// Lettres latines U+00C0 à U+00FF (second octet UTF-8 après 0xC3, masqué sur 0x1F).
+// Majuscules et minuscules partagent la même table ; NULL signifie "séparateur".
+static const char* const LATIN1_FOLD[32] = {
+    "a", "a", "a", "a", "a", "a", "ae", "c",   // À Á Â Ã Ä Å Æ Ç
+    "e", "e", "e", "e", "i", "i", "i", "i",    // È É Ê Ë Ì Í Î Ï
+    "d", "n", "o", "o", "o", "o", "o", NULL,   // Ð Ñ Ò Ó Ô Õ Ö ×
+    "o", "u", "u", "u", "u", "y", NULL, "ss"   // Ø Ù Ú Û Ü Ý Þ ß
+};
+
+// Longueur d'une séquence UTF-8 d'après son premier octet
+static int utf8_length(unsigned char c) {
+    if (c < 0x80) return 1;
+    if ((c & 0xE0) == 0xC0) return 2;
+    if ((c & 0xF0) == 0xE0) return 3;
+    if ((c & 0xF8) == 0xF0) return 4;
+    return 1; // Octet invalide : traité seul
+}
+
+size_t search_fold(const char* text, char* out, size_t out_size) {
+    const unsigned char* p = (const unsigned char*)text;
+    size_t len = 0;
+    if (out_size == 0) return 0;
+
+    while (*p && len + 1 < out_size) {
+        unsigned char c = *p;
+        const char* folded = " ";
+        char ascii[2] = {0, 0};
+        int n = utf8_length(c);
+
+        if (c >= 'A' && c <= 'Z') {
+            ascii[0] = (char)(c - 'A' + 'a');
+            folded = ascii;
+        } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            ascii[0] = (char)c;
+            folded = ascii;
+        } else if (c == 0xC3 && p[1] >= 0x80 && p[1] <= 0xBF) {
+            unsigned char d = p[1];
+            if (d == 0xBF) folded = "y";                             // ÿ
+            else if (LATIN1_FOLD[d & 0x1F]) folded = LATIN1_FOLD[d & 0x1F];
+        } else if (c == 0xC5 && (p[1] == 0x92 || p[1] == 0x93)) {
+            folded = "oe";                                           // Œ œ
+        } else if (c == 0xC5 && p[1] == 0xB8) {
+            folded = "y";                                            // Ÿ
+        }
+
+        // Ne pas dépasser la fin de la chaîne sur une séquence tronquée
+        for (int i = 1; i < n; i++) {
+            if (p[i] == 0) { n = i; break; }
+        }
+        p += n;
+
+        for (const char* f = folded; *f && len + 1 < out_size; f++) {
+            out[len++] = *f;
+        }
+    }
+    out[len] = 0;
+    return len;
+}
+
+// --- Trigrammes ---
+
+typedef struct {
+    int* codes;
+    int count;
+    int capacity;
+    int error;
+} CodeArray;
+
+static int symbol_of(char c) {
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c >= '0' && c <= '9') return 26 + (c - '0');
+    return -1;
+}
+
+static void code_array_push(CodeArray* a, int code) {
+    if (a->error) return;
+    if (a->count >= a->capacity) {
+        int new_capacity = a->capacity ? a->capacity * 2 : 128;
+        int* codes = mem_realloc(MEM_INDEX, a->codes, sizeof(int) * new_capacity);
+        if (!codes) {
+            a->error = 1;
+            return;
+        }
+        a->codes = codes;
+        a->capacity = new_capacity;
+    }
+    a->codes[a->count++] = code;
+}
+
+// Ajoute les trigrammes d'un texte déjà replié (sans franchir les séparateurs)
+static void collect_folded_trigrams(const char* folded, CodeArray* codes) {
+    int s0 = -1, s1 = -1;
+    for (const char* p = folded; *p; p++) {
+        int s2 = symbol_of(*p);
+        if (s0 >= 0 && s1 >= 0 && s2 >= 0) {
+            code_array_push(codes, (s0 * SEARCH_ALPHABET_SIZE + s1) * SEARCH_ALPHABET_SIZE + s2);
+        }
+        s0 = s1;
+        s1 = s2;
+    }
+}
+
+static void collect_trigrams(const char* text, CodeArray* codes) {
+    if (!text) return;
+    char stack_buffer[1024];
+    size_t size = strlen(text) + 1; // Le repliement n'allonge jamais le texte
+    char* folded = (size <= sizeof(stack_buffer)) ? stack_buffer : mem_alloc(MEM_INDEX, size);
+    if (!folded) {
+        codes->error = 1;
+        return;
+    }
+    search_fold(text, folded, size);
+    collect_folded_trigrams(folded, codes);
+    if (folded != stack_buffer) mem_free(MEM_INDEX, folded);
+}
+
+static int compare_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
+
+// Trie et dédoublonne les codes collectés
+static void code_array_unique(CodeArray* a) {
+    if (a->count < 2) return;
+    qsort(a->codes, a->count, sizeof(int), compare_int);
+    int n = 1;
+    for (int i = 1; i < a->count; i++) {
+        if (a->codes[i] != a->codes[n - 1]) a->codes[n++] = a->codes[i];
+    }
+    a->count = n;
+}
+
+static void collect_question_trigrams(const Database* db, const Question* q, CodeArray* codes) {
+    collect_trigrams(question_matiere(db, q), codes);
+    collect_trigrams(question_chapitre(db, q), codes);
+    collect_trigrams(question_enonce(q), codes);
+    for (int i = 0; i < q->nbChoix; i++) {
+        collect_trigrams(question_choice(q, i), codes);
+    }
+    code_array_unique(codes);
+}
+
+// --- Listes d'identifiants ---
+
+// Position de id dans la liste, ou position d'insertion si absent
+static int posting_lower_bound(const int* ids, int count, int id) {
+    int low = 0, high = count;
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (ids[mid] < id) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static int posting_insert(PostingList* list, int id) {
+    // Cas courant : les nouvelles questions reçoivent l'identifiant le plus grand
+    int pos = (list->count == 0 || list->ids[list->count - 1] < id)
+              ? list->count : posting_lower_bound(list->ids, list->count, id);
+    if (pos < list->count && list->ids[pos] == id) return 0;
+
+    if (list->count >= list->capacity) {
+        int new_capacity = list->capacity ? list->capacity * 2 : 4;
+        int* ids = mem_realloc(MEM_INDEX, list->ids, sizeof(int) * new_capacity);
+        if (!ids) return -1;
+        list->ids = ids;
+        list->capacity = new_capacity;
+    }
+    if (pos < list->count) {
+        memmove(&list->ids[pos + 1], &list->ids[pos], sizeof(int) * (list->count - pos));
+    }
+    list->ids[pos] = id;
+    list->count++;
+    return 0;
+}
+
+static void posting_remove(PostingList* list, int id) {
+    int pos = posting_lower_bound(list->ids, list->count, id);
+    if (pos >= list->count || list->ids[pos] != id) return;
+    memmove(&list->ids[pos], &list->ids[pos + 1], sizeof(int) * (list->count - pos - 1));
+    list->count--;
+}
+
+// --- Index ---
+
+int search_index_init(SearchIndex* index) {
+    index->db = NULL;
+    index->error = 0;
+    index->lists = mem_calloc(MEM_INDEX, SEARCH_TRIGRAM_COUNT, sizeof(PostingList));
+    if (!index->lists) {
+        index->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+void search_index_free(SearchIndex* index) {
+    search_index_detach(index);
+    if (index->lists) {
+        for (int i = 0; i < SEARCH_TRIGRAM_COUNT; i++) {
+            mem_free(MEM_INDEX, index->lists[i].ids);
+        }
+    }
+    mem_free(MEM_INDEX, index->lists);
+    index->lists = NULL;
+}
+
+void search_index_add(SearchIndex* index, const Database* db, const Question* q) {
+    if (!index->lists) return;
+    CodeArray codes = {0};
+    collect_question_trigrams(db, q, &codes);
+    if (codes.error) index->error = 1;
+    for (int i = 0; i < codes.count; i++) {
+        if (posting_insert(&index->lists[codes.codes[i]], q->id) != 0) index->error = 1;
+    }
+    mem_free(MEM_INDEX, codes.codes);
+}
+
+void search_index_remove(SearchIndex* index, const Database* db, const Question* q) {
+    if (!index->lists) return;
+    CodeArray codes = {0};
+    collect_question_trigrams(db, q, &codes);
+    if (codes.error) index->error = 1;
+    for (int i = 0; i < codes.count; i++) {
+        posting_remove(&index->lists[codes.codes[i]], q->id);
+    }
+    mem_free(MEM_INDEX, codes.codes);
+}
+
+int search_index_build(SearchIndex* index, const Database* db) {
+    uint64_t span = trace_begin();
+    for (int i = 0; i < db->count; i++) {
+        search_index_add(index, db, &db->questions[i]);
+    }
+    trace_end(span, "search_index_build");
+    return index->error ? -1 : 0;
+}
+
+static void on_database_changed(const Database* db, DatabaseChange change, int index, int count,
+                                const Question* old_question, void* user_data) {
+    SearchIndex* search = user_data;
+    switch (change) {
+        case DB_CHANGE_INSERTED:
+            for (int i = index; i < index + count; i++) {
+                search_index_add(search, db, &db->questions[i]);
+            }
+            break;
+        case DB_CHANGE_REMOVED:
+            search_index_remove(search, db, old_question);
+            break;
+        case DB_CHANGE_CHANGED:
+            search_index_remove(search, db, old_question);
+            search_index_add(search, db, &db->questions[index]);
+            break;
+    }
+}
+
+int search_index_attach(SearchIndex* index, Database* db) {
+    search_index_detach(index);
+    if (database_add_listener(db, on_database_changed, index) != GEN_OK) return GEN_ERROR_NO_MEMORY;
+    index->db = db;
+    return GEN_OK;
+}
+
+void search_index_detach(SearchIndex* index) {
+    if (!index->db) return;
+    database_remove_listener(index->db, on_database_changed, index);
+    index->db = NULL;
+}
+
+// --- Requête ---
+
+static int compare_list_size(const void* a, const void* b) {
+    const PostingList* x = *(const PostingList* const*)a;
+    const PostingList* y = *(const PostingList* const*)b;
+    return (x->count > y->count) - (x->count < y->count);
+}
+
+// Garde dans result les identifiants présents dans list ; retourne le nouveau compte
+static int intersect(int* result, int count, const PostingList* list) {
+    int n = 0;
+    if (list->count > count * 16) {
+        // Liste beaucoup plus longue : recherche dichotomique depuis la dernière position
+        int from = 0;
+        for (int i = 0; i < count; i++) {
+            from += posting_lower_bound(list->ids + from, list->count - from, result[i]);
+            if (from >= list->count) break;
+            if (list->ids[from] == result[i]) result[n++] = result[i];
+        }
+    } else {
+        int j = 0;
+        for (int i = 0; i < count && j < list->count; i++) {
+            while (j < list->count && list->ids[j] < result[i]) j++;
+            if (j < list->count && list->ids[j] == result[i]) result[n++] = result[i];
+        }
+    }
+    return n;
+}
+
+// Champs indexés de q repliés bout à bout, séparés par un espace (NULL si mémoire insuffisante)
+static char* fold_question(const Database* db, const Question* q) {
+    const char* fields[4 + QUESTION_MAX_CHOICES];
+    int nb_fields = 0;
+    fields[nb_fields++] = question_matiere(db, q);
+    fields[nb_fields++] = question_chapitre(db, q);
+    fields[nb_fields++] = question_enonce(q);
+    for (int i = 0; i < q->nbChoix && i < QUESTION_MAX_CHOICES; i++) {
+        fields[nb_fields++] = question_choice(q, i);
+    }
+
+    size_t size = 1;
+    for (int i = 0; i < nb_fields; i++) {
+        if (fields[i]) size += strlen(fields[i]) + 1;
+    }
+    char* folded = mem_alloc(MEM_INDEX, size);
+    if (!folded) return NULL;
+    size_t len = 0;
+    for (int i = 0; i < nb_fields; i++) {
+        if (!fields[i]) continue;
+        len += search_fold(fields[i], folded + len, size - len);
+        folded[len++] = ' ';
+    }
+    folded[len] = 0;
+    return folded;
+}
+
+// Vrai si chaque mot d'au moins 3 caractères de words (mots séparés par '\0', terminés par
+// un '\0' double) est une sous-chaîne de text. Le repliement remplace tout séparateur par un
+// espace : une sous-chaîne sans espace ne peut donc pas chevaucher deux mots.
+static int contains_words(const char* text, const char* words) {
+    for (const char* w = words; *w; w += strlen(w) + 1) {
+        if (strlen(w) >= 3 && !strstr(text, w)) return 0;
+    }
+    return 1;
+}
+
+// Les trigrammes ne font que présélectionner : "anana" a les trigrammes de "banane".
+// Garde les identifiants dont la question contient vraiment les mots ; ceux qui ne sont plus
+// dans la base (index incomplet après une erreur mémoire) sont écartés.
+static int verify_candidates(const Database* db, const char* words, int* result, int count) {
+    int n = 0;
+    for (int i = 0; i < count; i++) {
+        int position = database_find_by_id(db, result[i]);
+        if (position < 0) continue;
+        char* folded = fold_question(db, &db->questions[position]);
+        if (!folded) return -1;
+        if (contains_words(folded, words)) result[n++] = result[i];
+        mem_free(MEM_INDEX, folded);
+    }
+    return n;
+}
+
+int search_index_query(const SearchIndex* index, const Database* db, const char* query, int** ids) {
+    *ids = NULL;
+    if (!index->lists || !query) return -1;
+
+    // Deux '\0' en fin de texte : la liste de mots de contains_words
+    size_t size = strlen(query) + 2;
+    char* folded = mem_alloc(MEM_INDEX, size);
+    if (!folded) return -1;
+    size_t len = search_fold(query, folded, size - 1);
+    folded[len + 1] = 0;
+
+    CodeArray codes = {0};
+    collect_folded_trigrams(folded, &codes);
+    code_array_unique(&codes);
+    if (codes.error || codes.count == 0) {
+        mem_free(MEM_INDEX, codes.codes);
+        mem_free(MEM_INDEX, folded);
+        return -1;
+    }
+
+    // Mots de la requête séparés par des '\0', en sautant les espaces consécutifs
+    size_t words_len = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (folded[i] != ' ') folded[words_len++] = folded[i];
+        else if (words_len > 0 && folded[words_len - 1] != 0) folded[words_len++] = 0;
+    }
+    if (words_len > 0 && folded[words_len - 1] != 0) folded[words_len++] = 0;
+    folded[words_len] = 0;
+
+    // On part de la liste la plus courte : le coût suit le nombre de résultats possibles
+    const PostingList** lists = mem_alloc(MEM_INDEX, sizeof(PostingList*) * codes.count);
+    if (!lists) {
+        mem_free(MEM_INDEX, codes.codes);
+        mem_free(MEM_INDEX, folded);
+        return -1;
+    }
+    for (int i = 0; i < codes.count; i++) {
+        lists[i] = &index->lists[codes.codes[i]];
+    }
+    int nb_lists = codes.count;
+    mem_free(MEM_INDEX, codes.codes);
+    qsort(lists, nb_lists, sizeof(PostingList*), compare_list_size);
+
+    int count = lists[0]->count;
+    int* result = NULL;
+    if (count > 0) {
+        result = malloc(sizeof(int) * count); // Libéré par l'appelant avec free()
+        if (!result) {
+            mem_free(MEM_INDEX, lists);
+            mem_free(MEM_INDEX, folded);
+            return -1;
+        }
+        memcpy(result, lists[0]->ids, sizeof(int) * count);
+        for (int i = 1; i < nb_lists && count > 0; i++) {
+            count = intersect(result, count, lists[i]);
+        }
+        count = verify_candidates(db, folded, result, count);
+        if (count < 0) {
+            free(result);
+            result = NULL;
+        }
+    }
+    mem_free(MEM_INDEX, lists);
+    mem_free(MEM_INDEX, folded);
+
+    *ids = result;
+    return count;
+}
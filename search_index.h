@@ -0,0 +1,55 @@
+// search_index.h
+#ifndef SEARCH_INDEX_H
+#define SEARCH_INDEX_H
+
+#include <stddef.h>
+#include "structures.h"
+
+// Alphabet après repliement : a-z puis 0-9 ; tout autre caractère sépare les mots
+#define SEARCH_ALPHABET_SIZE 36
+#define SEARCH_TRIGRAM_COUNT (SEARCH_ALPHABET_SIZE * SEARCH_ALPHABET_SIZE * SEARCH_ALPHABET_SIZE)
+
+// Identifiants de questions (Question.id) contenant un trigramme, triés par ordre croissant
+typedef struct {
+    int* ids;
+    int count;
+    int capacity;
+} PostingList;
+
+// Index inversé par trigrammes sur la matière, le chapitre, l'énoncé et les choix.
+// Les trigrammes sont pris à l'intérieur des mots après repliement des accents et de la casse.
+typedef struct {
+    PostingList* lists;    // SEARCH_TRIGRAM_COUNT listes, indexées par code de trigramme
+    Database* db;          // Base suivie par search_index_attach (NULL sinon)
+    int error;             // Mis à 1 si une allocation a échoué : l'index est incomplet
+} SearchIndex;
+
+// Replie un texte UTF-8 pour la recherche : minuscules, lettres accentuées latines ramenées
+// à leur lettre de base ("Élève" -> "eleve"), tout autre caractère remplacé par un espace.
+// Écrit au plus out_size - 1 octets suivis d'un '\0' ; retourne la longueur écrite.
+size_t search_fold(const char* text, char* out, size_t out_size);
+
+int search_index_init(SearchIndex* index);
+void search_index_free(SearchIndex* index);
+
+// Indexe toutes les questions de la base
+int search_index_build(SearchIndex* index, const Database* db);
+
+// Tient l'index à jour : s'abonne aux modifications de la base (insertion, suppression, remplacement).
+// Retourne GEN_OK, ou GEN_ERROR_NO_MEMORY (l'index n'est alors plus tenu à jour).
+int search_index_attach(SearchIndex* index, Database* db);
+void search_index_detach(SearchIndex* index);
+
+// q est une question de db (ou vient d'en sortir, pour search_index_remove)
+void search_index_add(SearchIndex* index, const Database* db, const Question* q);
+void search_index_remove(SearchIndex* index, const Database* db, const Question* q);
+
+// Recherche les questions de db dont les champs contiennent chacun des mots de la requête
+// (sous-chaîne d'un mot, accents et casse ignorés). Les mots de moins de 3 caractères
+// ne filtrent pas. Les candidats de l'index sont vérifiés sur le texte des questions.
+// Remplit *ids (à libérer par l'appelant) avec les identifiants triés, tous présents dans
+// db, et retourne leur nombre ; retourne -1 si la requête ne contient aucun mot exploitable
+// (l'appelant affiche alors toute la base) ou en cas d'erreur mémoire.
+int search_index_query(const SearchIndex* index, const Database* db, const char* query, int** ids);
+
+#endif
@@ -0,0 +1,614 @@
+// server.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "server.h"
+
+#ifdef _WIN32
+
+int run_exam_server(const char* db_file, const char* socket_path, int nb_threads, int queue_size) {
+    fprintf(stderr, "Le mode serveur (socket Unix) n'est pas disponible sous Windows.\n");
+    return 2;
+}
+
+#else
+
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "database.h"
+#include "bank_watch.h"
+#include "bank_shards.h"
+#include "generator.h"
+#include "renderer.h"
+#include "string_map.h"
+#include "json.h"
+#include "trace.h"
+
+#ifndef MSG_NOSIGNAL
+    #define MSG_NOSIGNAL 0
+#endif
+
+// Questions candidates d'un couple matière/chapitre, calculées une seule fois
+typedef struct {
+    char* key;                   // "<matière>\x1f<chapitre>"
+    char* chapter;               // Référencé par partition.pools[0].chapitre
+    ChapterPartition partition;
+} CachedPartition;
+
+typedef struct {
+    Database db;                 // Modifiée seulement par un rechargement ou le chargement d'une
+                                 // matière (base découpée), sous db_lock en écriture
+    pthread_rwlock_t db_lock;    // Lecture pendant chaque requête
+    BankWatch watch;
+    int watching;
+
+    pthread_mutex_t cache_lock;
+    StringMap cache_index;       // Clé -> indice dans cache
+    CachedPartition* cache;
+    int cache_count;
+    int cache_capacity;
+    uint64_t next_seed;          // Graines des requêtes qui n'en donnent pas (protégé par cache_lock)
+
+    // File des connexions acceptées, bornée : le serveur cesse d'accepter quand elle est pleine
+    pthread_mutex_t queue_lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    int* queue;
+    int queue_size;
+    int queue_head;
+    int queue_count;
+    int stopping;
+} ExamServer;
+
+// Une connexion en cours : les données du document sont regroupées en trames de SERVER_CHUNK_SIZE
+typedef struct {
+    int fd;
+    unsigned char* buffer;
+    size_t used;
+    size_t sent;                 // Octets de document envoyés pour la requête en cours
+    int error;
+} ServerConnection;
+
+static volatile sig_atomic_t stop_requested = 0;
+
+static void on_stop_signal(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+// --- Trames ---
+
+static int read_full(int fd, void* data, size_t length) {
+    unsigned char* p = data;
+    while (length > 0) {
+        ssize_t n = recv(fd, p, length, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+static int write_full(int fd, const void* data, size_t length) {
+    const unsigned char* p = data;
+    while (length > 0) {
+        ssize_t n = send(fd, p, length, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        p += n;
+        length -= (size_t)n;
+    }
+    return 0;
+}
+
+static int write_frame(int fd, char kind, const void* data, size_t length) {
+    unsigned char header[5];
+    header[0] = (unsigned char)kind;
+    header[1] = (unsigned char)(length >> 24);
+    header[2] = (unsigned char)(length >> 16);
+    header[3] = (unsigned char)(length >> 8);
+    header[4] = (unsigned char)length;
+    if (write_full(fd, header, sizeof(header)) != 0) return -1;
+    return (length > 0) ? write_full(fd, data, length) : 0;
+}
+
+static int flush_connection(ServerConnection* conn) {
+    if (conn->used == 0 || conn->error) return conn->error ? -1 : 0;
+    if (write_frame(conn->fd, 'D', conn->buffer, conn->used) != 0) conn->error = 1;
+    conn->used = 0;
+    return conn->error ? -1 : 0;
+}
+
+// Envoie le document en trames 'D' de SERVER_CHUNK_SIZE octets au plus
+static int write_to_connection(void* user_data, const unsigned char* data, size_t length) {
+    ServerConnection* conn = user_data;
+    conn->sent += length;
+    while (length > 0 && !conn->error) {
+        size_t n = SERVER_CHUNK_SIZE - conn->used;
+        if (n > length) n = length;
+        memcpy(conn->buffer + conn->used, data, n);
+        conn->used += n;
+        data += n;
+        length -= n;
+        if (conn->used == SERVER_CHUNK_SIZE) flush_connection(conn);
+    }
+    return conn->error ? -1 : 0;
+}
+
+static int send_error(ServerConnection* conn, const char* message) {
+    conn->used = 0; // Données en attente : inutiles, le client abandonne le document
+    if (write_frame(conn->fd, 'E', message, strlen(message)) != 0) conn->error = 1;
+    return conn->error ? -1 : 0;
+}
+
+// --- Cache des candidats ---
+
+// Ajoute une partition au cache ; retourne 0 si elle y est gardée (key et partition
+// lui appartiennent alors), -1 sinon
+static int cache_partition(ExamServer* server, char* key, const char* chapter, ChapterPartition* partition) {
+    if (server->cache_count >= server->cache_capacity) {
+        int new_capacity = server->cache_capacity ? server->cache_capacity * 2 : 16;
+        CachedPartition* cache = realloc(server->cache, sizeof(CachedPartition) * new_capacity);
+        if (!cache) return -1;
+        server->cache = cache;
+        server->cache_capacity = new_capacity;
+    }
+    CachedPartition* entry = &server->cache[server->cache_count];
+    entry->chapter = strdup(chapter);
+    if (!entry->chapter || string_map_put(&server->cache_index, key, server->cache_count) < 0) {
+        free(entry->chapter);
+        return -1;
+    }
+    entry->key = key;
+    entry->partition = *partition;
+    entry->partition.pools[0].chapitre = entry->chapter[0] ? entry->chapter : "";
+    server->cache_count++;
+    return 0;
+}
+
+// Vide le cache (candidats calculés sur une version précédente de la base)
+static void free_cache(ExamServer* server) {
+    for (int i = 0; i < server->cache_count; i++) {
+        free(server->cache[i].key);
+        free(server->cache[i].chapter);
+        free_chapter_partition(&server->cache[i].partition);
+    }
+    free(server->cache);
+    server->cache = NULL;
+    server->cache_count = 0;
+    server->cache_capacity = 0;
+    string_map_free(&server->cache_index);
+    string_map_init(&server->cache_index);
+}
+
+// Retourne les candidats du couple matière/chapitre, calculés au premier appel. Les
+// partitions vides (matière ou chapitre inconnus) ne sont pas gardées, pour qu'une suite
+// de requêtes erronées ne fasse pas grossir le cache : elles sont rendues dans *temporary,
+// que l'appelant libère après la requête.
+static const ChapterPool* find_pool(ExamServer* server, const char* subject, const char* chapter,
+                                    ChapterPartition* temporary) {
+    size_t size = strlen(subject) + strlen(chapter) + 2;
+    char* key = malloc(size);
+    if (!key) return NULL;
+    snprintf(key, size, "%s\x1f%s", subject, chapter);
+
+    const ChapterPool* pool = NULL;
+    int index;
+    pthread_mutex_lock(&server->cache_lock);
+    if (string_map_get(&server->cache_index, key, &index)) {
+        pool = &server->cache[index].partition.pools[0];
+    } else {
+        ChapterPartition partition;
+        const char* chapters[1] = { chapter };
+        if (partition_by_chapter(&server->db, subject, chapters, chapter[0] ? 1 : 0, &partition) == GEN_OK) {
+            const ChapterPool* candidates = &partition.pools[0];
+            if (candidates->nb_qcm + candidates->nb_exercice > 0 &&
+                cache_partition(server, key, chapter, &partition) == 0) {
+                pool = &server->cache[server->cache_count - 1].partition.pools[0];
+                key = NULL;
+            } else {
+                *temporary = partition;
+                pool = &temporary->pools[0];
+            }
+        }
+    }
+    pthread_mutex_unlock(&server->cache_lock);
+    free(key);
+    return pool;
+}
+
+// Base découpée : charge la matière à sa première demande. Ses questions s'ajoutent à la fin
+// de la base, donc les candidats déjà calculés pour les autres matières restent valables.
+static void require_subject(ExamServer* server, const char* subject) {
+    pthread_rwlock_rdlock(&server->db_lock);
+    const BankShard* shard = bank_shards_find(&server->db, subject);
+    int pending = shard && !shard->loaded;
+    pthread_rwlock_unlock(&server->db_lock);
+    if (!pending) return;
+
+    pthread_rwlock_wrlock(&server->db_lock);
+    int status = database_require_subject(&server->db, subject); // Sans effet si un autre thread l'a chargée
+    pthread_rwlock_unlock(&server->db_lock);
+    if (status != GEN_OK) {
+        printf("[serveur] matiere '%s' non chargee : %s\n", subject, gen_status_message(status));
+        fflush(stdout);
+    }
+}
+
+// --- Requêtes ---
+
+// Lit les paramètres d'une requête ; retourne -1 et décrit l'erreur si elle est invalide
+static int read_request(ExamServer* server, const JsonValue* request, ExamRequest* exam,
+                        const char** chapter, const Renderer** renderer, char* error, size_t error_size) {
+    if (request->type != JSON_OBJECT) {
+        snprintf(error, error_size, "la requete doit etre un objet JSON");
+        return -1;
+    }
+    const char* type = json_get_string(request, "type", "qcm");
+    const char* format = json_get_string(request, "format", "PDF");
+    const JsonValue* seed = json_get(request, "seed");
+
+    exam->matiere = json_get_string(request, "subject", json_get_string(request, "matiere", NULL));
+    exam->avoid_near_duplicates = json_get_bool(request, "avoid_near_duplicates", 0);
+    exam->seeded = 1;
+    *chapter = json_get_string(request, "chapter", json_get_string(request, "chapitre", ""));
+    *renderer = renderer_find(format);
+
+    if (!exam->matiere || exam->matiere[0] == 0) {
+        snprintf(error, error_size, "\"subject\" manquant");
+        return -1;
+    }
+    if (strcmp(type, "qcm") == 0 || strcmp(type, "QCM") == 0) {
+        exam->exam_type = EXAM_TYPE_QCM_ONLY;
+    } else if (strcmp(type, "mixte") == 0 || strcmp(type, "mixed") == 0) {
+        exam->exam_type = EXAM_TYPE_MIXED;
+    } else {
+        snprintf(error, error_size, "type inconnu '%s' (qcm ou mixte)", type);
+        return -1;
+    }
+    if (!*renderer) {
+        snprintf(error, error_size, "format inconnu '%s'", format);
+        return -1;
+    }
+
+    // Les nombres JSON sont des doubles : au-delà de 2^53 la graine ne serait pas exacte
+    if (seed && seed->type != JSON_NULL) {
+        if (seed->type != JSON_NUMBER || seed->number < 0 || seed->number > 9007199254740992.0) {
+            snprintf(error, error_size, "\"seed\" doit etre un entier entre 0 et 2^53");
+            return -1;
+        }
+        exam->seed = (uint64_t)seed->number;
+    } else {
+        pthread_mutex_lock(&server->cache_lock);
+        server->next_seed = generator_mix_seed(server->next_seed + 1);
+        exam->seed = server->next_seed >> 11;
+        pthread_mutex_unlock(&server->cache_lock);
+    }
+    return 0;
+}
+
+static void handle_request(ExamServer* server, ServerConnection* conn, const char* text) {
+    char error[256];
+    GenerationReport report;
+    ExamRequest exam = {0};
+    const char* chapter = "";
+    const Renderer* renderer = NULL;
+
+    JsonValue* request = json_parse(text, error, sizeof(error));
+    if (!request || read_request(server, request, &exam, &chapter, &renderer, error, sizeof(error)) != 0) {
+        send_error(conn, error);
+        json_free(request);
+        return;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    uint64_t span = trace_begin();
+
+    // La base et le cache ne changent pas tant que la requête les utilise. Le document est
+    // produit en mémoire : un client qui ne lit plus ne retient pas le verrou, et les
+    // rechargements n'attendent que la génération.
+    require_subject(server, exam.matiere);
+    pthread_rwlock_rdlock(&server->db_lock);
+    ChapterPartition temporary = {0};
+    const ChapterPool* pool = find_pool(server, exam.matiere, chapter, &temporary);
+    exam.report = &report;
+    int result = GEN_ERROR_NO_MEMORY;
+    OutputSink sink;
+    output_sink_init_memory(&sink);
+    if (pool) {
+        ExamOutput output = { renderer, &sink };
+        result = generate_exam_from_pool(&server->db, &exam, pool, &output, 1);
+    }
+    free_chapter_partition(&temporary);
+    pthread_rwlock_unlock(&server->db_lock);
+
+    conn->sent = 0;
+    conn->used = 0;
+    if (result == GEN_OK) write_to_connection(conn, sink.data, sink.size);
+    output_sink_free(&sink);
+    if (result == GEN_OK && flush_connection(conn) == 0) {
+        char summary[256];
+        int n = snprintf(summary, sizeof(summary), "{\"format\": \"%s\", \"extension\": \"%s\", \"bytes\": %zu, \"seed\": %llu}",
+                         renderer->name, renderer->extension, conn->sent, (unsigned long long)exam.seed);
+        if (write_frame(conn->fd, 'K', summary, (size_t)n) != 0) conn->error = 1;
+    } else if (!conn->error) {
+        send_error(conn, (pool && report.message[0]) ? report.message : gen_status_message(result));
+    }
+
+    trace_end(span, "handle_request");
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) * 1000.0 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("[serveur] %s / %s (%s) : %s, %zu octets en %.1f ms\n", exam.matiere, chapter[0] ? chapter : "(tous)",
+           renderer->name, (result == GEN_OK && !conn->error) ? "ok" : "echec", conn->sent, elapsed);
+    fflush(stdout);
+    json_free(request);
+}
+
+static void serve_connection(ExamServer* server, int fd) {
+    // Un client inactif, ou qui ne lit plus ses réponses, ne garde pas un thread indéfiniment
+    struct timeval timeout = { SERVER_IDLE_TIMEOUT, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    ServerConnection conn = { fd, malloc(SERVER_CHUNK_SIZE), 0, 0, 0 };
+    char* text = malloc(SERVER_MAX_REQUEST + 1);
+    if (!conn.buffer || !text) {
+        send_error(&conn, "memoire insuffisante");
+        free(conn.buffer);
+        free(text);
+        return;
+    }
+
+    while (!conn.error) {
+        unsigned char header[5];
+        if (read_full(fd, header, sizeof(header)) != 0) break;
+        size_t length = ((size_t)header[1] << 24) | ((size_t)header[2] << 16) | ((size_t)header[3] << 8) | header[4];
+        if (header[0] != 'G' || length > SERVER_MAX_REQUEST) {
+            send_error(&conn, header[0] != 'G' ? "trame inconnue" : "requete trop longue");
+            break; // Le flux n'est plus synchronisé : on ferme
+        }
+        if (read_full(fd, text, length) != 0) break;
+        text[length] = 0;
+        handle_request(server, &conn, text);
+    }
+    free(conn.buffer);
+    free(text);
+}
+
+// --- Threads ---
+
+static void* server_worker(void* data) {
+    ExamServer* server = data;
+    trace_set_thread_name("server-worker");
+    for (;;) {
+        pthread_mutex_lock(&server->queue_lock);
+        while (server->queue_count == 0 && !server->stopping) {
+            pthread_cond_wait(&server->not_empty, &server->queue_lock);
+        }
+        if (server->queue_count == 0) {
+            pthread_mutex_unlock(&server->queue_lock);
+            break;
+        }
+        int fd = server->queue[server->queue_head];
+        server->queue_head = (server->queue_head + 1) % server->queue_size;
+        server->queue_count--;
+        pthread_cond_signal(&server->not_full);
+        pthread_mutex_unlock(&server->queue_lock);
+
+        serve_connection(server, fd);
+        close(fd);
+    }
+    return NULL;
+}
+
+// Place la connexion dans la file ; attend qu'une place se libère si elle est pleine
+static void enqueue_connection(ExamServer* server, int fd) {
+    pthread_mutex_lock(&server->queue_lock);
+    while (server->queue_count == server->queue_size && !stop_requested) {
+        pthread_cond_wait(&server->not_full, &server->queue_lock);
+    }
+    if (server->queue_count < server->queue_size) {
+        server->queue[(server->queue_head + server->queue_count) % server->queue_size] = fd;
+        server->queue_count++;
+        pthread_cond_signal(&server->not_empty);
+        fd = -1;
+    }
+    pthread_mutex_unlock(&server->queue_lock);
+    if (fd >= 0) close(fd);
+}
+
+// Applique les modifications du fichier de questions une fois les requêtes en cours terminées
+static void reload_database(ExamServer* server) {
+    BankReloadStats stats;
+    pthread_rwlock_wrlock(&server->db_lock);
+    int status = bank_watch_reload(&server->watch, &server->db, &stats);
+    int changed = stats.added + stats.updated + stats.removed;
+    if (changed > 0 || status != GEN_OK) free_cache(server); // Les indices des candidats ont pu changer
+    pthread_rwlock_unlock(&server->db_lock);
+
+    if (status != GEN_OK) {
+        printf("[serveur] rechargement de la base interrompu : %s\n", gen_status_message(status));
+    } else if (changed > 0) {
+        printf("[serveur] base rechargee : %d ajoutee(s), %d modifiee(s), %d supprimee(s), %d questions\n",
+               stats.added, stats.updated, stats.removed, server->db.count);
+    }
+    fflush(stdout);
+}
+
+static uint64_t monotonic_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+static int open_socket(const char* socket_path) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (strlen(socket_path) >= sizeof(address.sun_path)) {
+        fprintf(stderr, "Chemin de socket trop long : %s\n", socket_path);
+        return -1;
+    }
+    strcpy(address.sun_path, socket_path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        perror("Erreur de creation de la socket");
+        return -1;
+    }
+    unlink(socket_path); // Socket laissée par un serveur précédent
+    if (bind(fd, (struct sockaddr*)&address, sizeof(address)) != 0 || listen(fd, 128) != 0) {
+        perror("Erreur d'ouverture de la socket");
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int run_exam_server(const char* db_file, const char* socket_path, int nb_threads, int queue_size) {
+    ExamServer server;
+    memset(&server, 0, sizeof(server));
+    if (nb_threads <= 0) {
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        nb_threads = (n > 0) ? (int)n : 1;
+    }
+    if (queue_size <= 0) queue_size = 4 * nb_threads;
+
+    int status = load_database(&server.db, db_file);
+    if (status == GEN_ERROR_IO) {
+        printf("AVERTISSEMENT: Fichier '%s' non trouve. Une base de donnees vide sera utilisee.\n", db_file);
+    } else if (status != GEN_OK) {
+        // Une base chargée en partie servirait des épreuves incomplètes
+        fprintf(stderr, "Erreur lors du chargement de '%s' : %s\n", db_file, gen_status_message(status));
+        free_database(&server.db);
+        return 2;
+    }
+    if (server.db.shards) {
+        printf("Base decoupee '%s' : %d questions, %d matieres chargees a la premiere demande.\n", db_file,
+               database_total_count(&server.db), server.db.shards->count);
+    } else {
+        printf("Base de donnees '%s' chargee. %d questions trouvees.\n", db_file, server.db.count);
+    }
+    // Une base découpée n'est pas surveillée (un fichier par matière), ni une base SQLite
+    server.watching = !server.db.shards && !server.db.storage &&
+                      bank_watch_init(&server.watch, &server.db, db_file) == GEN_OK;
+
+    int listen_fd = open_socket(socket_path);
+    server.queue = malloc(sizeof(int) * queue_size);
+    pthread_t* threads = malloc(sizeof(pthread_t) * nb_threads);
+    if (listen_fd < 0 || !server.queue || !threads) {
+        if (listen_fd >= 0) {
+            close(listen_fd);
+            unlink(socket_path);
+        }
+        free(server.queue);
+        free(threads);
+        if (server.watching) bank_watch_free(&server.watch);
+        free_database(&server.db);
+        return 2;
+    }
+    server.queue_size = queue_size;
+    server.next_seed = (uint64_t)time(NULL);
+    string_map_init(&server.cache_index);
+    pthread_rwlock_init(&server.db_lock, NULL);
+    pthread_mutex_init(&server.cache_lock, NULL);
+    pthread_mutex_init(&server.queue_lock, NULL);
+    pthread_cond_init(&server.not_empty, NULL);
+    pthread_cond_init(&server.not_full, NULL);
+
+    // Les signaux d'arrêt ne doivent interrompre que accept() dans le thread principal
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = on_stop_signal;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    sigset_t stop_signals, previous;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &previous);
+    int started = 0;
+    for (int t = 0; t < nb_threads; t++) {
+        if (pthread_create(&threads[t], NULL, server_worker, &server) != 0) break;
+        started++;
+    }
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+
+    if (started == 0) {
+        fprintf(stderr, "Impossible de demarrer les threads du serveur.\n");
+        stop_requested = 1;
+    } else {
+        printf("Serveur en ecoute sur %s (%d threads, file de %d connexions).\n", socket_path, started, queue_size);
+        fflush(stdout);
+    }
+
+    // Attente des connexions et des modifications du fichier, relu BANK_WATCH_DELAY_MS
+    // après le dernier événement
+    struct pollfd fds[2] = { { listen_fd, POLLIN, 0 }, { -1, POLLIN, 0 } };
+    if (server.watching) fds[1].fd = bank_watch_fd(&server.watch);
+    uint64_t reload_at = 0;
+    while (!stop_requested) {
+        int timeout = -1;
+        if (reload_at) {
+            uint64_t now = monotonic_ms();
+            timeout = (reload_at > now) ? (int)(reload_at - now) : 0;
+        }
+        int ready = poll(fds, fds[1].fd >= 0 ? 2 : 1, timeout);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            perror("Erreur d'attente des connexions");
+            break;
+        }
+        if (fds[1].fd >= 0 && (fds[1].revents & POLLIN) && bank_watch_poll(&server.watch)) {
+            reload_at = monotonic_ms() + BANK_WATCH_DELAY_MS;
+        }
+        if (reload_at && monotonic_ms() >= reload_at) {
+            reload_database(&server);
+            reload_at = 0;
+        }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        int fd = accept(listen_fd, NULL, NULL);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            perror("Erreur d'acceptation d'une connexion");
+            break;
+        }
+        enqueue_connection(&server, fd);
+    }
+
+    // Arrêt : plus de nouvelles connexions, les threads vident la file puis s'arrêtent
+    close(listen_fd);
+    unlink(socket_path);
+    pthread_mutex_lock(&server.queue_lock);
+    server.stopping = 1;
+    pthread_cond_broadcast(&server.not_empty);
+    pthread_mutex_unlock(&server.queue_lock);
+    for (int t = 0; t < started; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    printf("Serveur arrete.\n");
+
+    free(threads);
+    free(server.queue);
+    free_cache(&server);
+    pthread_cond_destroy(&server.not_empty);
+    pthread_cond_destroy(&server.not_full);
+    pthread_mutex_destroy(&server.queue_lock);
+    pthread_mutex_destroy(&server.cache_lock);
+    pthread_rwlock_destroy(&server.db_lock);
+    if (server.watching) bank_watch_free(&server.watch);
+    free_database(&server.db);
+    return started ? 0 : 2;
+}
+
+#endif
@@ -0,0 +1,37 @@
+// server.h - Service de génération résident sur une socket Unix
+#ifndef SERVER_H
+#define SERVER_H
+
+// Taille maximale d'une requête (JSON) et des blocs de données renvoyés
+#define SERVER_MAX_REQUEST 65536
+#define SERVER_CHUNK_SIZE 65536
+
+// Délai (secondes) au-delà duquel une connexion inactive, ou qui ne lit plus, est fermée
+#define SERVER_IDLE_TIMEOUT 5
+
+// Protocole : chaque message est une trame [type : 1 octet][longueur : 4 octets gros-boutiste][données].
+//
+// Le client envoie des trames 'G' contenant une requête JSON :
+//   { "subject": "Maths", "chapter": "Algebre", "type": "mixte", "format": "PDF",
+//     "seed": 42, "avoid_near_duplicates": true }
+// "subject" est obligatoire ; chapitre vide ou absent : tous les chapitres ; un seul format.
+//
+// Le serveur produit le document en entier, puis répond par des trames 'D' (morceaux du
+// document, dans l'ordre) puis soit une trame 'K' (succès, JSON {"format", "extension",
+// "bytes", "seed"}), soit une trame 'E' (message d'erreur ; les trames 'D' déjà reçues
+// doivent être ignorées). Plusieurs requêtes peuvent se suivre sur la même connexion.
+//
+// La base est chargée une fois ; les questions candidates de chaque couple matière/chapitre
+// sont calculées à la première demande puis gardées en mémoire. Quand un autre programme
+// modifie le fichier, seules les lignes changées sont relues (bank_watch.h) : les requêtes
+// en cours se terminent, la base est mise à jour et les candidats sont recalculés. Une base
+// découpée (db_file est un répertoire, bank_shards.h) n'est pas surveillée : chaque matière est
+// chargée à sa première demande. Une base SQLite (storage.h) n'est pas surveillée non plus.
+// nb_threads connexions
+// (0 : une par cœur) sont servies en parallèle ; au-delà, jusqu'à queue_size connexions
+// attendent dans la file, puis le serveur cesse d'accepter jusqu'à ce qu'un thread se libère.
+// SIGINT ou SIGTERM arrêtent le serveur après les requêtes en cours.
+// Retourne le code de sortie du programme.
+int run_exam_server(const char* db_file, const char* socket_path, int nb_threads, int queue_size);
+
+#endif
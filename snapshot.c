@@ -0,0 +1,222 @@
+// snapshot.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "snapshot.h"
+#include "database.h"
+#include "trace.h"
+#include "mem_track.h"
+
+// --- Côté écrivain ---
+
+static void on_database_changed(const Database* db, DatabaseChange change, int index, int count,
+                                const Question* old_question, void* user_data) {
+    SnapshotPublisher* publisher = user_data;
+    publisher->dirty = 1;
+}
+
+// Contenu supprimé ou remplacé : gardé jusqu'à ce que les versions qui le montrent soient libérées
+static void on_question_retired(Question* q, void* user_data) {
+    SnapshotPublisher* publisher = user_data;
+
+    // Question ajoutée après la dernière publication : aucun lecteur ne l'a vue
+    if (q->id >= publisher->published_next_id) {
+        database_free_question_content(publisher->db, q);
+        return;
+    }
+    if (publisher->nb_retired >= publisher->retired_capacity) {
+        int new_capacity = publisher->retired_capacity ? publisher->retired_capacity * 2 : 16;
+        Question* retired = realloc(publisher->retired, sizeof(Question) * new_capacity);
+        // Mieux vaut perdre ce contenu que le libérer sous les yeux d'un lecteur
+        if (!retired) return;
+        publisher->retired = retired;
+        publisher->retired_capacity = new_capacity;
+    }
+    publisher->retired[publisher->nb_retired++] = *q;
+}
+
+// Arène remplacée par un compactage : la version publiée pointe encore dans ses régions
+static void on_arena_retired(Arena* arena, void* user_data) {
+    SnapshotPublisher* publisher = user_data;
+    publisher->dirty = 1;
+    if (publisher->nb_retired_arenas >= publisher->retired_arenas_capacity) {
+        int new_capacity = publisher->retired_arenas_capacity ? publisher->retired_arenas_capacity * 2 : 4;
+        Arena** arenas = realloc(publisher->retired_arenas, sizeof(Arena*) * new_capacity);
+        if (!arenas) return; // Comme pour les questions : perdue plutôt que libérée trop tôt
+        publisher->retired_arenas = arenas;
+        publisher->retired_arenas_capacity = new_capacity;
+    }
+    publisher->retired_arenas[publisher->nb_retired_arenas++] = arena;
+}
+
+static DatabaseSnapshot* build_snapshot(const Database* db, uint64_t version) {
+    DatabaseSnapshot* snapshot = calloc(1, sizeof(DatabaseSnapshot));
+    if (!snapshot) return NULL;
+    if (db->count > 0) {
+        snapshot->db.questions = malloc(sizeof(Question) * db->count);
+        if (!snapshot->db.questions) {
+            free(snapshot);
+            return NULL;
+        }
+        memcpy(snapshot->db.questions, db->questions, sizeof(Question) * db->count);
+    }
+    snapshot->db.count = db->count;
+    snapshot->db.capacity = db->count;
+    snapshot->db.next_id = db->next_id;
+    snapshot->db.labels = db->labels; // Libellés jamais déplacés : la table est lue sans copie
+    snapshot->version = version;
+    return snapshot;
+}
+
+static void free_retired(Database* db, RetiredSnapshot* retired) {
+    if (retired->snapshot) {
+        free(retired->snapshot->db.questions); // Les chaînes appartiennent à la base
+        free(retired->snapshot);
+    }
+    // Les blocs reviennent à l'arène de la base, ou partent avec leur arène remplacée
+    for (int i = 0; i < retired->count; i++) {
+        database_free_question_content(db, &retired->questions[i]);
+    }
+    free(retired->questions);
+    for (int i = 0; i < retired->nb_arenas; i++) {
+        arena_release(retired->arenas[i]);
+        mem_free(MEM_LOADER, retired->arenas[i]);
+    }
+    free(retired->arenas);
+}
+
+int snapshot_publisher_init(SnapshotPublisher* publisher, Database* db) {
+    memset(publisher, 0, sizeof(*publisher));
+    atomic_init(&publisher->epoch, 1);
+    for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+        atomic_init(&publisher->readers[i].epoch, 0);
+        atomic_init(&publisher->readers[i].in_use, 0);
+    }
+
+    DatabaseSnapshot* snapshot = build_snapshot(db, 1);
+    if (!snapshot) return GEN_ERROR_NO_MEMORY;
+    atomic_init(&publisher->current, snapshot);
+    publisher->version = 1;
+    publisher->published_next_id = db->next_id;
+    publisher->db = db;
+    db->retire = on_question_retired;
+    db->retire_arena = on_arena_retired;
+    db->retire_data = publisher;
+    if (database_add_listener(db, on_database_changed, publisher) != GEN_OK) {
+        db->retire = NULL;
+        db->retire_arena = NULL;
+        db->retire_data = NULL;
+        publisher->db = NULL;
+        free(snapshot->db.questions);
+        free(snapshot);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    return GEN_OK;
+}
+
+void snapshot_publisher_free(SnapshotPublisher* publisher) {
+    if (!publisher->db) return;
+    Database* db = publisher->db;
+    database_remove_listener(db, on_database_changed, publisher);
+    db->retire = NULL;
+    db->retire_arena = NULL;
+    db->retire_data = NULL;
+    publisher->db = NULL;
+
+    for (int i = 0; i < publisher->nb_pending; i++) {
+        free_retired(db, &publisher->pending[i]);
+    }
+    free(publisher->pending);
+    RetiredSnapshot last = { atomic_load(&publisher->current), publisher->retired, publisher->nb_retired,
+                             publisher->retired_arenas, publisher->nb_retired_arenas, 0 };
+    free_retired(db, &last);
+    atomic_store(&publisher->current, NULL);
+    publisher->pending = NULL;
+    publisher->retired = NULL;
+    publisher->retired_arenas = NULL;
+    publisher->nb_pending = publisher->nb_retired = publisher->nb_retired_arenas = 0;
+}
+
+void snapshot_reclaim(SnapshotPublisher* publisher) {
+    uint64_t oldest = UINT64_MAX;
+    for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+        uint64_t epoch = atomic_load(&publisher->readers[i].epoch);
+        if (epoch != 0 && epoch < oldest) oldest = epoch;
+    }
+
+    int kept = 0;
+    for (int i = 0; i < publisher->nb_pending; i++) {
+        if (publisher->pending[i].epoch < oldest) free_retired(publisher->db, &publisher->pending[i]);
+        else publisher->pending[kept++] = publisher->pending[i];
+    }
+    publisher->nb_pending = kept;
+}
+
+int snapshot_publish(SnapshotPublisher* publisher) {
+    if (!publisher->dirty) {
+        snapshot_reclaim(publisher);
+        return GEN_OK;
+    }
+    if (publisher->nb_pending >= publisher->pending_capacity) {
+        int new_capacity = publisher->pending_capacity ? publisher->pending_capacity * 2 : 8;
+        RetiredSnapshot* pending = realloc(publisher->pending, sizeof(RetiredSnapshot) * new_capacity);
+        if (!pending) return GEN_ERROR_NO_MEMORY;
+        publisher->pending = pending;
+        publisher->pending_capacity = new_capacity;
+    }
+    uint64_t span = trace_begin();
+    DatabaseSnapshot* snapshot = build_snapshot(publisher->db, publisher->version + 1);
+    trace_end(span, "snapshot_publish");
+    if (!snapshot) return GEN_ERROR_NO_MEMORY;
+
+    // Après l'échange, seuls les lecteurs déjà entrés (époque <= retired.epoch) voient l'ancienne version
+    RetiredSnapshot* retired = &publisher->pending[publisher->nb_pending++];
+    retired->snapshot = atomic_exchange(&publisher->current, snapshot);
+    retired->epoch = atomic_fetch_add(&publisher->epoch, 1);
+    retired->questions = publisher->retired;
+    retired->count = publisher->nb_retired;
+    retired->arenas = publisher->retired_arenas;
+    retired->nb_arenas = publisher->nb_retired_arenas;
+
+    publisher->retired = NULL;
+    publisher->nb_retired = 0;
+    publisher->retired_capacity = 0;
+    publisher->retired_arenas = NULL;
+    publisher->nb_retired_arenas = 0;
+    publisher->retired_arenas_capacity = 0;
+    publisher->version++;
+    publisher->published_next_id = publisher->db->next_id;
+    publisher->dirty = 0;
+
+    snapshot_reclaim(publisher);
+    return GEN_OK;
+}
+
+// --- Côté lecteurs ---
+
+const Database* snapshot_acquire(SnapshotPublisher* publisher, SnapshotReader* reader) {
+    for (int i = 0; i < SNAPSHOT_MAX_READERS; i++) {
+        int expected = 0;
+        if (!atomic_compare_exchange_strong(&publisher->readers[i].in_use, &expected, 1)) continue;
+
+        // L'époque est annoncée avant de lire le pointeur : l'écrivain ne peut plus
+        // libérer une version publiée à partir de cette époque
+        atomic_store(&publisher->readers[i].epoch, atomic_load(&publisher->epoch));
+        const DatabaseSnapshot* snapshot = atomic_load(&publisher->current);
+        reader->publisher = publisher;
+        reader->slot = i;
+        return &snapshot->db;
+    }
+    reader->publisher = NULL;
+    reader->slot = -1;
+    return NULL;
+}
+
+void snapshot_release(SnapshotReader* reader) {
+    if (!reader->publisher) return;
+    SnapshotSlot* slot = &reader->publisher->readers[reader->slot];
+    atomic_store(&slot->epoch, 0);
+    atomic_store(&slot->in_use, 0);
+    reader->publisher = NULL;
+    reader->slot = -1;
+}
@@ -0,0 +1,93 @@
+// snapshot.h - Instantanés de la base lisibles sans verrou depuis d'autres threads
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include "structures.h"
+#include "gen_status.h"
+
+// Nombre maximal de lecteurs simultanés (threads de génération, serveur...)
+#define SNAPSHOT_MAX_READERS 64
+
+// Une version figée de la base : copie du tableau de questions, chaînes partagées avec
+// la base vivante. Rien n'y est modifié ni libéré tant qu'un lecteur peut la voir.
+typedef struct {
+    Database db;                 // Sans écouteurs ; à n'utiliser qu'en lecture
+    uint64_t version;
+} DatabaseSnapshot;
+
+typedef struct {
+    atomic_uint_fast64_t epoch;  // Époque annoncée par le lecteur, 0 si l'emplacement est libre
+    atomic_int in_use;
+} SnapshotSlot;
+
+// Une version remplacée, en attente de libération avec les contenus de questions
+// retirés de la base et les arènes remplacées par un compactage pendant qu'elle était publiée
+typedef struct {
+    DatabaseSnapshot* snapshot;
+    Question* questions;
+    int count;
+    Arena** arenas;
+    int nb_arenas;
+    uint64_t epoch;              // Libérable quand aucun lecteur n'a annoncé une époque <= epoch
+} RetiredSnapshot;
+
+// Publication des instantanés d'une base. Un seul thread (celui qui modifie la base)
+// appelle les fonctions snapshot_publisher_* et snapshot_publish ; les lecteurs de
+// n'importe quel thread utilisent snapshot_acquire / snapshot_release, qui ne prennent
+// aucun verrou et n'attendent jamais l'écrivain.
+//
+// Récupération par époques : chaque lecteur annonce l'époque courante avant de lire le
+// pointeur publié ; une version remplacée à l'époque e n'est libérée qu'une fois que
+// plus aucun lecteur actif n'a annoncé une époque <= e.
+typedef struct {
+    _Atomic(DatabaseSnapshot*) current;
+    atomic_uint_fast64_t epoch;  // Commence à 1
+    SnapshotSlot readers[SNAPSHOT_MAX_READERS];
+
+    // Réservé au thread qui modifie la base
+    Database* db;
+    int dirty;                   // La base a changé depuis la dernière publication
+    uint64_t version;
+    int published_next_id;       // Les questions d'id >= n'apparaissent dans aucun instantané
+    Question* retired;           // Contenus retirés depuis la dernière publication
+    int nb_retired;
+    int retired_capacity;
+    Arena** retired_arenas;      // Arènes remplacées depuis la dernière publication
+    int nb_retired_arenas;
+    int retired_arenas_capacity;
+    RetiredSnapshot* pending;
+    int nb_pending;
+    int pending_capacity;
+} SnapshotPublisher;
+
+typedef struct {
+    SnapshotPublisher* publisher;
+    int slot;
+} SnapshotReader;
+
+// S'abonne aux modifications de db et publie une première version. Dès lors, le contenu
+// des questions supprimées ou remplacées, comme l'arène quittée lors d'un compactage
+// (database_compact), n'est libéré qu'après les lecteurs qui le voient.
+// Retourne GEN_OK, ou GEN_ERROR_NO_MEMORY (la base est alors laissée telle quelle).
+int snapshot_publisher_init(SnapshotPublisher* publisher, Database* db);
+
+// Se désabonne et libère toutes les versions ; aucun lecteur ne doit être actif
+void snapshot_publisher_free(SnapshotPublisher* publisher);
+
+// Publie l'état actuel de la base s'il a changé (copie du tableau de questions, O(n)),
+// puis libère les anciennes versions qui ne sont plus lues. Les modifications
+// successives sont regroupées : on publie quand un lecteur va en avoir besoin.
+// Retourne GEN_OK, ou GEN_ERROR_NO_MEMORY (la version précédente reste publiée).
+int snapshot_publish(SnapshotPublisher* publisher);
+
+// Libère les anciennes versions que plus aucun lecteur ne peut voir
+void snapshot_reclaim(SnapshotPublisher* publisher);
+
+// Lecteur : retourne la dernière version publiée, valide jusqu'à snapshot_release().
+// Retourne NULL si SNAPSHOT_MAX_READERS lecteurs sont déjà actifs.
+const Database* snapshot_acquire(SnapshotPublisher* publisher, SnapshotReader* reader);
+void snapshot_release(SnapshotReader* reader);
+
+#endif
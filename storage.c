@@ -0,0 +1,46 @@
+// storage.c
+#include <string.h>
+#include <strings.h>
+#include "storage.h"
+#include "mem_track.h"
+
+const StorageBackend* storage_find(const char* path) {
+    const char* dot = strrchr(path, '.');
+    const char* slash = strrchr(path, '/');
+    int sqlite = dot && (!slash || dot > slash) &&
+                 (strcasecmp(dot, ".db") == 0 || strcasecmp(dot, ".sqlite") == 0 || strcasecmp(dot, ".sqlite3") == 0);
+    if (!sqlite) return &STORAGE_TEXT;
+#ifdef GEN_WITH_SQLITE
+    return &STORAGE_SQLITE;
+#else
+    return NULL;
+#endif
+}
+
+int storage_open(const char* path, StorageOpenMode mode, Storage** out) {
+    *out = NULL;
+    const StorageBackend* backend = storage_find(path);
+    if (!backend) return GEN_ERROR_UNKNOWN_FORMAT;
+
+    Storage* storage = mem_calloc(MEM_LOADER, 1, sizeof(Storage));
+    if (!storage || !(storage->path = mem_strdup(MEM_LOADER, path))) {
+        mem_free(MEM_LOADER, storage);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    storage->backend = backend;
+    int status = backend->open(path, mode, &storage->state);
+    if (status != GEN_OK) {
+        mem_free(MEM_LOADER, storage->path);
+        mem_free(MEM_LOADER, storage);
+        return status;
+    }
+    *out = storage;
+    return GEN_OK;
+}
+
+void storage_close(Storage* storage) {
+    if (!storage) return;
+    storage->backend->close(storage->state);
+    mem_free(MEM_LOADER, storage->path);
+    mem_free(MEM_LOADER, storage);
+}
@@ -0,0 +1,73 @@
+// storage.h - Supports d'enregistrement de la base : fichier texte ou base SQLite
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <stdint.h>
+#include "structures.h"
+#include "gen_status.h"
+
+// Identifiant d'une question dans son support : rang de la question dans le fichier texte
+// (à partir de 1), clé primaire dans SQLite. 0 désigne une question pas encore enregistrée.
+typedef int64_t StorageKey;
+
+// Reçoit chaque question lue par iterate, avec sa signature MinHash ; la question (et son
+// bloc) appartient ensuite à la fonction. Retourne GEN_OK pour continuer ; un autre code
+// arrête le parcours, et iterate le retourne.
+typedef int (*StorageVisitFunc)(void* user_data, StorageKey key, Question* q);
+
+typedef enum {
+    STORAGE_OPEN_EXISTING,   // Contenu du support conservé (support vide s'il n'existe pas)
+    STORAGE_OPEN_REPLACE     // Le commit ne garde que les questions écrites depuis l'ouverture
+} StorageOpenMode;
+
+// Un support. Chaque fonction retourne GEN_OK ou un code GenStatus (GEN_ERROR_IO si le
+// support ne peut être lu ou écrit, GEN_ERROR_INVALID_ARGUMENT pour une clé inconnue).
+// Les modifications (put, remove) forment une transaction : le fichier ne change qu'au
+// commit, d'un seul coup, et close abandonne celles qui n'ont pas été validées.
+// Un support ouvert n'est utilisé que par un thread à la fois.
+typedef struct {
+    const char* name;        // "texte", "sqlite"
+    int indexed;             // Non nul : put et remove ne touchent que la question visée ;
+                             // sinon le commit réécrit tout le support
+    int (*open)(const char* path, StorageOpenMode mode, void** state);
+    // Questions dans l'ordre du support, construites dans arena (isolées si NULL), libellés
+    // rangés dans labels (dans leur bloc si NULL)
+    int (*iterate)(void* state, Arena* arena, LabelTable* labels, StorageVisitFunc visit, void* user_data);
+    // Question isolée (free_question_content) de clé key
+    int (*get)(void* state, StorageKey key, Question* out);
+    // *key == 0 : ajoute q à la fin et y range sa clé ; sinon remplace la question de clé *key.
+    // Les libellés de q sont dans labels (NULL pour une question isolée).
+    int (*put)(void* state, StorageKey* key, const Question* q, const LabelTable* labels);
+    int (*remove)(void* state, StorageKey key);
+    int (*commit)(void* state);
+    void (*close)(void* state);
+} StorageBackend;
+
+// Format historique, une question par ligne (database.h) ; les clés sont des rangs, valables
+// tant que le support reste ouvert
+extern const StorageBackend STORAGE_TEXT;
+
+// Fichier SQLite (une table questions), avec -DGEN_WITH_SQLITE et -lsqlite3
+#ifdef GEN_WITH_SQLITE
+extern const StorageBackend STORAGE_SQLITE;
+#endif
+
+// Un support ouvert
+typedef struct Storage {
+    const StorageBackend* backend;
+    void* state;
+    char* path;
+} Storage;
+
+// Support d'après l'extension de path : ".db", ".sqlite" et ".sqlite3" pour SQLite (NULL si
+// compilé sans), le format texte sinon
+const StorageBackend* storage_find(const char* path);
+
+// Ouvre path avec le support de storage_find. Retourne GEN_OK (*out à fermer avec
+// storage_close), GEN_ERROR_UNKNOWN_FORMAT (SQLite absent), GEN_ERROR_IO ou GEN_ERROR_NO_MEMORY.
+int storage_open(const char* path, StorageOpenMode mode, Storage** out);
+
+// Abandonne les modifications non validées et libère le support ; NULL accepté
+void storage_close(Storage* storage);
+
+#endif
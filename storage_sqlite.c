@@ -0,0 +1,276 @@
+// storage_sqlite.c
+// Une ligne de la table questions par question, de clé primaire sa StorageKey : ajout,
+// modification et suppression ne touchent qu'une ligne. Les modifications d'une session
+// forment une transaction SQLite, ouverte à la première et validée par le commit.
+#ifdef GEN_WITH_SQLITE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sqlite3.h>
+#include "storage.h"
+#include "database.h"
+#include "minhash.h"
+#include "mem_track.h"
+#include "trace.h"
+
+// Les choix se suivent dans la colonne choix, chacun terminé par '\0' (comme dans le bloc
+// de la question) ; minhash garde la signature pour ne pas la recalculer au chargement.
+// AUTOINCREMENT : une clé supprimée n'est jamais redonnée.
+static const char TABLE_SCHEMA[] =
+    "CREATE TABLE IF NOT EXISTS questions ("
+    " id INTEGER PRIMARY KEY AUTOINCREMENT,"
+    " matiere TEXT NOT NULL, chapitre TEXT NOT NULL, type TEXT NOT NULL, enonce TEXT NOT NULL,"
+    " bonne_reponse INTEGER NOT NULL, points INTEGER NOT NULL,"
+    " nb_choix INTEGER NOT NULL, choix BLOB, minhash BLOB)";
+
+#define TABLE_COLUMNS "matiere, chapitre, type, enonce, bonne_reponse, points, nb_choix, choix, minhash"
+
+enum { STMT_SELECT_ALL, STMT_SELECT, STMT_INSERT, STMT_UPDATE, STMT_DELETE, STMT_COUNT };
+
+static const char* const TABLE_STATEMENTS[STMT_COUNT] = {
+    "SELECT id, " TABLE_COLUMNS " FROM questions ORDER BY id",
+    "SELECT id, " TABLE_COLUMNS " FROM questions WHERE id = ?1",
+    "INSERT INTO questions (" TABLE_COLUMNS ") VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9)",
+    "UPDATE questions SET matiere = ?1, chapitre = ?2, type = ?3, enonce = ?4, bonne_reponse = ?5,"
+    " points = ?6, nb_choix = ?7, choix = ?8, minhash = ?9 WHERE id = ?10",
+    "DELETE FROM questions WHERE id = ?1"
+};
+
+typedef struct {
+    sqlite3* db;
+    sqlite3_stmt* statements[STMT_COUNT];
+    int in_transaction;
+} SqliteStorage;
+
+static int sqlite_status(int code) {
+    if (code == SQLITE_OK || code == SQLITE_DONE || code == SQLITE_ROW) return GEN_OK;
+    return (code == SQLITE_NOMEM) ? GEN_ERROR_NO_MEMORY : GEN_ERROR_IO;
+}
+
+static void sqlite_close(void* state) {
+    SqliteStorage* st = state;
+    for (int i = 0; i < STMT_COUNT; i++) {
+        sqlite3_finalize(st->statements[i]);
+    }
+    if (st->in_transaction) sqlite3_exec(st->db, "ROLLBACK", NULL, NULL, NULL);
+    sqlite3_close(st->db);
+    mem_free(MEM_LOADER, st);
+}
+
+static int begin_transaction(SqliteStorage* st) {
+    if (st->in_transaction) return GEN_OK;
+    int status = sqlite_status(sqlite3_exec(st->db, "BEGIN IMMEDIATE", NULL, NULL, NULL));
+    if (status == GEN_OK) st->in_transaction = 1;
+    return status;
+}
+
+// Note dans la base la version des signatures qu'elle contient (dans la transaction en cours)
+static int write_signature_version(SqliteStorage* st) {
+    char pragma[64];
+    snprintf(pragma, sizeof(pragma), "PRAGMA user_version = %d", MINHASH_VERSION);
+    return sqlite_status(sqlite3_exec(st->db, pragma, NULL, NULL, NULL));
+}
+
+// Recalcule les signatures d'une base écrite avec une autre version de minhash_compute
+// (PRAGMA user_version), en une transaction
+static int refresh_signatures(SqliteStorage* st) {
+    sqlite3_stmt* stmt = NULL;
+    int code = sqlite3_prepare_v2(st->db, "PRAGMA user_version", -1, &stmt, NULL);
+    int version = (code == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    if (code != SQLITE_OK) return sqlite_status(code);
+    if (version == MINHASH_VERSION) return GEN_OK;
+
+    uint64_t span = trace_begin();
+    sqlite3_stmt* select = NULL;
+    sqlite3_stmt* update = NULL;
+    int status = begin_transaction(st);
+    if (status == GEN_OK) {
+        code = sqlite3_prepare_v2(st->db, "SELECT id, enonce FROM questions", -1, &select, NULL);
+        if (code == SQLITE_OK) {
+            code = sqlite3_prepare_v2(st->db, "UPDATE questions SET minhash = ?1 WHERE id = ?2", -1, &update, NULL);
+        }
+        while (code == SQLITE_OK && (code = sqlite3_step(select)) == SQLITE_ROW) {
+            uint16_t signature[MINHASH_SIZE];
+            minhash_compute((const char*)sqlite3_column_text(select, 1), signature);
+            sqlite3_bind_blob(update, 1, signature, sizeof(signature), SQLITE_STATIC);
+            sqlite3_bind_int64(update, 2, sqlite3_column_int64(select, 0));
+            code = sqlite3_step(update);
+            if (code == SQLITE_DONE) code = SQLITE_OK;
+            sqlite3_reset(update);
+        }
+        status = sqlite_status(code);
+    }
+    sqlite3_finalize(select);
+    sqlite3_finalize(update);
+    if (status == GEN_OK) status = write_signature_version(st);
+    if (status == GEN_OK) status = sqlite_status(sqlite3_exec(st->db, "COMMIT", NULL, NULL, NULL));
+    if (status == GEN_OK) st->in_transaction = 0; // Sinon sqlite_close annule
+    trace_end(span, "storage_sqlite_refresh_signatures");
+    return status;
+}
+
+static int sqlite_open(const char* path, StorageOpenMode mode, void** state) {
+    SqliteStorage* st = mem_calloc(MEM_LOADER, 1, sizeof(SqliteStorage));
+    if (!st) return GEN_ERROR_NO_MEMORY;
+    int code = sqlite3_open_v2(path, &st->db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, NULL);
+    if (code == SQLITE_OK) {
+        sqlite3_busy_timeout(st->db, 2000); // Un autre programme peut être en train de valider
+        code = sqlite3_exec(st->db, TABLE_SCHEMA, NULL, NULL, NULL);
+    }
+    for (int i = 0; i < STMT_COUNT && code == SQLITE_OK; i++) {
+        code = sqlite3_prepare_v2(st->db, TABLE_STATEMENTS[i], -1, &st->statements[i], NULL);
+    }
+    int status = sqlite_status(code);
+    if (status == GEN_OK && mode == STORAGE_OPEN_REPLACE) {
+        // Le contenu ne disparaît qu'au commit, avec l'arrivée des nouvelles questions
+        status = begin_transaction(st);
+        if (status == GEN_OK) status = sqlite_status(sqlite3_exec(st->db, "DELETE FROM questions", NULL, NULL, NULL));
+        if (status == GEN_OK) status = write_signature_version(st);
+    } else if (status == GEN_OK) {
+        status = refresh_signatures(st);
+    }
+    if (status != GEN_OK) {
+        sqlite_close(st);
+        return status;
+    }
+    *state = st;
+    return GEN_OK;
+}
+
+// Construit la question de la ligne courante de stmt (colonne 0 : id)
+static int read_row(sqlite3_stmt* stmt, Arena* arena, LabelTable* labels, Question* q) {
+    const char* fields[4];
+    for (int i = 0; i < 4; i++) {
+        const unsigned char* text = sqlite3_column_text(stmt, 1 + i);
+        fields[i] = text ? (const char*)text : "";
+    }
+    int bonne_reponse = sqlite3_column_int(stmt, 5);
+    int points = sqlite3_column_int(stmt, 6);
+    int nb_choix = sqlite3_column_int(stmt, 7);
+    const char* data = sqlite3_column_blob(stmt, 8);
+    int size = sqlite3_column_bytes(stmt, 8);
+
+    const char* choix[QUESTION_MAX_CHOICES];
+    int count = 0;
+    for (int offset = 0; data && offset < size && count < nb_choix && count < QUESTION_MAX_CHOICES; count++) {
+        choix[count] = data + offset;
+        const char* end = memchr(data + offset, 0, size - offset);
+        if (!end) return GEN_ERROR_IO; // Choix non terminé : ligne abîmée
+        offset = (int)(end - data) + 1;
+    }
+    int status = question_init_arena(q, arena, labels, fields[0], fields[1], fields[2], fields[3], choix, count,
+                                     bonne_reponse, points);
+    if (status != GEN_OK) return status;
+
+    const void* signature = sqlite3_column_blob(stmt, 9);
+    if (signature && sqlite3_column_bytes(stmt, 9) == (int)sizeof(q->minhash)) {
+        memcpy(q->minhash, signature, sizeof(q->minhash));
+    } else {
+        minhash_compute(question_enonce(q), q->minhash);
+    }
+    return GEN_OK;
+}
+
+static int sqlite_iterate(void* state, Arena* arena, LabelTable* labels, StorageVisitFunc visit, void* user_data) {
+    SqliteStorage* st = state;
+    sqlite3_stmt* stmt = st->statements[STMT_SELECT_ALL];
+    uint64_t span = trace_begin();
+    int status = GEN_OK;
+    int code = SQLITE_OK;
+    while (status == GEN_OK && (code = sqlite3_step(stmt)) == SQLITE_ROW) {
+        Question q;
+        status = read_row(stmt, arena, labels, &q);
+        if (status == GEN_OK) status = visit(user_data, sqlite3_column_int64(stmt, 0), &q);
+    }
+    if (status == GEN_OK) status = sqlite_status(code);
+    sqlite3_reset(stmt);
+    trace_end(span, "storage_sqlite_iterate");
+    return status;
+}
+
+static int sqlite_get(void* state, StorageKey key, Question* out) {
+    SqliteStorage* st = state;
+    sqlite3_stmt* stmt = st->statements[STMT_SELECT];
+    sqlite3_bind_int64(stmt, 1, key);
+    int code = sqlite3_step(stmt);
+    int status = (code == SQLITE_ROW) ? read_row(stmt, NULL, NULL, out)
+               : (code == SQLITE_DONE) ? GEN_ERROR_INVALID_ARGUMENT : sqlite_status(code);
+    sqlite3_reset(stmt);
+    return status;
+}
+
+// Lie les colonnes de q (libellés dans labels) aux paramètres 1 à 9 de stmt (sans copie :
+// q doit rester valide jusqu'à sqlite3_step)
+static void bind_question(sqlite3_stmt* stmt, const Question* q, const LabelTable* labels) {
+    sqlite3_bind_text(stmt, 1, question_label(labels, q, QUESTION_MATIERE), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 2, question_label(labels, q, QUESTION_CHAPITRE), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, question_label(labels, q, QUESTION_TYPE), -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 4, question_enonce(q), -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 5, q->bonneReponse);
+    sqlite3_bind_int(stmt, 6, q->points);
+    sqlite3_bind_int(stmt, 7, q->nbChoix);
+    if (q->nbChoix > 0) {
+        // Les choix sont contigus dans le bloc : la colonne en est une simple copie
+        const QuestionChoice* last = &q->choix[q->nbChoix - 1];
+        size_t size = last->offset + last->length + 1 - q->choix[0].offset;
+        sqlite3_bind_blob(stmt, 8, question_choice(q, 0), (int)size, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_null(stmt, 8);
+    }
+    sqlite3_bind_blob(stmt, 9, q->minhash, sizeof(q->minhash), SQLITE_STATIC);
+}
+
+static int sqlite_put(void* state, StorageKey* key, const Question* q, const LabelTable* labels) {
+    SqliteStorage* st = state;
+    int status = begin_transaction(st);
+    if (status != GEN_OK) return status;
+
+    sqlite3_stmt* stmt = st->statements[*key == 0 ? STMT_INSERT : STMT_UPDATE];
+    bind_question(stmt, q, labels);
+    if (*key != 0) sqlite3_bind_int64(stmt, 10, *key);
+    status = sqlite_status(sqlite3_step(stmt));
+    if (status == GEN_OK && *key == 0) *key = sqlite3_last_insert_rowid(st->db);
+    else if (status == GEN_OK && sqlite3_changes(st->db) == 0) status = GEN_ERROR_INVALID_ARGUMENT;
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    return status;
+}
+
+static int sqlite_remove(void* state, StorageKey key) {
+    SqliteStorage* st = state;
+    int status = begin_transaction(st);
+    if (status != GEN_OK) return status;
+
+    sqlite3_stmt* stmt = st->statements[STMT_DELETE];
+    sqlite3_bind_int64(stmt, 1, key);
+    status = sqlite_status(sqlite3_step(stmt));
+    if (status == GEN_OK && sqlite3_changes(st->db) == 0) status = GEN_ERROR_INVALID_ARGUMENT;
+    sqlite3_reset(stmt);
+    return status;
+}
+
+static int sqlite_commit(void* state) {
+    SqliteStorage* st = state;
+    if (!st->in_transaction) return GEN_OK;
+    uint64_t span = trace_begin();
+    int status = sqlite_status(sqlite3_exec(st->db, "COMMIT", NULL, NULL, NULL));
+    if (status == GEN_OK) st->in_transaction = 0;
+    trace_end(span, "storage_sqlite_commit");
+    return status;
+}
+
+const StorageBackend STORAGE_SQLITE = {
+    "sqlite",
+    1,
+    sqlite_open,
+    sqlite_iterate,
+    sqlite_get,
+    sqlite_put,
+    sqlite_remove,
+    sqlite_commit,
+    sqlite_close
+};
+
+#endif
@@ -0,0 +1,241 @@
+// storage_text.c
+// Le fichier texte n'a pas d'index : la première modification charge toutes ses questions,
+// et le commit réécrit le fichier entier dans un fichier temporaire qui le remplace ensuite.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "storage.h"
+#include "database.h"
+#include "mem_track.h"
+#include "trace.h"
+
+typedef struct {
+    char* path;
+    char* temp_path;         // path + ".tmp"
+    FILE* out;               // Mode STORAGE_OPEN_REPLACE : questions écrites au fil des put
+    Question* questions;     // Contenu chargé, questions isolées (clé k à l'index k - 1) ; choix NULL : supprimée
+    int count;
+    int capacity;
+    int loaded;
+    int modified;
+} TextStorage;
+
+static void free_questions(TextStorage* st) {
+    for (int i = 0; i < st->count; i++) {
+        free_question_content(&st->questions[i]);
+    }
+    mem_free(MEM_LOADER, st->questions);
+    st->questions = NULL;
+    st->count = 0;
+    st->capacity = 0;
+    st->loaded = 0;
+}
+
+static int text_open(const char* path, StorageOpenMode mode, void** state) {
+    TextStorage* st = mem_calloc(MEM_LOADER, 1, sizeof(TextStorage));
+    if (!st) return GEN_ERROR_NO_MEMORY;
+    size_t size = strlen(path) + 5;
+    st->path = mem_strdup(MEM_LOADER, path);
+    st->temp_path = mem_alloc(MEM_LOADER, size);
+    if (!st->path || !st->temp_path) {
+        mem_free(MEM_LOADER, st->path);
+        mem_free(MEM_LOADER, st->temp_path);
+        mem_free(MEM_LOADER, st);
+        return GEN_ERROR_NO_MEMORY;
+    }
+    snprintf(st->temp_path, size, "%s.tmp", path);
+    if (mode == STORAGE_OPEN_REPLACE) {
+        // Pas de copie des questions : elles partent directement dans le fichier temporaire
+        st->out = fopen(st->temp_path, "w");
+        if (!st->out) {
+            mem_free(MEM_LOADER, st->path);
+            mem_free(MEM_LOADER, st->temp_path);
+            mem_free(MEM_LOADER, st);
+            return GEN_ERROR_IO;
+        }
+        database_write_header(st->out);
+    }
+    *state = st;
+    return GEN_OK;
+}
+
+// Lit le fichier ligne par ligne, dans le format annoncé par sa première ligne ; un fichier
+// absent est vide
+static int read_file(TextStorage* st, Arena* arena, LabelTable* labels, StorageVisitFunc visit, void* user_data) {
+    FILE* f = fopen(st->path, "r");
+    if (!f) return (errno == ENOENT) ? GEN_OK : GEN_ERROR_IO;
+
+    int status = GEN_OK;
+    StorageKey key = 0;
+    DatabaseFormat format = DATABASE_FORMAT_PLAIN;
+    char line[DATABASE_LINE_MAX];
+    // Une seule mesure pour tout le fichier : une par ligne remplirait le tampon de trace
+    uint64_t span = trace_begin();
+    for (int n = 0; status == GEN_OK && fgets(line, sizeof(line), f); n++) {
+        if (n == 0) format = database_file_format(line);
+        Question q;
+        int parsed = parse_question_line_arena(line, format, &q, arena, labels);
+        if (parsed < 0) status = parsed;
+        else if (parsed > 0) status = visit(user_data, ++key, &q);
+    }
+    trace_end(span, "storage_text_read");
+    if (status == GEN_OK && ferror(f)) status = GEN_ERROR_IO;
+    fclose(f);
+    return status;
+}
+
+static int keep_question(void* user_data, StorageKey key, Question* q) {
+    TextStorage* st = user_data;
+    if (st->count == st->capacity) {
+        int capacity = st->capacity ? st->capacity * 2 : 64;
+        Question* grown = mem_realloc(MEM_LOADER, st->questions, capacity * sizeof(Question));
+        if (!grown) {
+            free_question_content(q);
+            return GEN_ERROR_NO_MEMORY;
+        }
+        st->questions = grown;
+        st->capacity = capacity;
+    }
+    st->questions[st->count++] = *q;
+    return GEN_OK;
+}
+
+// Charge le contenu avant la première modification
+static int ensure_loaded(TextStorage* st) {
+    if (st->out) return GEN_ERROR_INVALID_ARGUMENT; // Mode STORAGE_OPEN_REPLACE : ajouts seulement
+    if (st->loaded) return GEN_OK;
+    int status = read_file(st, NULL, NULL, keep_question, st);
+    if (status != GEN_OK) {
+        free_questions(st);
+        return status;
+    }
+    st->loaded = 1;
+    return GEN_OK;
+}
+
+static int text_iterate(void* state, Arena* arena, LabelTable* labels, StorageVisitFunc visit, void* user_data) {
+    TextStorage* st = state;
+    if (st->out) return GEN_ERROR_INVALID_ARGUMENT;
+    if (!st->loaded) return read_file(st, arena, labels, visit, user_data);
+    for (int i = 0; i < st->count; i++) {
+        if (!st->questions[i].choix) continue;
+        Question q;
+        int status = question_copy(&q, &st->questions[i], NULL, arena, labels);
+        if (status == GEN_OK) status = visit(user_data, i + 1, &q);
+        if (status != GEN_OK) return status;
+    }
+    return GEN_OK;
+}
+
+static int text_get(void* state, StorageKey key, Question* out) {
+    TextStorage* st = state;
+    int status = ensure_loaded(st);
+    if (status != GEN_OK) return status;
+    if (key < 1 || key > st->count || !st->questions[key - 1].choix) return GEN_ERROR_INVALID_ARGUMENT;
+    return question_copy(out, &st->questions[key - 1], NULL, NULL, NULL);
+}
+
+static int text_put(void* state, StorageKey* key, const Question* q, const LabelTable* labels) {
+    TextStorage* st = state;
+    if (st->out && *key == 0) {
+        database_write_question(st->out, labels, q);
+        *key = ++st->count;
+        return ferror(st->out) ? GEN_ERROR_IO : GEN_OK;
+    }
+    int status = ensure_loaded(st);
+    if (status != GEN_OK) return status;
+    if (*key != 0 && (*key < 1 || *key > st->count || !st->questions[*key - 1].choix)) {
+        return GEN_ERROR_INVALID_ARGUMENT;
+    }
+
+    Question copy;
+    status = question_copy(&copy, q, labels, NULL, NULL); // Isolée : libellés dans son bloc
+    if (status != GEN_OK) return status;
+    if (*key == 0) {
+        status = keep_question(st, st->count + 1, &copy);
+        if (status != GEN_OK) return status;
+        *key = st->count;
+    } else {
+        free_question_content(&st->questions[*key - 1]);
+        st->questions[*key - 1] = copy;
+    }
+    st->modified = 1;
+    return GEN_OK;
+}
+
+static int text_remove(void* state, StorageKey key) {
+    TextStorage* st = state;
+    int status = ensure_loaded(st);
+    if (status != GEN_OK) return status;
+    if (key < 1 || key > st->count || !st->questions[key - 1].choix) return GEN_ERROR_INVALID_ARGUMENT;
+    free_question_content(&st->questions[key - 1]);
+    st->questions[key - 1].choix = NULL; // La clé reste réservée : les suivantes ne bougent pas
+    st->modified = 1;
+    return GEN_OK;
+}
+
+// Remplace le fichier par le fichier temporaire (refermé par l'appelant)
+static int replace_file(TextStorage* st, int error) {
+    if (error) {
+        remove(st->temp_path);
+        return GEN_ERROR_IO;
+    }
+#ifdef _WIN32
+    remove(st->path); // rename ne remplace pas un fichier existant
+#endif
+    return rename(st->temp_path, st->path) == 0 ? GEN_OK : GEN_ERROR_IO;
+}
+
+static int text_commit(void* state) {
+    TextStorage* st = state;
+    uint64_t span = trace_begin();
+    int status = GEN_OK;
+    if (st->out) {
+        int error = ferror(st->out);
+        if (fclose(st->out) != 0) error = 1;
+        st->out = NULL;
+        st->count = 0; // Les questions écrites sont désormais le contenu du fichier
+        status = replace_file(st, error);
+    } else if (st->modified) {
+        FILE* f = fopen(st->temp_path, "w");
+        if (!f) {
+            trace_end(span, "storage_text_commit");
+            return GEN_ERROR_IO;
+        }
+        database_write_header(f); // Un fichier historique passe au format échappé
+        for (int i = 0; i < st->count; i++) {
+            if (st->questions[i].choix) database_write_question(f, NULL, &st->questions[i]);
+        }
+        int error = ferror(f);
+        if (fclose(f) != 0) error = 1;
+        status = replace_file(st, error);
+        if (status == GEN_OK) st->modified = 0;
+    }
+    trace_end(span, "storage_text_commit");
+    return status;
+}
+
+static void text_close(void* state) {
+    TextStorage* st = state;
+    if (st->out) {
+        fclose(st->out);
+        remove(st->temp_path); // Rien n'a été validé : le fichier d'origine reste intact
+    }
+    free_questions(st);
+    mem_free(MEM_LOADER, st->path);
+    mem_free(MEM_LOADER, st->temp_path);
+    mem_free(MEM_LOADER, st);
+}
+
+const StorageBackend STORAGE_TEXT = {
+    "texte",
+    0,
+    text_open,
+    text_iterate,
+    text_get,
+    text_put,
+    text_remove,
+    text_commit,
+    text_close
+};
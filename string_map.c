@@ -0,0 +1,94 @@
+// string_map.c
+#include <stdlib.h>
+#include <string.h>
+#include "string_map.h"
+#include "mem_track.h"
+
+uint64_t hash_bytes(const void* data, size_t length) {
+    const unsigned char* p = data;
+    uint64_t h = 14695981039346656037ULL;
+    for (size_t i = 0; i < length; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint64_t hash_string(const char* s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (const unsigned char* p = (const unsigned char*)s; *p; p++) {
+        h ^= *p;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+void string_map_init(StringMap* map) {
+    memset(map, 0, sizeof(*map));
+}
+
+void string_map_free(StringMap* map) {
+    mem_free(MEM_GENERATOR, map->keys);
+    mem_free(MEM_GENERATOR, map->hashes);
+    mem_free(MEM_GENERATOR, map->values);
+    memset(map, 0, sizeof(*map));
+}
+
+static size_t find_slot(const char** keys, const uint64_t* hashes, size_t capacity,
+                        const char* key, uint64_t h) {
+    size_t mask = capacity - 1;
+    size_t i = (size_t)h & mask;
+    while (keys[i] != NULL && (hashes[i] != h || strcmp(keys[i], key) != 0)) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static int grow(StringMap* map) {
+    size_t new_capacity = map->capacity ? map->capacity * 2 : 64;
+    const char** keys = mem_calloc(MEM_GENERATOR, new_capacity, sizeof(char*));
+    uint64_t* hashes = mem_alloc(MEM_GENERATOR, new_capacity * sizeof(uint64_t));
+    int* values = mem_alloc(MEM_GENERATOR, new_capacity * sizeof(int));
+    if (!keys || !hashes || !values) {
+        mem_free(MEM_GENERATOR, keys);
+        mem_free(MEM_GENERATOR, hashes);
+        mem_free(MEM_GENERATOR, values);
+        return -1;
+    }
+    for (size_t i = 0; i < map->capacity; i++) {
+        if (map->keys[i] == NULL) continue;
+        size_t slot = find_slot(keys, hashes, new_capacity, map->keys[i], map->hashes[i]);
+        keys[slot] = map->keys[i];
+        hashes[slot] = map->hashes[i];
+        values[slot] = map->values[i];
+    }
+    mem_free(MEM_GENERATOR, map->keys);
+    mem_free(MEM_GENERATOR, map->hashes);
+    mem_free(MEM_GENERATOR, map->values);
+    map->keys = keys;
+    map->hashes = hashes;
+    map->values = values;
+    map->capacity = new_capacity;
+    return 0;
+}
+
+int string_map_get(const StringMap* map, const char* key, int* value) {
+    if (map->count == 0) return 0;
+    size_t slot = find_slot(map->keys, map->hashes, map->capacity, key, hash_string(key));
+    if (map->keys[slot] == NULL) return 0;
+    if (value) *value = map->values[slot];
+    return 1;
+}
+
+int string_map_put(StringMap* map, const char* key, int value) {
+    // Facteur de charge maximal : 1/2
+    if ((map->count + 1) * 2 > map->capacity && grow(map) != 0) return -1;
+    uint64_t h = hash_string(key);
+    size_t slot = find_slot(map->keys, map->hashes, map->capacity, key, h);
+    if (map->keys[slot] != NULL) return 0;
+    map->keys[slot] = key;
+    map->hashes[slot] = h;
+    map->values[slot] = value;
+    map->count++;
+    return 1;
+}
@@ -0,0 +1,32 @@
+// string_map.h
+#ifndef STRING_MAP_H
+#define STRING_MAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Table de hachage chaîne -> entier à adressage ouvert.
+// Les clés ne sont pas copiées : elles doivent rester valides tant que la table est utilisée.
+typedef struct {
+    const char** keys;
+    uint64_t* hashes;
+    int* values;
+    size_t capacity;   // Toujours une puissance de deux
+    size_t count;
+} StringMap;
+
+// Hachage FNV-1a 64 bits
+uint64_t hash_string(const char* s);
+uint64_t hash_bytes(const void* data, size_t length);
+
+void string_map_init(StringMap* map);
+void string_map_free(StringMap* map);
+
+// Retourne 1 et remplit *value si la clé est présente, 0 sinon
+int string_map_get(const StringMap* map, const char* key, int* value);
+
+// Insère la clé si elle est absente. Retourne 1 si elle a été ajoutée, 0 si elle
+// existait déjà (la valeur n'est pas modifiée), -1 en cas d'erreur mémoire.
+int string_map_put(StringMap* map, const char* key, int value);
+
+#endif
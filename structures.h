@@ -2,28 +2,116 @@
 #ifndef STRUCTURES_H
 #define STRUCTURES_H
 
+#include <stdint.h>
+#include "arena.h"
+
+// Nombre de valeurs de la signature MinHash d'un énoncé (voir minhash.h)
+#define MINHASH_SIZE 32
+
 typedef enum {
     EXAM_TYPE_QCM_ONLY,    // 20 QCM questions
     EXAM_TYPE_MIXED        // 10 QCM + 1 exercise
 } ExamType;
 
-// Structure pour une seule question (plus flexible)
+// Nombre maximal de choix d'un QCM (nbChoix et bonneReponse tiennent sur un octet)
+#define QUESTION_MAX_CHOICES 127
+
+// Position d'un choix dans le bloc de sa question
 typedef struct {
-    char* matiere;
-    char* chapitre;
-    char* type;        // "QCM" ou "Exercice"
-    char* enonce;
-    char** choix;      // Tableau de chaînes pour les choix
-    int nbChoix;
-    int bonneReponse;  // Index de la bonne réponse (à partir de 0), -1 si exercice
-    int points;        // Added points field for scoring
+    uint32_t offset;   // Depuis le début du bloc (q->choix)
+    uint32_t length;   // En octets, sans le '\0' final
+} QuestionChoice;
+
+// Libellés d'une question, rangés une seule fois par base (label_table.h)
+typedef enum {
+    QUESTION_MATIERE,
+    QUESTION_CHAPITRE,
+    QUESTION_TYPE,          // "QCM" ou "Exercice"
+    QUESTION_LABEL_COUNT
+} QuestionLabel;
+
+// Libellé rangé à la fin du bloc de la question : question isolée, hors de toute base, ou
+// libellé arrivé quand la table de la base était pleine (LABEL_TABLE_MAX)
+#define QUESTION_LABEL_INLINE UINT16_MAX
+
+typedef struct LabelTable LabelTable;
+
+// Une question occupe un seul bloc, construit par question_init (database.h) : la table des
+// choix, puis l'énoncé et les choix, à la suite et terminés par '\0'. Les libellés sont des
+// indices dans la table de la base (db->labels) ; ceux d'une question isolée suivent les
+// choix dans le bloc (matière, chapitre, type). Le bloc se libère d'un coup, jamais champ
+// par champ. Les textes se lisent avec question_enonce, question_choice et question_label.
+typedef struct {
+    QuestionChoice* choix;  // Début du bloc (NULL pour une question vide), table des nbChoix choix
+    int id;                 // Identifiant stable en mémoire (croissant), attribué par add_question_to_db
+    uint16_t labels[QUESTION_LABEL_COUNT]; // Indices dans db->labels, ou QUESTION_LABEL_INLINE
+    uint8_t nbChoix;
+    int8_t bonneReponse;    // Index de la bonne réponse (à partir de 0), -1 si exercice
+    int16_t points;         // Barème de la question
+    uint16_t minhash[MINHASH_SIZE]; // Signature de l'énoncé, calculée à l'ajout et à la modification
 } Question;
 
-// Structure pour gérer la collection de questions en mémoire
+// Texte du choix i (0 <= i < q->nbChoix), terminé par '\0'
+static inline const char* question_choice(const Question* q, int i) {
+    return (const char*)q->choix + q->choix[i].offset;
+}
+
+// Énoncé de q : il suit la table des choix
+static inline const char* question_enonce(const Question* q) {
+    return (const char*)(q->choix + q->nbChoix);
+}
+
+// Nature d'une modification de la base, signalée aux écouteurs
+typedef enum {
+    DB_CHANGE_INSERTED,    // count questions ont été insérées à partir de l'index donné
+    DB_CHANGE_REMOVED,     // La question à l'index donné a été supprimée
+    DB_CHANGE_CHANGED      // La question à l'index donné a été remplacée
+} DatabaseChange;
+
+struct Database;
+
+// Appelé après la modification. count vaut 1 sauf pour une insertion en lot.
+// old_question désigne l'ancien contenu (suppression ou remplacement, NULL pour une
+// insertion) ; il n'est valide que pendant l'appel.
+typedef void (*DatabaseListenerFunc)(const struct Database* db, DatabaseChange change, int index, int count,
+                                     const Question* old_question, void* user_data);
+
 typedef struct {
+    DatabaseListenerFunc func;
+    void* user_data;
+} DatabaseListener;
+
+// Reçoit le contenu d'une question supprimée ou remplacée, qui devient sa responsabilité
+// (libération différée tant que des lecteurs peuvent encore le voir, voir snapshot.h)
+typedef void (*QuestionRetireFunc)(Question* q, void* user_data);
+
+// Reçoit l'arène que database_compact vient de remplacer (allouée avec mem_alloc dans
+// MEM_LOADER), à rendre par arena_release puis mem_free quand plus aucun lecteur ne la voit
+typedef void (*ArenaRetireFunc)(Arena* arena, void* user_data);
+
+// Liste des matières d'une base découpée en un fichier par matière (bank_shards.h)
+typedef struct BankShards BankShards;
+
+// Support indexé d'où vient la base (storage.h)
+typedef struct Storage Storage;
+
+// Structure pour gérer la collection de questions en mémoire
+typedef struct Database {
     Question* questions; // Tableau dynamique de questions
     int count;           // Nombre de questions actuellement dans le tableau
     int capacity;        // Capacité actuelle du tableau
+    int next_id;         // Prochain identifiant attribué ; les ids restent triés dans le tableau
+    DatabaseListener* listeners;
+    int nbListeners;
+    Arena arena;                 // Blocs des questions de la base (voir database.h)
+    QuestionRetireFunc retire;   // NULL : le contenu remplacé ou supprimé est libéré aussitôt
+    ArenaRetireFunc retire_arena; // NULL : l'arène remplacée par un compactage est libérée aussitôt
+    void* retire_data;           // Passé à retire et à retire_arena
+    BankShards* shards;          // Base découpée : matières chargées à la demande (NULL : un seul fichier)
+    Storage* storage;            // Support indexé resté ouvert (SQLite) : chaque modification y est
+                                 // reportée, validée par save_database (NULL : fichier texte)
+    LabelTable* labels;          // Libellés des questions de la base, partagés avec ses instantanés
+                                 // (NULL tant qu'aucune question n'est rangée)
 } Database;
 
 #endif
@@ -0,0 +1,57 @@
+// text_buffer.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "text_buffer.h"
+#include "mem_track.h"
+
+int text_buffer_init(TextBuffer* b, size_t capacity) {
+    b->len = 0;
+    b->error = 0;
+    b->cap = capacity > 0 ? capacity : 256;
+    b->data = mem_alloc(MEM_GENERATOR, b->cap);
+    if (!b->data) {
+        b->cap = 0;
+        b->error = 1;
+        return -1;
+    }
+    return 0;
+}
+
+void text_buffer_free(TextBuffer* b) {
+    mem_free(MEM_GENERATOR, b->data);
+    b->data = NULL;
+    b->len = 0;
+    b->cap = 0;
+}
+
+void text_buffer_append(TextBuffer* b, const char* s, size_t n) {
+    if (b->error) return;
+    if (b->len + n > b->cap) { // Rare : l'estimation initiale couvre normalement tout le document
+        size_t new_cap = b->cap ? b->cap * 2 : 256;
+        while (new_cap < b->len + n) new_cap *= 2;
+        char* p = mem_realloc(MEM_GENERATOR, b->data, new_cap);
+        if (!p) {
+            b->error = 1;
+            return;
+        }
+        b->data = p;
+        b->cap = new_cap;
+    }
+    memcpy(b->data + b->len, s, n);
+    b->len += n;
+}
+
+void text_buffer_append_str(TextBuffer* b, const char* s) {
+    text_buffer_append(b, s, strlen(s));
+}
+
+void text_buffer_append_int(TextBuffer* b, int value) {
+    char digits[12];
+    int n = snprintf(digits, sizeof(digits), "%d", value);
+    text_buffer_append(b, digits, (size_t)n);
+}
+
+void text_buffer_append_char(TextBuffer* b, char c) {
+    text_buffer_append(b, &c, 1);
+}
@@ -0,0 +1,27 @@
+// text_buffer.h
+#ifndef TEXT_BUFFER_H
+#define TEXT_BUFFER_H
+
+#include <stddef.h>
+
+// Tampon de texte contigu utilisé par les rendus textuels (TXT, HTML, Markdown).
+// Il est dimensionné une fois à partir d'une estimation, puis vidé en une seule écriture.
+typedef struct {
+    char* data;
+    size_t len;
+    size_t cap;
+    int error;   // Mis à 1 si une réallocation a échoué
+} TextBuffer;
+
+int text_buffer_init(TextBuffer* b, size_t capacity);
+void text_buffer_free(TextBuffer* b);
+
+void text_buffer_append(TextBuffer* b, const char* s, size_t n);
+void text_buffer_append_str(TextBuffer* b, const char* s);
+void text_buffer_append_int(TextBuffer* b, int value);
+void text_buffer_append_char(TextBuffer* b, char c);
+
+// Ajoute un littéral dont la longueur est connue à la compilation
+#define TEXT_BUFFER_APPEND_FIXED(b, fragment) text_buffer_append((b), (fragment), sizeof(fragment) - 1)
+
+#endif
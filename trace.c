@@ -0,0 +1,146 @@
+// trace.c
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#ifdef _WIN32
+    #include <windows.h>
+#endif
+#include "trace.h"
+#include "gen_status.h"
+
+typedef struct {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+} TraceEvent;
+
+// Tampon circulaire d'un thread : seul ce thread écrit ; count est publié après chaque
+// intervalle pour que trace_stop() lise des événements complets.
+typedef struct TraceBuffer {
+    TraceEvent events[TRACE_BUFFER_EVENTS];
+    atomic_uint_fast64_t count;
+    const char* thread_name;
+    int tid;
+    struct TraceBuffer* next;
+} TraceBuffer;
+
+atomic_int trace_active;
+
+// Liste des tampons de tous les threads : gardés jusqu'à la fin du programme, car un
+// thread peut encore écrire dans le sien pendant ou après trace_stop()
+static pthread_mutex_t buffers_lock = PTHREAD_MUTEX_INITIALIZER;
+static TraceBuffer* buffers;
+static int nb_buffers;
+static char* output_path;
+static uint64_t origin_ns;
+
+static _Thread_local TraceBuffer* local_buffer;
+static _Thread_local const char* local_name;
+
+uint64_t trace_now_ns(void) {
+#ifdef _WIN32
+    LARGE_INTEGER counter, frequency;
+    QueryPerformanceCounter(&counter);
+    QueryPerformanceFrequency(&frequency);
+    return (uint64_t)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+static TraceBuffer* thread_buffer(void) {
+    TraceBuffer* buffer = calloc(1, sizeof(TraceBuffer));
+    if (!buffer) return NULL;
+    atomic_init(&buffer->count, 0);
+    buffer->thread_name = local_name;
+    pthread_mutex_lock(&buffers_lock);
+    buffer->tid = ++nb_buffers;
+    buffer->next = buffers;
+    buffers = buffer;
+    pthread_mutex_unlock(&buffers_lock);
+    local_buffer = buffer;
+    return buffer;
+}
+
+void trace_record(const char* name, uint64_t start_ns, uint64_t end_ns) {
+    TraceBuffer* buffer = local_buffer ? local_buffer : thread_buffer();
+    if (!buffer) return;
+    uint64_t n = atomic_load_explicit(&buffer->count, memory_order_relaxed);
+    TraceEvent* event = &buffer->events[n % TRACE_BUFFER_EVENTS];
+    event->name = name;
+    event->start_ns = start_ns;
+    event->end_ns = end_ns;
+    atomic_store_explicit(&buffer->count, n + 1, memory_order_release);
+}
+
+void trace_set_thread_name(const char* name) {
+    local_name = name;
+    if (local_buffer) local_buffer->thread_name = name;
+}
+
+int trace_start(const char* path) {
+    char* copy = malloc(strlen(path) + 1);
+    if (!copy) return GEN_ERROR_NO_MEMORY;
+    strcpy(copy, path);
+
+    pthread_mutex_lock(&buffers_lock);
+    free(output_path);
+    output_path = copy;
+    for (TraceBuffer* b = buffers; b; b = b->next) {
+        atomic_store(&b->count, 0);
+    }
+    origin_ns = trace_now_ns();
+    pthread_mutex_unlock(&buffers_lock);
+    atomic_store(&trace_active, 1);
+    return GEN_OK;
+}
+
+int trace_start_from_env(void) {
+    const char* path = getenv(TRACE_ENV_VAR);
+    if (!path || path[0] == 0) return 0;
+    return trace_start(path) == GEN_OK;
+}
+
+static void write_buffer(FILE* f, const TraceBuffer* buffer, int* first) {
+    fprintf(f, "%s\n{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, \"args\": {\"name\": \"%s\"}}",
+            *first ? "" : ",", buffer->tid, buffer->thread_name ? buffer->thread_name : "thread");
+    *first = 0;
+
+    uint64_t count = atomic_load_explicit(&buffer->count, memory_order_acquire);
+    uint64_t start = (count > TRACE_BUFFER_EVENTS) ? count - TRACE_BUFFER_EVENTS : 0;
+    for (uint64_t i = start; i < count; i++) {
+        const TraceEvent* e = &buffer->events[i % TRACE_BUFFER_EVENTS];
+        if (e->start_ns < origin_ns) continue; // Commencé avant trace_start()
+        fprintf(f, ",\n{\"name\": \"%s\", \"cat\": \"generateur\", \"ph\": \"X\", \"pid\": 1, \"tid\": %d, "
+                   "\"ts\": %.3f, \"dur\": %.3f}",
+                e->name, buffer->tid, (e->start_ns - origin_ns) / 1000.0, (e->end_ns - e->start_ns) / 1000.0);
+    }
+}
+
+int trace_stop(void) {
+    if (!atomic_exchange(&trace_active, 0)) return GEN_ERROR_INVALID_ARGUMENT;
+
+    pthread_mutex_lock(&buffers_lock);
+    int status = GEN_OK;
+    FILE* f = fopen(output_path, "w");
+    if (!f) {
+        status = GEN_ERROR_IO;
+    } else {
+        int first = 1;
+        fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+        for (const TraceBuffer* b = buffers; b; b = b->next) {
+            write_buffer(f, b, &first);
+        }
+        fprintf(f, "\n]}\n");
+        if (ferror(f)) status = GEN_ERROR_IO;
+        if (fclose(f) != 0) status = GEN_ERROR_IO;
+    }
+    free(output_path);
+    output_path = NULL;
+    pthread_mutex_unlock(&buffers_lock);
+    return status;
+}
@@ -0,0 +1,60 @@
+// trace.h - Mesure des phases (chargement, sélection, rendu...) au format Chrome trace
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdatomic.h>
+
+// Nombre d'intervalles gardés par thread : au-delà, les plus anciens sont remplacés
+#define TRACE_BUFFER_EVENTS 16384
+
+// Variable d'environnement qui active la mesure dans tous les modes (CLI, lot, serveur, GUI)
+#define TRACE_ENV_VAR "GENERATEUR_TRACE"
+
+// Usage autour d'une phase (name doit être une chaîne constante) :
+//
+//   uint64_t span = trace_begin();
+//   ...
+//   trace_end(span, "partition_by_chapter");
+//
+// Désactivée, trace_begin() se réduit à la lecture d'un indicateur et trace_end() à un test.
+// Activée, chaque thread écrit dans son propre tampon circulaire, sans verrou.
+// Compiler avec -DGEN_NO_TRACE retire complètement la mesure.
+
+extern atomic_int trace_active;
+
+uint64_t trace_now_ns(void);
+void trace_record(const char* name, uint64_t start_ns, uint64_t end_ns);
+
+static inline uint64_t trace_begin(void) {
+#ifdef GEN_NO_TRACE
+    return 0;
+#else
+    if (!atomic_load_explicit(&trace_active, memory_order_relaxed)) return 0;
+    return trace_now_ns();
+#endif
+}
+
+static inline void trace_end(uint64_t start_ns, const char* name) {
+#ifndef GEN_NO_TRACE
+    if (start_ns != 0) trace_record(name, start_ns, trace_now_ns());
+#endif
+}
+
+// Active la mesure ; trace_stop() écrira le fichier JSON path (copié).
+// Retourne GEN_OK ou GEN_ERROR_NO_MEMORY.
+int trace_start(const char* path);
+
+// Active la mesure si GENERATEUR_TRACE désigne un fichier ; retourne 1 si c'est le cas
+int trace_start_from_env(void);
+
+// Nom affiché pour le thread appelant (ex: "bank-loader"), chaîne constante
+void trace_set_thread_name(const char* name);
+
+// Désactive la mesure et écrit les intervalles de tous les threads au format Chrome
+// trace-event (chrome://tracing, Perfetto). À appeler une fois les threads de travail
+// arrêtés. Retourne GEN_OK, GEN_ERROR_IO, ou GEN_ERROR_INVALID_ARGUMENT si la mesure
+// n'était pas active.
+int trace_stop(void);
+
+#endif